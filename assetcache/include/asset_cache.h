@@ -0,0 +1,91 @@
+/** Output cache and Make depfiles for incremental asset builds.
+ * Copyright (C) Burton O Sumner
+ * but you can use it if you want. :)
+ * */
+#ifndef _ASSET_CACHE_H_
+#define _ASSET_CACHE_H_
+
+#ifdef __cplusplus
+#include <cstdint>
+#include <cstddef>
+extern "C" {
+#else
+#include <stdint.h>
+#include <stddef.h>
+#endif  /* CXX name mangler guard */
+
+/* A content-addressed cache of a tool's output files. The key is a hash of
+ * the tool's own executable (size and mtime, so rebuilding the tool misses),
+ * a description of every option that affects its output, and the input's
+ * bytes. Each entry is a directory, <cache dir>/<16 hex digit key>/, holding
+ * the output files and a manifest that has to match the key's description
+ * and input size for a hit. On a hit, the cached files get hard-linked into
+ * the output directory, or copied where linking fails (e.g.: across file
+ * systems), and touched, so make sees them as newer than their inputs.
+ * Since a hit's outputs share their inode with the cache, tools have to
+ * replace their output files (unlink, then create) rather than write over
+ * them in place.
+ * Every function returns -1 with errno set on failure. */
+
+#define ASSET_CACHE_MAX_FILES 8
+#define ASSET_CACHE_MAX_NAME 256
+
+typedef struct s_asset_cache_key {
+  uint64_t hash;
+  uint64_t input_byte_ct;
+  const char *desc;  /// MUST stay valid as long as the key's in use
+} AssetCacheKey_t;
+
+/// Names of the files a tool wrote for one input, relative to its output directory
+typedef struct s_asset_cache_files {
+  char names[ASSET_CACHE_MAX_FILES][ASSET_CACHE_MAX_NAME];
+  int ct;
+  int overflowed;  /// Set once a name didn't fit, so names is missing some
+} AssetCacheFiles_t;
+
+/**
+ * @summary Start a key from the running executable and desc, which has to
+ * name every option affecting output, and can't contain a newline.
+ * */
+void Asset_Cache_Key_Init(AssetCacheKey_t *dst, const char *desc);
+/// Hash byte_ct more bytes of input into key.
+void Asset_Cache_Key_Add(AssetCacheKey_t *key, const void *bytes, size_t byte_ct);
+/// Hash all of the file at path into key, for inputs not already in memory.
+int Asset_Cache_Key_Add_File(AssetCacheKey_t *key, const char *path);
+/**
+ * @return 0, or -1 if files is full or name's too long, in which case files
+ * is marked as overflowed, and can't be stored or made a depfile's targets.
+ * */
+int Asset_Cache_Files_Add(AssetCacheFiles_t *files, const char *name);
+
+/**
+ * @summary Look key up in cache_dir, and on a hit, place every file it holds
+ * in out_dir.
+ * @param out_dir Prefixed to each file name as is, so it ends with a '/'.
+ * @param files Gets the names of the files placed.
+ * @return 1 on a hit, 0 on a miss, -1 if placing a hit's files failed.
+ * */
+int Asset_Cache_Fetch(const char *cache_dir, const AssetCacheKey_t *key,
+    const char *out_dir, AssetCacheFiles_t *files);
+/**
+ * @summary Add files, as written to out_dir, to cache_dir under key,
+ * creating cache_dir if need be. Safe to race another process storing the
+ * same key: whichever finishes second leaves the first's entry be.
+ * */
+int Asset_Cache_Store(const char *cache_dir, const AssetCacheKey_t *key,
+    const char *out_dir, const AssetCacheFiles_t *files);
+
+/**
+ * @summary Write a Make-style dependency file to path, making every file in
+ * targets (prefixed with out_dir) depend on the prereq_ct prereqs, with an
+ * empty rule per prereq so make doesn't fail once one's deleted.
+ * */
+int Asset_Depfile_Write(const char *path, const char *out_dir,
+    const AssetCacheFiles_t *targets, const char *const *prereqs,
+    int prereq_ct);
+
+#ifdef __cplusplus
+}
+#endif  /* CXX name mangler guard */
+
+#endif  /* _ASSET_CACHE_H_ */
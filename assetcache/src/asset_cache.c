@@ -0,0 +1,339 @@
+#define _POSIX_C_SOURCE 200809L
+#include "asset_cache.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define FNV1A_64_OFFSET_BASIS 0xcbf29ce484222325ULL
+#define FNV1A_64_PRIME 0x100000001b3ULL
+
+/// Bumped whenever the manifest or entry layout changes, so old entries miss
+#define ASSET_CACHE_FORMAT_VERSION 1
+
+static uint64_t fnv1a_64(uint64_t hash, const void *bytes, size_t byte_ct) {
+  const uint8_t *cur = bytes;
+  while (byte_ct--) {
+    hash ^= *cur++;
+    hash *= FNV1A_64_PRIME;
+  }
+  return hash;
+}
+
+void Asset_Cache_Key_Init(AssetCacheKey_t *dst, const char *desc) {
+  struct stat st;
+  *dst = (AssetCacheKey_t) { .hash = FNV1A_64_OFFSET_BASIS, .desc = desc };
+  // a rebuilt tool may well write something else for the same input
+  if (0 == stat("/proc/self/exe", &st)) {
+    const int64_t exe_id[3] = { st.st_size, st.st_mtim.tv_sec, st.st_mtim.tv_nsec };
+    dst->hash = fnv1a_64(dst->hash, exe_id, sizeof(exe_id));
+  }
+  // the terminator keeps desc from running into the input bytes
+  dst->hash = fnv1a_64(dst->hash, desc, strlen(desc)+1);
+}
+
+void Asset_Cache_Key_Add(AssetCacheKey_t *key, const void *bytes, size_t byte_ct) {
+  key->hash = fnv1a_64(key->hash, bytes, byte_ct);
+  key->input_byte_ct += byte_ct;
+}
+
+int Asset_Cache_Key_Add_File(AssetCacheKey_t *key, const char *path) {
+  uint8_t buf[0x10000];
+  ssize_t readlen;
+  int fd, errno_save;
+  if (0 > (fd = open(path, O_RDONLY)))
+    return -1;
+  while (0 < (readlen = read(fd, buf, sizeof(buf))))
+    Asset_Cache_Key_Add(key, buf, readlen);
+  errno_save = errno;
+  close(fd);
+  errno = errno_save;
+  return readlen < 0 ? -1 : 0;
+}
+
+int Asset_Cache_Files_Add(AssetCacheFiles_t *files, const char *name) {
+  if (files->ct == ASSET_CACHE_MAX_FILES || strlen(name) >= ASSET_CACHE_MAX_NAME) {
+    files->overflowed = 1;
+    errno = ENAMETOOLONG;
+    return -1;
+  }
+  strcpy(files->names[files->ct++], name);
+  return 0;
+}
+
+/// What an entry's manifest starts with, ahead of its file names, one per line
+static char *manifest_header(const AssetCacheKey_t *key) {
+  const char *fmt = "asset-cache %d\n%016llx\n%llu\n%s\n";
+  const int len = snprintf(NULL, 0, fmt, ASSET_CACHE_FORMAT_VERSION,
+      (unsigned long long)key->hash, (unsigned long long)key->input_byte_ct, key->desc);
+  char *ret = malloc(len+1);
+  if (ret)
+    snprintf(ret, len+1, fmt, ASSET_CACHE_FORMAT_VERSION,
+        (unsigned long long)key->hash, (unsigned long long)key->input_byte_ct, key->desc);
+  return ret;
+}
+
+/// malloc'd "<a><b><c>"
+static char *path_join(const char *a, const char *b, const char *c) {
+  const size_t len = strlen(a) + strlen(b) + strlen(c);
+  char *ret = malloc(len+1);
+  if (ret)
+    snprintf(ret, len+1, "%s%s%s", a, b, c);
+  return ret;
+}
+
+static int copy_file(const char *src, const char *dst) {
+  char buf[0x10000];
+  ssize_t readlen = 0;
+  int in, out, ret = 0;
+  if (0 > (in = open(src, O_RDONLY)))
+    return -1;
+  if (0 > (out = open(dst, O_WRONLY|O_CREAT|O_TRUNC, 0644))) {
+    close(in);
+    return -1;
+  }
+  while (0 < (readlen = read(in, buf, sizeof(buf)))) {
+    for (ssize_t written = 0, ct; written < readlen; written += ct)
+      if (0 > (ct = write(out, buf + written, readlen - written))) {
+        ret = -1;
+        break;
+      }
+    if (ret)
+      break;
+  }
+  if (readlen < 0)
+    ret = -1;
+  close(in);
+  if (0 > close(out))
+    ret = -1;
+  return ret;
+}
+
+/// Replace dst with a hard link to src, or a copy of it where that can't be done.
+static int place_file(const char *src, const char *dst) {
+  if (0 > unlink(dst) && errno != ENOENT)
+    return -1;
+  if (0 == link(src, dst))
+    return 0;
+  return copy_file(src, dst);
+}
+
+/// mkdir -p, for the cache dir
+static int make_dirs(const char *path) {
+  char *tmp = path_join(path, "", "");
+  int ret = 0;
+  if (!tmp)
+    return -1;
+  for (char *cur = tmp+1; ; ++cur) {
+    const char c = *cur;
+    if (c != '/' && c)
+      continue;
+    *cur = '\0';
+    if (0 > mkdir(tmp, 0755) && errno != EEXIST) {
+      ret = -1;
+      break;
+    }
+    if (!(*cur = c))
+      break;
+  }
+  free(tmp);
+  return ret;
+}
+
+/// Read all of path into a malloc'd, NUL-terminated buffer.
+static char *read_text_file(const char *path) {
+  FILE *fp = fopen(path, "rb");
+  char *ret = NULL;
+  long len;
+  if (!fp)
+    return NULL;
+  if (0 == fseek(fp, 0L, SEEK_END) && 0 <= (len = ftell(fp))
+      && NULL != (ret = malloc(len+1))) {
+    rewind(fp);
+    if ((size_t)len != fread(ret, 1, len, fp)) {
+      free(ret);
+      ret = NULL;
+    } else {
+      ret[len] = '\0';
+    }
+  }
+  fclose(fp);
+  return ret;
+}
+
+int Asset_Cache_Fetch(const char *cache_dir, const AssetCacheKey_t *key,
+    const char *out_dir, AssetCacheFiles_t *files) {
+  char name[32], *entry, *manifest_path, *manifest = NULL, *header = NULL;
+  int ret = 0;
+  snprintf(name, sizeof(name), "/%016llx/", (unsigned long long)key->hash);
+  *files = (AssetCacheFiles_t) { .ct = 0 };
+  if (NULL == (entry = path_join(cache_dir, name, "")))
+    return -1;
+  if (NULL == (manifest_path = path_join(entry, "manifest", ""))) {
+    free(entry);
+    return -1;
+  }
+  if (NULL == (header = manifest_header(key))) {
+    ret = -1;
+    goto CLEANUP;
+  }
+  // no manifest, or one for another desc or input size that hashed the same
+  if (NULL == (manifest = read_text_file(manifest_path))
+      || strncmp(manifest, header, strlen(header)))
+    goto CLEANUP;
+
+  for (char *line = manifest + strlen(header), *end; *line; line = end+1) {
+    if (NULL == (end = strchr(line, '\n')))
+      break;
+    *end = '\0';
+    if (0 > Asset_Cache_Files_Add(files, line)) {
+      ret = -1;
+      goto CLEANUP;
+    }
+  }
+  for (int i = 0; i < files->ct; ++i) {
+    char *src = path_join(entry, files->names[i], ""),
+         *dst = path_join(out_dir, files->names[i], "");
+    // touched, or make would take a hit's outputs for older than the inputs
+    if (!src || !dst || 0 > place_file(src, dst)
+        || 0 > utimensat(AT_FDCWD, dst, NULL, 0))
+      ret = -1;
+    free(src);
+    free(dst);
+    if (ret)
+      goto CLEANUP;
+  }
+  ret = 1;
+
+CLEANUP:
+  free(header);
+  free(manifest);
+  free(manifest_path);
+  free(entry);
+  return ret;
+}
+
+int Asset_Cache_Store(const char *cache_dir, const AssetCacheKey_t *key,
+    const char *out_dir, const AssetCacheFiles_t *files) {
+  char name[32], *tmp_dir, *entry = NULL, *header = NULL;
+  int ret = -1;
+  FILE *fp;
+  if (files->overflowed) {
+    errno = ENAMETOOLONG;
+    return -1;
+  }
+  if (0 > make_dirs(cache_dir))
+    return -1;
+  // built up off to the side, then renamed into place whole
+  if (NULL == (tmp_dir = path_join(cache_dir, "/.tmp-", "XXXXXX")))
+    return -1;
+  if (NULL == mkdtemp(tmp_dir)) {
+    free(tmp_dir);
+    return -1;
+  }
+  for (int i = 0; i < files->ct; ++i) {
+    char *src = path_join(out_dir, files->names[i], ""),
+         *dst = path_join(tmp_dir, "/", files->names[i]);
+    const int placed = src && dst && 0 == place_file(src, dst);
+    free(src);
+    free(dst);
+    if (!placed)
+      goto CLEANUP;
+  }
+  {
+    char *manifest_path = path_join(tmp_dir, "/manifest", "");
+    if (!manifest_path || NULL == (header = manifest_header(key))
+        || NULL == (fp = fopen(manifest_path, "w"))) {
+      free(manifest_path);
+      goto CLEANUP;
+    }
+    fputs(header, fp);
+    for (int i = 0; i < files->ct; ++i)
+      fprintf(fp, "%s\n", files->names[i]);
+    ret = fclose(fp) ? -1 : 0;
+    free(manifest_path);
+    if (ret)
+      goto CLEANUP;
+  }
+
+  snprintf(name, sizeof(name), "/%016llx", (unsigned long long)key->hash);
+  if (NULL == (entry = path_join(cache_dir, name, ""))) {
+    ret = -1;
+    goto CLEANUP;
+  }
+  if (0 == rename(tmp_dir, entry)) {
+    free(entry);
+    free(header);
+    free(tmp_dir);
+    return 0;
+  }
+  // someone else stored the same key first, or it's a stale entry for a
+  // colliding desc that this one can't replace; either way, not an error
+  if (errno != EEXIST && errno != ENOTEMPTY)
+    ret = -1;
+
+CLEANUP:
+  for (int i = 0; i < files->ct; ++i) {
+    char *path = path_join(tmp_dir, "/", files->names[i]);
+    if (path)
+      unlink(path);
+    free(path);
+  }
+  {
+    char *manifest_path = path_join(tmp_dir, "/manifest", "");
+    if (manifest_path)
+      unlink(manifest_path);
+    free(manifest_path);
+  }
+  rmdir(tmp_dir);
+  free(entry);
+  free(header);
+  free(tmp_dir);
+  return ret;
+}
+
+/// Write path to fp escaped for make: spaces, #s and $s.
+static void depfile_write_path(FILE *fp, const char *path) {
+  for (char c; (c = *path++); ) {
+    if (c == ' ' || c == '#')
+      fputc('\\', fp);
+    else if (c == '$')
+      fputc('$', fp);
+    fputc(c, fp);
+  }
+}
+
+int Asset_Depfile_Write(const char *path, const char *out_dir,
+    const AssetCacheFiles_t *targets, const char *const *prereqs,
+    int prereq_ct) {
+  FILE *fp;
+  if (targets->overflowed) {
+    errno = ENAMETOOLONG;
+    return -1;
+  }
+  if (0 > unlink(path) && errno != ENOENT)
+    return -1;
+  if (NULL == (fp = fopen(path, "w")))
+    return -1;
+  for (int i = 0; i < targets->ct; ++i) {
+    if (i)
+      fputc(' ', fp);
+    depfile_write_path(fp, out_dir);
+    depfile_write_path(fp, targets->names[i]);
+  }
+  fputc(':', fp);
+  for (int i = 0; i < prereq_ct; ++i) {
+    fputc(' ', fp);
+    depfile_write_path(fp, prereqs[i]);
+  }
+  fputc('\n', fp);
+  for (int i = 0; i < prereq_ct; ++i) {
+    fputc('\n', fp);
+    depfile_write_path(fp, prereqs[i]);
+    fputs(":\n", fp);
+  }
+  return fclose(fp) ? -1 : 0;
+}
@@ -0,0 +1,55 @@
+/** Debounced directory watcher for regenerating assets as they change.
+ * Copyright (C) Burton O Sumner
+ * but you can use it if you want. :)
+ * */
+#ifndef _ASSET_WATCH_H_
+#define _ASSET_WATCH_H_
+
+#ifdef __cplusplus
+#include <csignal>
+#include <cstdint>
+extern "C" {
+#else
+#include <signal.h>
+#include <stdint.h>
+#endif  /* CXX name mangler guard */
+
+/* Watches one directory (not its subdirectories) with inotify for files
+ * that get written and closed, or moved in (as editors that save to a temp
+ * file, then rename it over the original, do). Changes to the same file
+ * get debounced: it only counts as changed once debounce_ms go by without
+ * another change to it, so a tool saving in several writes sets off one
+ * regeneration, not several. Hidden files (names starting with '.') are
+ * skipped, as that's where editors put their temp and swap files. Linux
+ * only. */
+
+#define ASSET_WATCH_DEFAULT_DEBOUNCE_MS 20
+
+typedef struct s_asset_watch_event {
+  const char *name;  /// Of the file that changed, relative to the watched directory
+  int64_t first_ns;  /// When the first change debounced into this event came in (see Asset_Watch_Now_Ns)
+  int64_t last_ns;  /// When the last one did
+  int change_ct;  /// How many changes got debounced into this event
+} AssetWatchEvent_t;
+
+/// Called once per debounced change, on the thread that called Asset_Watch_Run.
+typedef void (*Asset_Watch_Cb_t)(const AssetWatchEvent_t *ev, void *arg);
+
+/**
+ * @summary Watch dir, calling cb for every debounced change, until *stop
+ * gets set (e.g.: by a SIGINT handler installed without SA_RESTART), or dir
+ * itself gets deleted or moved.
+ * @param debounce_ms If <= 0, uses ASSET_WATCH_DEFAULT_DEBOUNCE_MS.
+ * @return 0 once stopped, or -1 with errno set if dir couldn't be watched.
+ * */
+int Asset_Watch_Run(const char *dir, int debounce_ms, Asset_Watch_Cb_t cb,
+    void *arg, volatile sig_atomic_t *stop);
+
+/// Monotonic clock, in ns, that event times are measured on.
+int64_t Asset_Watch_Now_Ns(void);
+
+#ifdef __cplusplus
+}
+#endif  /* CXX name mangler guard */
+
+#endif  /* _ASSET_WATCH_H_ */
@@ -0,0 +1,153 @@
+#define _POSIX_C_SOURCE 200809L
+#include "asset_watch.h"
+#include <errno.h>
+#include <limits.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/inotify.h>
+#include <time.h>
+#include <unistd.h>
+
+#define ASSET_WATCH_MASK (IN_CLOSE_WRITE | IN_MOVED_TO | IN_DELETE_SELF \
+    | IN_MOVE_SELF)
+
+/// A file that changed, waiting out its debounce
+typedef struct s_asset_watch_pending {
+  char name[NAME_MAX+1];
+  int64_t first_ns, last_ns;
+  int change_ct;
+} AssetWatchPending_t;
+
+typedef struct s_asset_watch {
+  AssetWatchPending_t *pending;
+  int pending_ct, pending_cap;
+} AssetWatch_t;
+
+int64_t Asset_Watch_Now_Ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (int64_t)ts.tv_sec*1000000000LL + ts.tv_nsec;
+}
+
+static int asset_watch_note(AssetWatch_t *watch, const char *name,
+    int64_t now) {
+  AssetWatchPending_t *cur;
+  for (int i = 0; i < watch->pending_ct; ++i) {
+    cur = &watch->pending[i];
+    if (!strcmp(cur->name, name)) {
+      cur->last_ns = now;
+      ++cur->change_ct;
+      return 0;
+    }
+  }
+  if (watch->pending_ct == watch->pending_cap) {
+    const int cap = watch->pending_cap ? watch->pending_cap*2 : 16;
+    if (!(cur = realloc(watch->pending, sizeof(*cur)*cap)))
+      return -1;
+    watch->pending = cur;
+    watch->pending_cap = cap;
+  }
+  cur = &watch->pending[watch->pending_ct++];
+  strcpy(cur->name, name);
+  cur->first_ns = cur->last_ns = now;
+  cur->change_ct = 1;
+  return 0;
+}
+
+/// Drain every event queued on fd. @return 1 if dir went away, 0 if not, -1 on error.
+static int asset_watch_read(AssetWatch_t *watch, int fd) {
+  char buf[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+  const int64_t now = Asset_Watch_Now_Ns();
+  ssize_t len;
+  int gone = 0;
+  while (0 < (len = read(fd, buf, sizeof(buf)))) {
+    for (char *cur = buf; cur < buf + len; ) {
+      const struct inotify_event *ev = (const struct inotify_event*)cur;
+      cur += sizeof(*ev) + ev->len;
+      if (ev->mask & (IN_DELETE_SELF | IN_MOVE_SELF | IN_IGNORED)) {
+        gone = 1;
+        continue;
+      }
+      // the queue overflowed, so some changes never made it
+      if (ev->mask & IN_Q_OVERFLOW)
+        continue;
+      if (!ev->len || (ev->mask & IN_ISDIR) || ev->name[0] == '.')
+        continue;
+      if (0 > asset_watch_note(watch, ev->name, now))
+        return -1;
+    }
+  }
+  if (len < 0 && errno != EAGAIN && errno != EINTR)
+    return -1;
+  return gone;
+}
+
+int Asset_Watch_Run(const char *dir, int debounce_ms, Asset_Watch_Cb_t cb,
+    void *arg, volatile sig_atomic_t *stop) {
+  AssetWatch_t watch = {0};
+  struct pollfd pfd = { .events = POLLIN };
+  int ret = 0, gone = 0, errno_save;
+  if (debounce_ms <= 0)
+    debounce_ms = ASSET_WATCH_DEFAULT_DEBOUNCE_MS;
+  const int64_t debounce_ns = debounce_ms*1000000LL;
+  if (0 > (pfd.fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC)))
+    return -1;
+  if (0 > inotify_add_watch(pfd.fd, dir, ASSET_WATCH_MASK | IN_ONLYDIR)) {
+    errno_save = errno;
+    close(pfd.fd);
+    errno = errno_save;
+    return -1;
+  }
+
+  while (!*stop && !gone) {
+    int timeout = -1;
+    int64_t now;
+    // sleep until the soonest debounce runs out, rounding up to a whole ms
+    if (watch.pending_ct) {
+      int64_t soonest = watch.pending[0].last_ns;
+      for (int i = 1; i < watch.pending_ct; ++i)
+        if (watch.pending[i].last_ns < soonest)
+          soonest = watch.pending[i].last_ns;
+      soonest += debounce_ns - Asset_Watch_Now_Ns();
+      timeout = soonest <= 0 ? 0 : (int)((soonest + 999999)/1000000);
+    }
+    if (0 > poll(&pfd, 1, timeout)) {
+      if (errno == EINTR)
+        continue;
+      ret = -1;
+      break;
+    }
+    if ((pfd.revents & POLLIN) && 0 > (gone = asset_watch_read(&watch, pfd.fd))) {
+      ret = -1;
+      break;
+    }
+
+    // fire whatever's settled, oldest change first
+    now = Asset_Watch_Now_Ns();
+    for (;;) {
+      int settled = -1;
+      for (int i = 0; i < watch.pending_ct; ++i)
+        if (watch.pending[i].last_ns + debounce_ns <= now
+            && (settled < 0
+              || watch.pending[i].first_ns < watch.pending[settled].first_ns))
+          settled = i;
+      if (settled < 0 || *stop)
+        break;
+      AssetWatchPending_t ready = watch.pending[settled];
+      watch.pending[settled] = watch.pending[--watch.pending_ct];
+      cb(&(AssetWatchEvent_t) {
+          .name = ready.name,
+          .first_ns = ready.first_ns,
+          .last_ns = ready.last_ns,
+          .change_ct = ready.change_ct
+        }, arg);
+    }
+  }
+
+  errno_save = errno;
+  free(watch.pending);
+  close(pfd.fd);
+  errno = errno_save;
+  return ret;
+}
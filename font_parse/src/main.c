@@ -8,6 +8,12 @@
 #include <assert.h>
 #include <stdbool.h>
 #include "bmp_parse.h"
+#include "hex_emit.h"
+#include "asset_cache.h"
+#include "asset_watch.h"
+#include <errno.h>
+#include <signal.h>
+#include <strings.h>
 
 #define perr(s) fputs("\x1b[1;31m[Error]:\x1b[0m "s, stderr)
 #define perrf(fmt, ...) fprintf(stderr, "\x1b[1;31m[Error]:\x1b[0m "fmt, __VA_ARGS__)
@@ -199,8 +205,9 @@ bool Font_Parse(FontCtx_t *dest, Pal_BMP_t *glyph_set) {
     }
   } while (ofs < lim);
   
-  dest->glyph_set = glyph_buf_cursor = malloc(cell_height*(glyph_list->len));
-  dest->glyph_widths = widths_cursor = malloc(sizeof(uint16_t)*(glyph_list->len));
+  // a dest parsed into before (as in --watch) gets its buffers reused
+  dest->glyph_set = glyph_buf_cursor = realloc(dest->glyph_set, cell_height*(glyph_list->len));
+  dest->glyph_widths = widths_cursor = realloc(dest->glyph_widths, sizeof(uint16_t)*(glyph_list->len));
   dest->cell_size = cell_height;
   dest->cell_height = cell_height;
   dest->cell_width = cell_width;
@@ -211,6 +218,7 @@ bool Font_Parse(FontCtx_t *dest, Pal_BMP_t *glyph_set) {
       *glyph_buf_cursor++ = tmp.pbuf[i];
     }
     *widths_cursor++ = (uint16_t)tmp.width;
+    free((void*)(tmp.pbuf));
   }
 
   LL_Close(glyph_list, false);
@@ -265,6 +273,8 @@ bool Export_Font(FontCtx_t *font, const char *font_name, const char *outdir, int
   }
 
   printf("outpath: %s\n", file_name);
+  // may be hard-linked to an output cache entry, so replace it, don't overwrite it
+  remove(file_name);
   FILE *fp = fopen(file_name, "w");
   if (!fp)
     return false;
@@ -294,6 +304,7 @@ bool Export_Font(FontCtx_t *font, const char *font_name, const char *outdir, int
 
   fclose(fp);
   file_name[file_name_len-1] = 'c';
+  remove(file_name);
   if (!(fp = fopen(file_name, "w")))
     return false;
   fprintf(fp,
@@ -316,44 +327,39 @@ bool Export_Font(FontCtx_t *font, const char *font_name, const char *outdir, int
     return false;
   }
 
+  // 8 elements a row, each but the last followed by a comma
+  HexEmitFormat_t fmt = {
+    .elem_bytes = 2, .cols = 8, .lowercase = 1, 
+    .first = "\n  ", .row = ",\n  ", .sep = ", "
+  };
+  HexEmitter_t emit;
   fprintf(fp, "const unsigned short %s_GlyphData[%d] = {", font_name, data_nmemb);
+  if (0 > Hex_Emit_Begin(&emit, fp, &fmt)) {
+    perr("Failed to allocate glyph data output buffer.\n");
+    fclose(fp);
+    return false;
+  }
   {
     uint16_t *data = (uint16_t*)(font->glyph_set + (font->cell_size*(glyph_ct!=font->glyph_ct ? lb : 0)));
-    int last_idx = data_nmemb-1, i;
-    for (i = 0; i < last_idx; ++i) {
-      if (!(i&7)) {
-        fprintf(fp, "\n  0x%04x,", data[i]);
-      } else {
-        fprintf(fp, " 0x%04x,", data[i]);
-      }
-    }
-    
-    if (!(last_idx&7)) {
-      fprintf(fp, "\n  0x%04x\n};\n\n", data[last_idx]);
-    } else {
-      fprintf(fp, " 0x%04x\n};\n\n", data[last_idx]);
-    }
+    Hex_Emit_Elems(&emit, data, data_nmemb);
+    Hex_Emit_Str(&emit, "\n};\n\n");
+    Hex_Emit_End(&emit);
   }
   
   {
     uint16_t *widths = font->glyph_widths + (glyph_ct != font->glyph_ct ? lb : 0);
-    int i, last_idx;
     data_nmemb = glyph_ct;
-    last_idx = data_nmemb-1;
+    fmt.elem_bytes = 1;
     fprintf(fp, "const unsigned char %s_GlyphWidths[%d] = {", font_name, data_nmemb);
-    for (i = 0; i < last_idx; ++i) {
-      if (!(i&7)) {
-        fprintf(fp, "\n  0x%02x,", 0xFF&widths[i]);
-      } else {
-        fprintf(fp, " 0x%02x,", 0xFF&widths[i]);
-      }
+    if (0 > Hex_Emit_Begin(&emit, fp, &fmt)) {
+      perr("Failed to allocate glyph widths output buffer.\n");
+      fclose(fp);
+      return false;
     }
-
-    if (!(last_idx&7)) {
-      fprintf(fp, "\n  0x%02x\n};\n\n", 0xFF&widths[last_idx]);
-    } else {
-      fprintf(fp, " 0x%02x\n};\n\n", 0xFF&widths[last_idx]);
-    } 
+    for (int i = 0; i < data_nmemb; ++i)
+      Hex_Emit_Elem(&emit, widths[i]);
+    Hex_Emit_Str(&emit, "\n};\n\n");
+    Hex_Emit_End(&emit);
   }
   
   fclose(fp);
@@ -367,6 +373,80 @@ bool Export_Font(FontCtx_t *font, const char *font_name, const char *outdir, int
 
   
 
+}
+
+/// The files Export_Font writes for font_name, relative to its outdir.
+bool Font_Output_Files(AssetCacheFiles_t *dest, const char *font_name) {
+  char name[strlen(font_name)+3];
+  *dest = (AssetCacheFiles_t){0};
+  snprintf(name, sizeof(name), "%s.h", font_name);
+  if (0 > Asset_Cache_Files_Add(dest, name))
+    return false;
+  name[sizeof(name)-2] = 'c';
+  return 0 <= Asset_Cache_Files_Add(dest, name);
+}
+
+/// Write <outdir><font name>.d, making both exported files depend on the bmp.
+bool Export_Depfile(const char *outdir, const char *font_name, const char *bmp_path) {
+  AssetCacheFiles_t outputs;
+  char path[strlen(outdir)+strlen(font_name)+3];
+  snprintf(path, sizeof(path), "%s%s.d", outdir, font_name);
+  return Font_Output_Files(&outputs, font_name)
+    && 0 <= Asset_Depfile_Write(path, outdir, &outputs, &bmp_path, 1);
+}
+
+/// The exported files don't mention the bmp's path, just what's in it.
+void Font_Cache_Desc(char *dest, size_t dest_size, const char *font_name, int lb, int ub) {
+  snprintf(dest, dest_size, "font-parse name=%s range=%d-%d", font_name, lb, ub);
+}
+
+/**
+ * Look the font parsed from bmp_path up in cache_dir (if set), placing its files in outdir
+ * (ending in a '/') and writing its depfile on a hit. key has to have been started on the
+ * font's desc already.
+ * @return 1 on a hit, 0 on a miss, -1 on failure (reported).
+ */
+int Font_Cache_Fetch(const char *cache_dir, AssetCacheKey_t *key, const char *bmp_path,
+    const char *font_name, const char *outdir, bool depfile) {
+  AssetCacheFiles_t outputs;
+  int outcome;
+  if (!cache_dir)
+    return 0;
+  if (0 > Asset_Cache_Key_Add_File(key, bmp_path)) {
+    perrf("Failed to read %s.\n\t%s\n", bmp_path, strerror(errno));
+    return -1;
+  }
+  outcome = Asset_Cache_Fetch(cache_dir, key, outdir, &outputs);
+  if (0 > outcome) {
+    warnf("Failed to place cached font files (%s). Parsing it instead.\n", 
+        strerror(errno));
+    return 0;
+  }
+  if (!outcome)
+    return 0;
+  printf("Output cache hit: %d files linked in from %s\n", outputs.ct, cache_dir);
+  if (depfile && !Export_Depfile(outdir, font_name, bmp_path)) {
+    perrf("Failed to write Make dependency file.\n\t%s\n", strerror(errno));
+    return -1;
+  }
+  return 1;
+}
+
+/// After Export_Font: add its files to cache_dir (if set), and write the depfile. @return false if the depfile failed.
+bool Font_Cache_Store(const char *cache_dir, const AssetCacheKey_t *key, const char *bmp_path,
+    const char *font_name, const char *outdir, bool depfile) {
+  AssetCacheFiles_t outputs;
+  if (cache_dir) {
+    if (!Font_Output_Files(&outputs, font_name) 
+        || 0 > Asset_Cache_Store(cache_dir, key, outdir, &outputs))
+      warnf("Failed to add font files to the output cache, %s (%s).\n", 
+          cache_dir, strerror(errno));
+  }
+  if (depfile && !Export_Depfile(outdir, font_name, bmp_path)) {
+    perrf("Failed to write Make dependency file.\n\t%s\n", strerror(errno));
+    return false;
+  }
+  return true;
 }
 
 bool Check_FontName(const char *name) {
@@ -458,6 +538,114 @@ void verdana_render_glyph_id(SDL_Renderer *ren, FontCtx_t *font, const int win_w
 
 }
 
+typedef struct s_FontWatch {
+  const char *dir;
+  const char *outdir;  // ends in a '/'
+  const char *cache_dir;
+  bool depfile;
+  int lb, ub;
+  FontCtx_t font;  // kept from one font to the next, so its buffers get reused
+  unsigned event_ct, fail_ct;
+  int64_t total_latency_ns, max_latency_ns;
+} FontWatch_t;
+
+static volatile sig_atomic_t watch_stop = 0;
+
+static void Watch_Stop_Handler(int signo) {
+  (void)signo;
+  watch_stop = 1;
+}
+
+/// Parse and export one font, without the preview window.
+bool Watch_Build_Font(FontWatch_t *watch, const char *bmp_path, const char *font_name) {
+  Pal_BMP_t bmp;
+  bool ret = false;
+  int outcome = Pal_BMP_Parse(&bmp, bmp_path);
+  if (0 > outcome) {
+    perrf("Parsing %s failed. Details below:\n\t%s\n", bmp_path, 
+        BMP_Parse_Strerror(outcome));
+    return false;
+  }
+  Glyph_Get_Dimms(&bmp);
+  if (cell_width!=8)
+    perrf("\x1b[1mUnexpected width for glyphs in %s.\n\tActual Glyph Width: \x1b[34m%d"
+        "\x1b[0m\n\t\x1b[1mExpected: \x1b[34m8\x1b[0m\n", bmp_path, cell_width);
+  else if (!Font_Parse(&watch->font, &bmp))
+    perrf("Something failed during font parsing of %s.\n", bmp_path);
+  else if (!Export_Font(&watch->font, font_name, watch->outdir, watch->lb, watch->ub))
+    perr("Font exportation failed.\n");
+  else
+    ret = true;
+  Pal_BMP_Close(&bmp);
+  return ret;
+}
+
+void Watch_Font_Cb(const AssetWatchEvent_t *ev, void *arg) {
+  FontWatch_t *watch = arg;
+  const size_t name_len = strlen(ev->name);
+  // only <font name>.bmp; everything else (e.g.: what we wrote to it) gets left alone
+  if (name_len <= 4 || strcasecmp(ev->name + name_len - 4, ".bmp"))
+    return;
+  char font_name[name_len-3], path[strlen(watch->dir)+name_len+2], desc[name_len+64];
+  memcpy(font_name, ev->name, name_len-4);
+  font_name[name_len-4] = '\0';
+  if (!Check_FontName(font_name)) {
+    warnf("Skipping %s: font names must only consist of alphabetical characters "
+        "and underscores.\n", ev->name);
+    return;
+  }
+  snprintf(path, sizeof(path), "%s/%s", watch->dir, ev->name);
+
+  AssetCacheKey_t key;
+  Font_Cache_Desc(desc, sizeof(desc), font_name, watch->lb, watch->ub);
+  Asset_Cache_Key_Init(&key, desc);
+  const int64_t start_ns = Asset_Watch_Now_Ns();
+  int outcome = Font_Cache_Fetch(watch->cache_dir, &key, path, font_name, watch->outdir,
+      watch->depfile);
+  const bool ok = outcome > 0 || (!outcome && Watch_Build_Font(watch, path, font_name)
+      && Font_Cache_Store(watch->cache_dir, &key, path, font_name, watch->outdir, 
+        watch->depfile));
+  const int64_t done_ns = Asset_Watch_Now_Ns(), latency_ns = done_ns - ev->last_ns;
+
+  ++watch->event_ct;
+  if (!ok) {
+    ++watch->fail_ct;
+    return;
+  }
+  watch->total_latency_ns += latency_ns;
+  if (latency_ns > watch->max_latency_ns)
+    watch->max_latency_ns = latency_ns;
+  printf("\x1b[1;34m[Watch]\x1b[0m %s: exported in %.2f ms, %.2f ms after its last "
+      "change (%d change%s)\n", path, (done_ns - start_ns)/1e6, latency_ns/1e6, 
+      ev->change_ct, ev->change_ct == 1 ? "" : "s");
+  fflush(stdout);
+}
+
+/// Export every <font name>.bmp in dir as it changes, until SIGINT/SIGTERM.
+int Watch_Fonts(FontWatch_t *watch, const char *dir) {
+  struct sigaction sa = { .sa_handler = Watch_Stop_Handler };
+  sigemptyset(&sa.sa_mask);
+  // no SA_RESTART, so the watcher's poll wakes up for it
+  sigaction(SIGINT, &sa, NULL);
+  sigaction(SIGTERM, &sa, NULL);
+  watch->dir = dir;
+  printf("Watching %s for glyphset bmps (exporting to %s). Ctrl-C to stop.\n", 
+      dir, watch->outdir);
+  fflush(stdout);
+  int ret = Asset_Watch_Run(dir, ASSET_WATCH_DEFAULT_DEBOUNCE_MS, Watch_Font_Cb, watch, 
+      &watch_stop);
+  if (0 > ret)
+    perrf("Failed to watch %s.\n\t%s\n", dir, strerror(errno));
+  Font_Close(&watch->font);
+  const unsigned ok_ct = watch->event_ct - watch->fail_ct;
+  printf("\n\x1b[1;34m[Watch]\x1b[0m %u fonts exported, %u failed", ok_ct, watch->fail_ct);
+  if (ok_ct)
+    printf("; %.2f ms avg, %.2f ms max from last change to exported", 
+        watch->total_latency_ns/1e6/ok_ct, watch->max_latency_ns/1e6);
+  putchar('\n');
+  return 0 > ret || watch->fail_ct;
+}
+
 void print_bad_range_arg_error(const char *arg) {
   perrf("Invalid font range arg, \"%s\".\n"
       "\t\x1b[1;34mProper format: \x1b[39m<lower bound>-<upper bound>\x1b[0m\n"
@@ -472,9 +660,12 @@ void print_bad_range_arg_error(const char *arg) {
 void print_usage_and_exit(const char *err_message, const char *exename) {
   perrf("%s. Usage below:\n"
     "\t\x1b[1m%s <bmp path> <font name> [option args (opts)]\x1b[0m\n"
+    "\t\x1b[1m%s --watch <bmp dir> [option args (opts)]\x1b[0m\n"
     "\t\t\x1b[1;34m[Options (Opts)]:\x1b[0m\n"
     "\t\t\t\x1b[1;32m--outdir\x1b[33m <output dir path>\x1b[0m\n"
-    "\t\t\t\x1b[1;32m--range\x1b[33m <index range>\x1b[0m\n", err_message, exename);
+    "\t\t\t\x1b[1;32m--range\x1b[33m <index range>\x1b[0m\n"
+    "\t\t\t\x1b[1;32m--cache\x1b[33m <output cache dir path>\x1b[0m\n"
+    "\t\t\t\x1b[1;32m--depfile\x1b[0m\n", err_message, exename, exename);
   exit(1);
 } __attribute__ ((noreturn));
 
@@ -482,105 +673,131 @@ int main(int argc, char *argv[]) {
 
   Pal_BMP_t bmp;
   FontCtx_t font = {0};
-  char *outdir = "./";
+  char *outdir = "./", *range = NULL, *cache_dir = NULL;
   int outcome, lower_bound = -1, upper_bound = -1;
-  bool is_verdana = false;
-  if (argc!=3) {
-    if (5!=(argc&5) || 0!=(argc&(~7))) {
-      if (argc==2 && *(uint16_t*)argv[1] == *(uint16_t*)"-h") {
-        printf("\x1b[1;34m%s\x1b[0m: A glyphset parser for creating raw, 1 "
-            "bit-per-pixel font resources in C for the GBA\n"
-            "\t\x1b[1;31m[Usage]:\x1b[39m \x1n[34m%s\x1b[33m <glyphset bmp path> "
-            "<font name> \x1b[32m[option args (opts)]\x1b[0m\n"
-            "\t\t\x1b[1;34m[Options (Opts)]:\x1b[0m\n"
-            "\t\t\t\x1b[1;32m--outdir\x1b[33m <output dir path>\n"
-            "\t\t\t\x1b[1;32m--range\x1b[33m <index range>\n" , 
-            argv[0], argv[0]);
-        return 0;
-      }
-      print_usage_and_exit("Invalid arg count", argv[0]);
-
+  bool is_verdana = false, outdir_set = false, depfile = false, watch_mode = false;
+  if (argc < 3) {
+    if (argc==2 && *(uint16_t*)argv[1] == *(uint16_t*)"-h") {
+      printf("\x1b[1;34m%s\x1b[0m: A glyphset parser for creating raw, 1 "
+          "bit-per-pixel font resources in C for the GBA\n"
+          "\t\x1b[1;31m[Usage]:\x1b[39m \x1n[34m%s\x1b[33m <glyphset bmp path> "
+          "<font name> \x1b[32m[option args (opts)]\x1b[0m\n"
+          "\t\x1b[1;31m[Watch]:\x1b[39m \x1b[34m%s --watch\x1b[33m <glyphset bmp dir> "
+          "\x1b[32m[option args (opts)]\x1b[0m\n"
+          "\t\t\x1b[3mExports each <font name>.bmp in the dir whenever it changes, "
+          "until Ctrl-C.\x1b[0m\n"
+          "\t\t\x1b[1;34m[Options (Opts)]:\x1b[0m\n"
+          "\t\t\t\x1b[1;32m--outdir\x1b[33m <output dir path>\n"
+          "\t\t\t\x1b[1;32m--range\x1b[33m <index range>\n"
+          "\t\t\t\x1b[1;32m--cache\x1b[33m <output cache dir path>\n"
+          "\t\t\t\x1b[1;32m--depfile\x1b[0m\n" , 
+          argv[0], argv[0], argv[0]);
+      return 0;
     }
+    print_usage_and_exit("Invalid arg count", argv[0]);
+  }
+  // --watch <bmp dir> stands in for <bmp path> <font name>
+  watch_mode = !strcmp(argv[1], "--watch");
 
-    int range_idx, outdir_idx;
-    range_idx = outdir_idx = -1;
-    if (!strcmp(argv[3], "--range")) {
-      range_idx = 4;
-    } else if (!strcmp(argv[3], "--outdir")) {
-      outdir_idx = 4;
-    } else {
-      print_usage_and_exit("Invalid option flag", argv[0]);
+  for (int i = 3; i < argc; ++i) {
+    if (!strcmp(argv[i], "--depfile")) {
+      depfile = true;
+      continue;
     }
-    if (argc==7) {
-      if (!strcmp(argv[5], "--range")) {
-        if (range_idx!=-1) {
-          warnf("Ignoring duplicate opt flag for range option, --range."
-              "Using previously-declared range, %s", argv[4]);
-        } else {
-          range_idx = 6;
-        }
-      } else if (!strcmp(argv[5], "--outdir")) {
-        if (outdir_idx != -1) {
-          warnf("Ignoring duplicate opt flag for range option, --outdir."
-              "Using previously-declared output directory, %s", argv[4]);
-        } else {
-          outdir_idx = 6;
-        }
+    if (i+1 == argc)
+      print_usage_and_exit("Missing option arg", argv[0]);
+    if (!strcmp(argv[i], "--range")) {
+      if (range) {
+        warnf("Ignoring duplicate opt flag for range option, --range. "
+            "Using previously-declared range, %s\n", range);
+      } else {
+        range = argv[i+1];
+      }
+    } else if (!strcmp(argv[i], "--outdir")) {
+      if (outdir_set) {
+        warnf("Ignoring duplicate opt flag for output directory option, --outdir. "
+            "Using previously-declared output directory, %s\n", outdir);
+      } else {
+        outdir = argv[i+1];
+        outdir_set = true;
+      }
+    } else if (!strcmp(argv[i], "--cache")) {
+      if (cache_dir) {
+        warnf("Ignoring duplicate opt flag for output cache option, --cache. "
+            "Using previously-declared cache directory, %s\n", cache_dir);
       } else {
-        print_usage_and_exit("Invalid option flag", argv[0]);
+        cache_dir = argv[i+1];
       }
+    } else {
+      print_usage_and_exit("Invalid option flag", argv[0]);
     }
+    ++i;
+  }
 
-
-    char *range = 0>range_idx ? NULL : argv[range_idx];
-    if (range) {
-      char c, *cur = range;
-      bool hyphen_reached = false;
-      while ((c = *cur++)) {
-        if (c == '-') {
-          if (hyphen_reached) {
-            print_bad_range_arg_error(argv[range_idx]);
-            return 1;
-          }
-          hyphen_reached = true;
-          continue;
-        }
-
-        if (!isdigit(c)) {
-          print_bad_range_arg_error(argv[range_idx]);
+  if (range) {
+    char c, *cur = range;
+    bool hyphen_reached = false;
+    while ((c = *cur++)) {
+      if (c == '-') {
+        if (hyphen_reached) {
+          print_bad_range_arg_error(range);
           return 1;
         }
+        hyphen_reached = true;
+        continue;
       }
 
-      if (!hyphen_reached) {
-        print_bad_range_arg_error(argv[range_idx]);
-        return 1;
-      }
-      
-      cur = NULL;
-      if ((lower_bound = strtol(range, &cur, 10)) < 0) {
-        print_bad_range_arg_error(argv[range_idx]);
-        return 1;
-      }
-      if (!(upper_bound = strtol(++cur, &cur, 10)) || upper_bound <= lower_bound) {
-        print_bad_range_arg_error(argv[range_idx]);
+      if (!isdigit(c)) {
+        print_bad_range_arg_error(range);
         return 1;
       }
+    }
 
-      printf("%d-%d\n", lower_bound, upper_bound);
+    if (!hyphen_reached) {
+      print_bad_range_arg_error(range);
+      return 1;
     }
-    if (outdir_idx > 0) {
-      outdir = argv[outdir_idx];
+    
+    cur = NULL;
+    if ((lower_bound = strtol(range, &cur, 10)) < 0) {
+      print_bad_range_arg_error(range);
+      return 1;
     }
+    if (!(upper_bound = strtol(++cur, &cur, 10)) || upper_bound <= lower_bound) {
+      print_bad_range_arg_error(range);
+      return 1;
+    }
+
+    printf("%d-%d\n", lower_bound, upper_bound);
   }
   
 
+  // the cache and depfile want it ending in a '/', like Export_Font does
+  const size_t outdir_len = strlen(outdir);
+  char outdir_slash[outdir_len+2];
+  snprintf(outdir_slash, sizeof(outdir_slash), 
+      (outdir_len && outdir[outdir_len-1] == '/') ? "%s" : "%s/", outdir);
+  if (watch_mode) {
+    FontWatch_t watch = {
+      .outdir = outdir_slash, .cache_dir = cache_dir, .depfile = depfile,
+      .lb = lower_bound, .ub = upper_bound
+    };
+    return Watch_Fonts(&watch, argv[2]);
+  }
+
   if (!Check_FontName(argv[2])) {
     perrf("Invalid font name, \x1b[1m%s\x1b[0m. Font name must only consist"
         " of alphabetical characters and underscores.\n", argv[2]);
     return 1;
   }
 
+  AssetCacheKey_t key;
+  char desc[strlen(argv[2])+64];
+  Font_Cache_Desc(desc, sizeof(desc), argv[2], lower_bound, upper_bound);
+  Asset_Cache_Key_Init(&key, desc);
+  if (0 != (outcome = Font_Cache_Fetch(cache_dir, &key, argv[1], argv[2], outdir_slash,
+          depfile)))
+    return 0 > outcome;
     
   is_verdana = strcmp(argv[1], "verdana9.bmp");
  
@@ -785,6 +1002,8 @@ int main(int argc, char *argv[]) {
   if (!Export_Font(&font, argv[2], outdir, lower_bound, upper_bound)) {
     ret = 1;
     perr("Font exportation failed.\n");
+  } else if (!Font_Cache_Store(cache_dir, &key, argv[1], argv[2], outdir_slash, depfile)) {
+    ret = 1;
   }
 
   Font_Close(&font);
@@ -0,0 +1,88 @@
+/** Hex array emitter for generated C/ASM data tables.
+ * Copyright (C) Burton O Sumner
+ * but you can use it if you want. :)
+ * */
+#ifndef _HEX_EMIT_H_
+#define _HEX_EMIT_H_
+
+#ifdef __cplusplus
+#include <cstdio>
+#include <cstdint>
+#include <cstddef>
+extern "C" {
+#else
+#include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
+#endif  /* CXX name mangler guard */
+
+/* Writes arrays of 8, 16 or 32-bit elements as "0x..." text, rows of cols
+ * elements each, e.g.: the body of a C array initializer, or a run of
+ * .word/.hword/.byte directives. Each byte's two hex digits come out of a
+ * lookup table, and the text builds up in one big buffer that goes out a
+ * HEX_EMIT_BUF_SIZE chunk at a time, instead of an fprintf per element.
+ * Nothing else may write to the FILE between Hex_Emit_Begin and
+ * Hex_Emit_End, since the emitter's buffer would then go out of order
+ * with the FILE's own. */
+
+#define HEX_EMIT_BUF_SIZE (1<<18)
+
+typedef struct s_hex_emit_format {
+  int elem_bytes;  /// 1, 2 or 4
+  int cols;  /// Elements per row
+  int lowercase;  /// Hex digits a-f rather than A-F
+  const char *first;  /// Ahead of the very first element
+  const char *row;  /// Ahead of the first element of every row after that
+  const char *sep;  /// Ahead of every other element
+} HexEmitFormat_t;
+
+typedef struct s_hex_emitter {
+  FILE *fp;
+  HexEmitFormat_t fmt;
+  int first_len, row_len, sep_len;
+  int col;  /// Of the next element in its row
+  int started;  /// Whether the first element went out yet
+  int failed;  /// Whether any write to fp came up short
+  char *buf, *cur;
+} HexEmitter_t;
+
+/* Formats for the body of a C word array initializer, after its opening
+ * brace, and for a .word list, after its label, 8 words to a row. */
+#define HEX_EMIT_C_WORDS ((HexEmitFormat_t) { \
+    .elem_bytes = 4, .cols = 8, .first = "", .row = ",\n\t", .sep = ", " })
+#define HEX_EMIT_ASM_WORDS ((HexEmitFormat_t) { \
+    .elem_bytes = 4, .cols = 8, .first = "\n\t.word ", .row = "\n\t.word ", \
+    .sep = ", " })
+
+/**
+ * @summary Start emitting elements to fp, formatted by fmt, with the first
+ * one at column 0. Flushes fp, as whatever it buffered goes first.
+ * @return 0 on success, or -1 if the buffer couldn't be allocated.
+ * */
+int Hex_Emit_Begin(HexEmitter_t *dst, FILE *fp, const HexEmitFormat_t *fmt);
+/// Emit elem_ct elements, elem_bytes each in host byte order, from elems.
+void Hex_Emit_Elems(HexEmitter_t *emitter, const void *elems, size_t elem_ct);
+/// Emit one element, value's low elem_bytes bytes.
+void Hex_Emit_Elem(HexEmitter_t *emitter, uint32_t value);
+/// Emit str as it is, e.g.: the closing brace. Doesn't count as an element.
+void Hex_Emit_Str(HexEmitter_t *emitter, const char *str);
+/**
+ * @summary Write out whatever's buffered and free the buffer. fp can be
+ * written to as usual again after this.
+ * @return 0 if every write went through, -1 otherwise.
+ * */
+int Hex_Emit_End(HexEmitter_t *emitter);
+
+/**
+ * @summary Write elem_ct elements of elem_bytes each to fp as raw
+ * little-endian binary instead, e.g.: for a side file an ASM src file pulls
+ * in with .incbin.
+ * @return 0 on success, -1 if the write came up short.
+ * */
+int Hex_Emit_Raw(FILE *fp, const void *elems, size_t elem_ct, int elem_bytes);
+
+#ifdef __cplusplus
+}
+#endif  /* CXX name mangler guard */
+
+#endif  /* _HEX_EMIT_H_ */
@@ -0,0 +1,166 @@
+#include "hex_emit.h"
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+/// Every byte's two hex digits, byte b's at [2*b], uppercase then lowercase
+static char hex_emit_pairs[2][512];
+static const char hex_emit_digits[2][17] = { "0123456789ABCDEF", "0123456789abcdef" };
+
+/* The pair tables get filled in from hex_emit_digits by a constructor,
+ * before main runs and before any thread could be emitting. */
+__attribute__((constructor))
+static void hex_emit_pairs_init(void) {
+  for (int c = 0; c < 2; ++c)
+    for (int b = 0; b < 256; ++b) {
+      hex_emit_pairs[c][2*b] = hex_emit_digits[c][b>>4];
+      hex_emit_pairs[c][2*b+1] = hex_emit_digits[c][b&15];
+    }
+}
+
+/// Longest one element can get, its prefix included
+static int hex_emit_max_elem_len(const HexEmitter_t *emitter) {
+  int len = emitter->first_len;
+  if (len < emitter->row_len)
+    len = emitter->row_len;
+  if (len < emitter->sep_len)
+    len = emitter->sep_len;
+  return len + 2 + 2*emitter->fmt.elem_bytes;
+}
+
+static void hex_emit_flush(HexEmitter_t *emitter) {
+  const size_t len = emitter->cur - emitter->buf;
+  if (len && len != fwrite(emitter->buf, 1, len, emitter->fp))
+    emitter->failed = 1;
+  emitter->cur = emitter->buf;
+}
+
+int Hex_Emit_Begin(HexEmitter_t *dst, FILE *fp, const HexEmitFormat_t *fmt) {
+  assert(fmt->elem_bytes == 1 || fmt->elem_bytes == 2 || fmt->elem_bytes == 4);
+  assert(fmt->cols > 0);
+  *dst = (HexEmitter_t) {
+    .fp = fp,
+    .fmt = *fmt,
+    .first_len = strlen(fmt->first),
+    .row_len = strlen(fmt->row),
+    .sep_len = strlen(fmt->sep)
+  };
+  assert(hex_emit_max_elem_len(dst) < HEX_EMIT_BUF_SIZE);
+  if (NULL == (dst->buf = dst->cur = malloc(HEX_EMIT_BUF_SIZE)))
+    return -1;
+  fflush(fp);
+  return 0;
+}
+
+/* Element loop for elem_bytes bytes per element, a constant wherever it's
+ * inlined, so each width gets a loop of its own with no per-element switch. */
+static inline void hex_emit_elems_n(HexEmitter_t *emitter, const uint8_t *elems,
+    size_t elem_ct, const int elem_bytes) {
+  const char *const pairs = hex_emit_pairs[emitter->fmt.lowercase ? 1 : 0];
+  const char *const end = emitter->buf + HEX_EMIT_BUF_SIZE - hex_emit_max_elem_len(emitter);
+  const int cols = emitter->fmt.cols;
+  int col = emitter->col;
+  char *cur = emitter->cur;
+  for (const uint8_t *last = elems + elem_ct*elem_bytes; elems != last; elems += elem_bytes) {
+    uint32_t value;
+    if (cur > end) {
+      emitter->cur = cur;
+      hex_emit_flush(emitter);
+      cur = emitter->cur;
+    }
+    if (col) {
+      memcpy(cur, emitter->fmt.sep, emitter->sep_len);
+      cur += emitter->sep_len;
+    } else if (emitter->started) {
+      memcpy(cur, emitter->fmt.row, emitter->row_len);
+      cur += emitter->row_len;
+    } else {
+      memcpy(cur, emitter->fmt.first, emitter->first_len);
+      cur += emitter->first_len;
+      emitter->started = 1;
+    }
+    if (++col == cols)
+      col = 0;
+    *cur++ = '0';
+    *cur++ = 'x';
+    if (elem_bytes == 4) {
+      memcpy(&value, elems, 4);
+      memcpy(cur, pairs + 2*(value>>24), 2);
+      memcpy(cur+2, pairs + 2*((value>>16)&0xFF), 2);
+      memcpy(cur+4, pairs + 2*((value>>8)&0xFF), 2);
+      memcpy(cur+6, pairs + 2*(value&0xFF), 2);
+      cur += 8;
+    } else if (elem_bytes == 2) {
+      uint16_t half;
+      memcpy(&half, elems, 2);
+      value = half;
+      memcpy(cur, pairs + 2*(value>>8), 2);
+      memcpy(cur+2, pairs + 2*(value&0xFF), 2);
+      cur += 4;
+    } else {
+      memcpy(cur, pairs + 2*elems[0], 2);
+      cur += 2;
+    }
+  }
+  emitter->col = col;
+  emitter->cur = cur;
+}
+
+void Hex_Emit_Elems(HexEmitter_t *emitter, const void *elems, size_t elem_ct) {
+  switch (emitter->fmt.elem_bytes) {
+    case 4:
+      hex_emit_elems_n(emitter, elems, elem_ct, 4);
+      break;
+    case 2:
+      hex_emit_elems_n(emitter, elems, elem_ct, 2);
+      break;
+    default:
+      hex_emit_elems_n(emitter, elems, elem_ct, 1);
+      break;
+  }
+}
+
+void Hex_Emit_Elem(HexEmitter_t *emitter, uint32_t value) {
+  if (emitter->fmt.elem_bytes == 4) {
+    Hex_Emit_Elems(emitter, &value, 1);
+  } else if (emitter->fmt.elem_bytes == 2) {
+    const uint16_t half = value;
+    Hex_Emit_Elems(emitter, &half, 1);
+  } else {
+    const uint8_t byte = value;
+    Hex_Emit_Elems(emitter, &byte, 1);
+  }
+}
+
+void Hex_Emit_Str(HexEmitter_t *emitter, const char *str) {
+  const size_t len = strlen(str);
+  if (len > (size_t)(emitter->buf + HEX_EMIT_BUF_SIZE - emitter->cur)) {
+    hex_emit_flush(emitter);
+    if (len > HEX_EMIT_BUF_SIZE) {
+      if (len != fwrite(str, 1, len, emitter->fp))
+        emitter->failed = 1;
+      return;
+    }
+  }
+  memcpy(emitter->cur, str, len);
+  emitter->cur += len;
+}
+
+int Hex_Emit_End(HexEmitter_t *emitter) {
+  hex_emit_flush(emitter);
+  free(emitter->buf);
+  emitter->buf = emitter->cur = NULL;
+  return emitter->failed ? -1 : 0;
+}
+
+int Hex_Emit_Raw(FILE *fp, const void *elems, size_t elem_ct, int elem_bytes) {
+  const uint16_t probe = 1;
+  if (elem_bytes == 1 || *(const uint8_t*)&probe)
+    return elem_ct == fwrite(elems, elem_bytes, elem_ct, fp) ? 0 : -1;
+  // big-endian host: byte-swap each element on the way out
+  for (const uint8_t *elem = elems; elem_ct--; elem += elem_bytes)
+    for (int i = elem_bytes-1; i >= 0; --i)
+      if (EOF == fputc(elem[i], fp))
+        return -1;
+  return 0;
+}
@@ -0,0 +1,143 @@
+#ifndef _BENCH_INPUT_H_
+#define _BENCH_INPUT_H_
+
+/* Inputs and timing shared by the benchmarks in this directory. Everything's
+ * static, as each benchmark is a single translation unit of its own. */
+
+#include "huffman.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define BENCH_SYNTH_BYTE_CT (4*1024*1024)
+#define BENCH_DEFAULT_ITER_CT 5
+#define BENCH_SEED 0x2545f491u
+
+/// Synthetic inputs, in the order bench_parse_args hands them out
+typedef enum e_bench_synth {
+  BENCH_SYNTH_RANDOM=0,
+  BENCH_SYNTH_SKEWED,
+  BENCH_SYNTH_FIBONACCI,
+  BENCH_SYNTH_CT
+} BenchSynth_e;
+
+static const char *const bench_synth_names[BENCH_SYNTH_CT] = {
+  [BENCH_SYNTH_RANDOM] = "[random 4 MB]",
+  [BENCH_SYNTH_SKEWED] = "[skewed 4 MB]",
+  [BENCH_SYNTH_FIBONACCI] = "[fibonacci 4 MB]"
+};
+
+typedef struct s_bench_input {
+  const char *name;
+  byte *data;
+  size_t byte_ct;  /// Zero-padded out to a whole word, same as the CLI does
+} BenchInput_t;
+
+static double bench_now(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec/1e9;
+}
+
+/// xorshift32
+static uint32_t bench_rand(uint32_t *state) {
+  uint32_t x = *state;
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  return *state = x;
+}
+
+/**
+ * @brief Uniformly random bytes, where every code is about as long as the
+ * data unit and nothing repeats, skewed ones, where a few short codes cover
+ * most of the input, or the Fibonacci word over "ab", which repeats itself
+ * at every scale, for the dictionary coders. The random ones are from a 
+ * fixed seed, so every run gets the same bytes.
+ * */
+static int bench_synth(BenchInput_t *dst, BenchSynth_e kind) {
+  uint32_t state = BENCH_SEED;
+  dst->name = bench_synth_names[kind];
+  dst->byte_ct = BENCH_SYNTH_BYTE_CT;
+  if (NULL == (dst->data = malloc(dst->byte_ct)))
+    return -1;
+  if (kind == BENCH_SYNTH_FIBONACCI) {
+    // S(n) = S(n-1)S(n-2), and S(n-2) is a prefix of S(n-1), so each step
+    // just appends the start of what's there
+    size_t len = 2, prev_len = 1;
+    memcpy(dst->data, "ab", 2);
+    while (len < dst->byte_ct) {
+      const size_t add = prev_len < dst->byte_ct - len ? prev_len 
+        : dst->byte_ct - len;
+      memcpy(dst->data + len, dst->data, add);
+      prev_len = len;
+      len += add;
+    }
+    return 0;
+  }
+  for (size_t i = 0; i < dst->byte_ct; ++i) {
+    const uint32_t r = bench_rand(&state);
+    // trailing zero count is geometric, so each value's half as likely as
+    // the one before it
+    dst->data[i] = kind == BENCH_SYNTH_SKEWED 
+      ? (byte)(__builtin_ctz(r | 0x80000000u)*0x25) : (byte)(r >> 24);
+  }
+  return 0;
+}
+
+static int bench_load(BenchInput_t *dst, const char *path) {
+  FILE *fp = fopen(path, "rb");
+  long len;
+  if (!fp)
+    return -1;
+  if (0 != fseek(fp, 0L, SEEK_END) || 0 >= (len = ftell(fp))) {
+    fclose(fp);
+    return -1;
+  }
+  rewind(fp);
+  dst->name = path;
+  dst->byte_ct = (len + 3) & ~3L;
+  if (NULL == (dst->data = calloc(dst->byte_ct, 1))
+      || (size_t)len != fread(dst->data, 1, len, fp)) {
+    free(dst->data);
+    fclose(fp);
+    return -1;
+  }
+  fclose(fp);
+  return 0;
+}
+
+/**
+ * @brief Parse the args every benchmark takes: [-i <iterations>] [file]...
+ * With no files, inputs gets the first synth_ct synthetic ones.
+ * @param inputs Room for argc+synth_ct of them.
+ * @return Input count, or -1 on failure (already reported).
+ * */
+static int bench_parse_args(int argc, char *argv[], BenchInput_t *inputs,
+    int *iter_ct, int synth_ct) {
+  int input_ct = 0;
+  *iter_ct = BENCH_DEFAULT_ITER_CT;
+  for (int i = 1; i < argc; ++i) {
+    if (!strcmp("-i", argv[i]) && i+1 < argc) {
+      if (0 >= (*iter_ct = atoi(argv[++i]))) {
+        fprintf(stderr, "Invalid iteration count, %s.\n", argv[i]);
+        return -1;
+      }
+    } else if (0 > bench_load(&inputs[input_ct++], argv[i])) {
+      fprintf(stderr, "Failed to read %s, or it's empty.\n", argv[i]);
+      return -1;
+    }
+  }
+  if (!input_ct) {
+    for (; input_ct < synth_ct; ++input_ct) {
+      if (0 > bench_synth(&inputs[input_ct], input_ct)) {
+        fprintf(stderr, "Failed to allocate synthetic inputs.\n");
+        return -1;
+      }
+    }
+  }
+  return input_ct;
+}
+
+#endif  /* _BENCH_INPUT_H_ */
@@ -0,0 +1,71 @@
+/* Throughput benchmark for the Huffman encoder. Builds a tree for each
+ * input, then times compressing it over and over, and reports MB/s of
+ * input for the compression alone, at both bit depths.
+ * With no files given, it runs on the two synthetic inputs from
+ * bench_input.h, which come out the same every run.
+ * Only the original one-shot API gets used, so the file can be dropped into
+ * an older checkout to get the "before" numbers for a change. (Trees from
+ * before the flat codebase keep a copy of the input on the stack while
+ * compressing, so run those under "ulimit -s unlimited".)
+ * Usage: huff_bench.elf [-i <iterations>] [file]... */
+#include "bench_input.h"
+#include "huffman.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+/// Random and skewed, as the Fibonacci word is there for LZ77
+#define SYNTH_CT BENCH_SYNTH_FIBONACCI
+
+/// @return MB/s, or a negative number on failure (already reported).
+static double bench_compress(const BenchInput_t *in, DataSize_e bitdepth,
+    int iter_ct) {
+  const int word_ct = in->byte_ct/4;
+  HuffTree_t *tree = Huff_Tree_Create(in->data, word_ct, bitdepth);
+  uint32_t *compdata;
+  double start, elapsed;
+  int complen;
+  if (!tree) {
+    fprintf(stderr, "%s: Failed to create tree: %s\n", in->name,
+        Huff_Strerror());
+    return -1;
+  }
+  start = bench_now();
+  for (int i = 0; i < iter_ct; ++i) {
+    if (NULL == (compdata = Huff_Compress(in->data, tree, word_ct,
+            &complen))) {
+      fprintf(stderr, "%s: Failed to compress: %s\n", in->name,
+          Huff_Strerror());
+      Huff_Tree_Destroy(tree);
+      return -1;
+    }
+    free(compdata);
+  }
+  elapsed = bench_now() - start;
+  Huff_Tree_Destroy(tree);
+  return (double)in->byte_ct*iter_ct/elapsed/1e6;
+}
+
+int main(int argc, char *argv[]) {
+  BenchInput_t inputs[argc+SYNTH_CT];
+  int input_ct, iter_ct, ret = 0;
+  if (0 > (input_ct = bench_parse_args(argc, argv, inputs, &iter_ct,
+          SYNTH_CT)))
+    return 1;
+
+  printf("%-24s %8s %14s\n", "input", "bitdepth", "compress");
+  for (int i = 0; i < input_ct; ++i) {
+    for (DataSize_e bitdepth = E_DATA_UNIT_4_BITS;
+        bitdepth <= E_DATA_UNIT_8_BITS; bitdepth += 4) {
+      const double compress_mbs = bench_compress(&inputs[i], bitdepth,
+          iter_ct);
+      if (compress_mbs < 0) {
+        ret = 1;
+        continue;
+      }
+      printf("%-24s %8d %9.1f MB/s\n", inputs[i].name, bitdepth,
+          compress_mbs);
+    }
+    free(inputs[i].data);
+  }
+  return ret;
+}
@@ -0,0 +1,92 @@
+/* Compression ratio and throughput benchmark for the LZ77 codec. For each
+ * input, with and without --vram-safe, times compressing it and
+ * decompressing the result the way the SVC it's meant for would, and
+ * reports the output size, its ratio to the input, and MB/s of input for
+ * each direction. Every decode gets checked against its input, so a broken
+ * parse can't post a good ratio.
+ * With no files given, it runs on all three synthetic inputs from
+ * bench_input.h.
+ * Usage: huff_lz77_bench.elf [-i <iterations>] [file]... */
+#include "bench_input.h"
+#include "huff_lz77.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct s_lz77_bench_result {
+  size_t out_byte_ct;
+  double encode_mbs, decode_mbs;
+} LZ77BenchResult_t;
+
+/// @return 0 on success, -1 on failure (already reported).
+static int bench_lz77(const BenchInput_t *in, _Bool vram_safe, int iter_ct,
+    LZ77BenchResult_t *dst) {
+  uint32_t *compdata = NULL;
+  byte *decoded = malloc(in->byte_ct);
+  double start;
+  int word_ct = 0, ret = -1;
+  if (!decoded) {
+    fprintf(stderr, "%s: Failed to allocate decode buffer.\n", in->name);
+    return -1;
+  }
+
+  start = bench_now();
+  for (int i = 0; i < iter_ct; ++i) {
+    free(compdata);
+    if (NULL == (compdata = Huff_LZ77_Compress(in->data, in->byte_ct,
+            vram_safe, &word_ct, NULL))) {
+      fprintf(stderr, "%s: Failed to compress: %s\n", in->name,
+          Huff_Strerror());
+      goto CLEANUP;
+    }
+  }
+  dst->encode_mbs = (double)in->byte_ct*iter_ct/(bench_now() - start)/1e6;
+  dst->out_byte_ct = word_ct*4;
+
+  start = bench_now();
+  for (int i = 0; i < iter_ct; ++i) {
+    if (0 > Huff_LZ77_Decompress(compdata, word_ct*4, decoded, vram_safe)) {
+      fprintf(stderr, "%s: Failed to decode: %s\n", in->name,
+          Huff_Strerror());
+      goto CLEANUP;
+    }
+  }
+  dst->decode_mbs = (double)in->byte_ct*iter_ct/(bench_now() - start)/1e6;
+  if (memcmp(decoded, in->data, in->byte_ct)) {
+    fprintf(stderr, "%s: Decoded output doesn't match the input.\n",
+        in->name);
+    goto CLEANUP;
+  }
+  ret = 0;
+
+CLEANUP:
+  free(compdata);
+  free(decoded);
+  return ret;
+}
+
+int main(int argc, char *argv[]) {
+  BenchInput_t inputs[argc+BENCH_SYNTH_CT];
+  LZ77BenchResult_t result;
+  int input_ct, iter_ct, ret = 0;
+  if (0 > (input_ct = bench_parse_args(argc, argv, inputs, &iter_ct,
+          BENCH_SYNTH_CT)))
+    return 1;
+
+  printf("%-24s %9s %10s %10s %8s %14s %14s\n", "input", "mode", "in", "out",
+      "ratio", "compress", "decompress");
+  for (int i = 0; i < input_ct; ++i) {
+    for (int vram_safe = 0; vram_safe < 2; ++vram_safe) {
+      if (0 > bench_lz77(&inputs[i], vram_safe, iter_ct, &result)) {
+        ret = 1;
+        continue;
+      }
+      printf("%-24s %9s %10zu %10zu %7.1f%% %9.1f MB/s %9.1f MB/s\n",
+          inputs[i].name, vram_safe ? "vram-safe" : "wram", inputs[i].byte_ct,
+          result.out_byte_ct, 100.0*result.out_byte_ct/inputs[i].byte_ct,
+          result.encode_mbs, result.decode_mbs);
+    }
+    free(inputs[i].data);
+  }
+  return ret;
+}
@@ -0,0 +1,202 @@
+/* Tree construction benchmark, old builder vs. new. The old one is kept here
+ * as it was before the two-queue merge replaced it: nodes sorted by an AVL
+ * BST_t keyed on frequency, with ties broken by memcmp'ing the data units
+ * under each node, which every merge mallocs and concatenates a copy of.
+ * Both get timed from the same byte histogram to a finished tree and back
+ * (the new one's time includes fitting the tree to a GBA table, as that's
+ * part of Huff_Tree_Create_From_Histogram), and both trees' encoded bit
+ * counts get checked against each other, as any two Huffman trees for the
+ * same histogram cost the same, however ties get broken.
+ * With no files given, it runs on the random synthetic input from
+ * bench_input.h and a fixed Zipf histogram, both of which use all 256 byte
+ * values, so the old builder's concatenations are as long as they get.
+ * Usage: huff_tree_bench.elf [-i <iterations>] [file]... */
+#include "bench_input.h"
+#include "binary_tree.h"
+#include "huff_histogram.h"
+#include "huffman.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/// Each iteration builds this many trees, as one takes microseconds
+#define BUILDS_PER_ITER 1000
+/// Random only, as it's the only synthetic input with all 256 byte values
+#define SYNTH_CT BENCH_SYNTH_SKEWED
+
+typedef struct s_old_node {
+  byte *data;  /// Every data unit under the node, concatenated
+  int dlen;
+  int height;
+  int freq;
+  struct s_old_node *l, *r;
+} OldNode_t;
+
+static int old_node_cmp(const void *a, const void *b) {
+  const OldNode_t *t1 = a, *t2 = b;
+  int diff = t1->freq - t2->freq;
+  if (diff)
+    return diff;
+  diff = t1->dlen - t2->dlen;
+  return memcmp(t1->data, t2->data, 0 > diff ? t1->dlen : t2->dlen);
+}
+
+static OldNode_t *old_node_create_leaf(int data, int freq) {
+  OldNode_t *ret = calloc(1, sizeof(*ret));
+  if (!ret)
+    return NULL;
+  if (NULL == (ret->data = calloc(2, sizeof(*ret->data)))) {
+    free(ret);
+    return NULL;
+  }
+  ret->data[0] = data;
+  ret->dlen = 1;
+  ret->freq = freq;
+  return ret;
+}
+
+static OldNode_t *old_node_create_subroot(OldNode_t *l, OldNode_t *r) {
+  OldNode_t *ret = malloc(sizeof(*ret));
+  if (!ret)
+    return NULL;
+  ret->l = l;
+  ret->r = r;
+  ret->height = (l->height > r->height ? l->height : r->height) + 1;
+  ret->dlen = l->dlen + r->dlen;
+  if (NULL == (ret->data = malloc(ret->dlen + 1))) {
+    free(ret);
+    return NULL;
+  }
+  memcpy(ret->data, l->data, l->dlen);
+  memcpy(&ret->data[l->dlen], r->data, r->dlen);
+  ret->data[ret->dlen] = '\0';
+  ret->freq = l->freq + r->freq;
+  return ret;
+}
+
+/* Recursive rather than the old fixed stack of 1<<(height+1) entries, which
+ * a 256-leaf tree can be far too tall for. */
+static void old_node_dealloc(void *vp) {
+  OldNode_t *node = vp;
+  if (!node)
+    return;
+  old_node_dealloc(node->l);
+  old_node_dealloc(node->r);
+  free(node->data);
+  free(node);
+}
+
+static uint64_t old_node_bit_ct(const OldNode_t *node, int depth) {
+  if (!node->l)
+    return (uint64_t)node->freq*depth;
+  return old_node_bit_ct(node->l, depth + 1)
+    + old_node_bit_ct(node->r, depth + 1);
+}
+
+/// @return The tree's root, or NULL if freq has < 2 values or on OOM.
+static OldNode_t *old_tree_create(const int freq[256]) {
+  BST_t *queue = BST_Init(old_node_cmp, NULL, old_node_dealloc, 0);
+  OldNode_t *node, *l, *r;
+  for (int i = 0; i < 256; ++i) {
+    if (!freq[i])
+      continue;
+    if (NULL == (node = old_node_create_leaf(i, freq[i]))) {
+      BST_Close(queue);
+      return NULL;
+    }
+    BST_Add(queue, node);
+  }
+  if (BST_Element_Count(queue) < 2) {
+    BST_Close(queue);
+    return NULL;
+  }
+  do {
+    l = BST_Remove_Minimum(queue);
+    r = BST_Remove_Minimum(queue);
+    if (NULL == (node = old_node_create_subroot(l, r))) {
+      old_node_dealloc(l);
+      old_node_dealloc(r);
+      BST_Close(queue);
+      return NULL;
+    }
+    BST_Add(queue, node);
+  } while (BST_Element_Count(queue) > 1);
+  node = BST_Remove_Minimum(queue);
+  BST_Close(queue);
+  return node;
+}
+
+/// @return 0 on success, -1 on failure (already reported).
+static int bench_tree(const char *name, const int freq[256], int iter_ct) {
+  const int build_ct = iter_ct*BUILDS_PER_ITER;
+  uint64_t old_bit_ct = 0, new_bit_ct = 0;
+  double start, old_us, new_us;
+  int symbol_ct = 0;
+  for (int i = 0; i < 256; ++i)
+    symbol_ct += !!freq[i];
+
+  start = bench_now();
+  for (int i = 0; i < build_ct; ++i) {
+    OldNode_t *root = old_tree_create(freq);
+    if (!root) {
+      fprintf(stderr, "%s: Old builder failed.\n", name);
+      return -1;
+    }
+    old_bit_ct = old_node_bit_ct(root, 0);
+    old_node_dealloc(root);
+  }
+  old_us = (bench_now() - start)/build_ct*1e6;
+
+  start = bench_now();
+  for (int i = 0; i < build_ct; ++i) {
+    HuffTree_t *tree = Huff_Tree_Create_From_Histogram(freq,
+        E_DATA_UNIT_8_BITS);
+    if (!tree) {
+      fprintf(stderr, "%s: Failed to create tree: %s\n", name,
+          Huff_Strerror());
+      return -1;
+    }
+    new_bit_ct = tree->unconstrained_bit_ct;
+    Huff_Tree_Destroy(tree);
+  }
+  new_us = (bench_now() - start)/build_ct*1e6;
+
+  if (old_bit_ct != new_bit_ct) {
+    fprintf(stderr, "%s: Old tree encodes to %llu bits, new one to %llu.\n",
+        name, (unsigned long long)old_bit_ct,
+        (unsigned long long)new_bit_ct);
+    return -1;
+  }
+  printf("%-24s %7d %10.2f us %10.2f us %7.1fx\n", name, symbol_ct, old_us,
+      new_us, old_us/new_us);
+  return 0;
+}
+
+int main(int argc, char *argv[]) {
+  BenchInput_t inputs[argc+SYNTH_CT];
+  int freq[256];
+  int input_ct, iter_ct, ret = 0;
+  _Bool synthetic;
+  if (0 > (input_ct = bench_parse_args(argc, argv, inputs, &iter_ct,
+          SYNTH_CT)))
+    return 1;
+  synthetic = inputs[0].name == bench_synth_names[BENCH_SYNTH_RANDOM];
+
+  printf("%-24s %7s %13s %13s %8s\n", "input", "symbols", "old", "new",
+      "speedup");
+  for (int i = 0; i < input_ct; ++i) {
+    memset(freq, 0, sizeof(freq));
+    Huff_Histogram_Add(freq, inputs[i].data, inputs[i].byte_ct,
+        E_DATA_UNIT_8_BITS);
+    if (0 > bench_tree(inputs[i].name, freq, iter_ct))
+      ret = 1;
+    free(inputs[i].data);
+  }
+  if (synthetic) {
+    for (int i = 0; i < 256; ++i)
+      freq[i] = 0x100000/(i + 1);
+    if (0 > bench_tree("[zipf 256 symbols]", freq, iter_ct))
+      ret = 1;
+  }
+  return ret;
+}
@@ -0,0 +1,110 @@
+/* Throughput benchmark for --verify. For each input, at both bit depths,
+ * times encoding it (tree build and compression, as a run without --verify
+ * does) and decoding the result with the host-side SVC 0x13 decoder (what
+ * --verify adds). Reports MB/s of input for each, and how much longer
+ * --verify makes the encode. Every decode gets checked against its input,
+ * so a broken decoder can't post a fast time.
+ * With no files given, it runs on the two synthetic inputs from
+ * bench_input.h.
+ * Usage: huff_verify_bench.elf [-i <iterations>] [file]... */
+#include "bench_input.h"
+#include "huff_decode.h"
+#include "huffman.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/// Random and skewed, as the Fibonacci word is there for LZ77
+#define SYNTH_CT BENCH_SYNTH_FIBONACCI
+
+typedef struct s_verify_bench_result {
+  double encode_mbs, decode_mbs;
+} VerifyBenchResult_t;
+
+/// @return 0 on success, -1 on failure (already reported).
+static int bench_verify(const BenchInput_t *in, DataSize_e bitdepth,
+    int iter_ct, VerifyBenchResult_t *dst) {
+  const int word_ct = in->byte_ct/4;
+  HuffTree_t *tree = NULL;
+  HuffNode_GBA_t *table = NULL;
+  HuffHeader_GBA_t header;
+  uint32_t *compdata = NULL;
+  byte *decoded = malloc(in->byte_ct);
+  double start;
+  int complen, table_size, ret = -1;
+  if (!decoded) {
+    fprintf(stderr, "%s: Failed to allocate decode buffer.\n", in->name);
+    return -1;
+  }
+
+  start = bench_now();
+  for (int i = 0; i < iter_ct; ++i) {
+    Huff_Tree_Destroy(tree);
+    free(compdata);
+    compdata = NULL;
+    if (NULL == (tree = Huff_Tree_Create(in->data, word_ct, bitdepth))
+        || NULL == (compdata = Huff_Compress(in->data, tree, word_ct,
+            &complen))) {
+      fprintf(stderr, "%s: Failed to compress: %s\n", in->name,
+          Huff_Strerror());
+      goto CLEANUP;
+    }
+  }
+  dst->encode_mbs = (double)in->byte_ct*iter_ct/(bench_now() - start)/1e6;
+
+  if (0 > Huff_GBA_Header_Init(&header, in->byte_ct, bitdepth)
+      || NULL == (table = Huff_GBA_Huff_Table_Create(tree, &table_size))) {
+    fprintf(stderr, "%s: Failed to create GBA header and table: %s\n",
+        in->name, Huff_Strerror());
+    goto CLEANUP;
+  }
+  start = bench_now();
+  for (int i = 0; i < iter_ct; ++i) {
+    if (0 > Huff_Decode(header, table, table_size, compdata, complen,
+          decoded)) {
+      fprintf(stderr, "%s: Failed to decode: %s\n", in->name,
+          Huff_Strerror());
+      goto CLEANUP;
+    }
+  }
+  dst->decode_mbs = (double)in->byte_ct*iter_ct/(bench_now() - start)/1e6;
+  if (memcmp(decoded, in->data, in->byte_ct)) {
+    fprintf(stderr, "%s: Decoded output doesn't match the input.\n",
+        in->name);
+    goto CLEANUP;
+  }
+  ret = 0;
+
+CLEANUP:
+  free(table);
+  free(compdata);
+  Huff_Tree_Destroy(tree);
+  free(decoded);
+  return ret;
+}
+
+int main(int argc, char *argv[]) {
+  BenchInput_t inputs[argc+SYNTH_CT];
+  VerifyBenchResult_t result;
+  int input_ct, iter_ct, ret = 0;
+  if (0 > (input_ct = bench_parse_args(argc, argv, inputs, &iter_ct,
+          SYNTH_CT)))
+    return 1;
+
+  printf("%-24s %8s %14s %14s %16s\n", "input", "bitdepth", "encode",
+      "decode", "--verify adds");
+  for (int i = 0; i < input_ct; ++i) {
+    for (DataSize_e bitdepth = E_DATA_UNIT_4_BITS;
+        bitdepth <= E_DATA_UNIT_8_BITS; bitdepth += 4) {
+      if (0 > bench_verify(&inputs[i], bitdepth, iter_ct, &result)) {
+        ret = 1;
+        continue;
+      }
+      printf("%-24s %8d %9.1f MB/s %9.1f MB/s %15.0f%%\n", inputs[i].name,
+          bitdepth, result.encode_mbs, result.decode_mbs,
+          100.0*result.encode_mbs/result.decode_mbs);
+    }
+    free(inputs[i].data);
+  }
+  return ret;
+}
@@ -0,0 +1,27 @@
+#ifndef _BATCH_H_
+#define _BATCH_H_
+
+#include "huff_ctx.h"
+#include <stddef.h>
+
+/**
+ * @summary Run one job. Gets the worker thread's own context, so it can use 
+ * any Huff_Ctx_XYZ(...) function without stepping on the other workers.
+ * @return 0 on success, -1 on failure.
+ * */
+typedef int (*Batch_Job_Cb_t)(HuffCtx_t *ctx, void *job);
+
+/**
+ * @summary Run every job in jobs on a pool of worker threads. Jobs are 
+ * handed out in order, one at a time, to whichever worker frees up first.
+ * @param jobs Array of job_ct jobs, each job_size bytes.
+ * @param thread_ct Worker count. If <= 0, uses the online core count. Never
+ * more than job_ct.
+ * @return Count of jobs that failed.
+ * */
+int Batch_Run(void *jobs, size_t job_size, int job_ct, int thread_ct, 
+    Batch_Job_Cb_t run);
+
+int Batch_Default_Thread_Ct(void);
+
+#endif  /* _BATCH_H_ */
@@ -18,6 +18,16 @@ struct bst_node {
 typedef int (*BST_Cmp_Cb_t)(const void*,const void*);
 typedef void (*BST_Dealloc_Cb_t)(void*);
 typedef void * (*BST_Alloc_Cb_t)(const void*);
+typedef void * (*BST_Node_Alloc_Cb_t)(void *pool, size_t size);
+typedef void (*BST_Node_Dealloc_Cb_t)(void *pool, void *node);
+
+/* Where a BST gets the memory for its nodes from. Must hand back zeroed 
+ * memory. Default (BST_Init) is calloc/free. */
+typedef struct bst_node_allocator {
+  BST_Node_Alloc_Cb_t alloc;
+  BST_Node_Dealloc_Cb_t dealloc;
+  void *pool;  /// Passed back as first arg of alloc and dealloc
+} BST_Node_Allocator_t;
 /** 
  * @param comparison_cb   [REQUIRED] comparison callback data in node.
  * @param data_alloc_cb   [OPTIONAL] custom allocator callback to allocate data for new nodes
@@ -26,6 +36,13 @@ typedef void * (*BST_Alloc_Cb_t)(const void*);
  *                        Otherwise, data added will be a malloc(data_size) ptr with memcpy(node->data, data, data_size) to transfer data from BST_Add.
  **/
 BST_t *BST_Init(BST_Cmp_Cb_t comparison_cb, BST_Alloc_Cb_t data_alloc_cb, BST_Dealloc_Cb_t data_dealloc_cb, size_t data_size);
+/**
+ * @summary Same as BST_Init, but tree nodes come from node_allocator instead
+ * of calloc/free (e.g.: HUFF_ARENA_BST_NODE_ALLOCATOR(arena)).
+ * @param node_allocator [OPTIONAL] If NULL, identical to BST_Init. Copied, so
+ * it doesn't need to outlive this call, but its pool does need to outlive the tree.
+ **/
+BST_t *BST_Init_With_Allocator(BST_Cmp_Cb_t comparison_cb, BST_Alloc_Cb_t data_alloc_cb, BST_Dealloc_Cb_t data_dealloc_cb, size_t data_size, const BST_Node_Allocator_t *node_allocator);
 void BST_Add(BST_t *tree, void *data);
 void BST_Remove(BST_t *tree, void *data);
 void *BST_Remove_Minimum(BST_t *tree);
@@ -0,0 +1,47 @@
+#ifndef _ELFWRITER_H_
+#define _ELFWRITER_H_
+
+#include <stdint.h>
+#include <stdio.h>
+
+/* Minimal ELF32 relocatable object writer for the GBA: an ARM EABI v5 .o
+ * holding one .rodata section, with global object symbols into it. The
+ * compressed data is position-independent, so there's nothing to relocate;
+ * the linker only has to place .rodata and resolve the symbols.
+ * Every size is known up front, so the file gets written front to back,
+ * and can go to a pipe: elf_writer_begin writes the ELF header, .rodata is
+ * then written piecewise, and elf_writer_end writes the symbol and string
+ * tables and the section headers after it. */
+
+#define ELF_WRITER_MAX_SYMBOLS 8
+
+typedef struct s_elf_symbol {
+  const char *name;
+  uint32_t ofs;  /// From the start of .rodata
+  uint32_t size;
+} ElfSymbol_t;
+
+typedef struct s_elf_writer {
+  FILE *fp;
+  uint32_t rodata_ofs;  /// File offset .rodata starts at
+  uint32_t rodata_size;
+  uint32_t rodata_align;
+  uint32_t written;  /// Bytes of .rodata written so far
+  ElfSymbol_t syms[ELF_WRITER_MAX_SYMBOLS];
+  int sym_ct;
+} ElfWriter_t;
+
+/**
+ * @summary Start an object file on fp whose .rodata will be rodata_size
+ * bytes, aligned to rodata_align, with sym_ct symbols into it.
+ * @param syms Copied, but their names MUST stay valid until elf_writer_end.
+ * */
+void elf_writer_begin(ElfWriter_t *dst, FILE *fp, uint32_t rodata_size, uint32_t rodata_align, const ElfSymbol_t *syms, int sym_ct);
+/// Append word_ct words to .rodata, little-endian as the GBA reads them.
+void elf_writer_words(ElfWriter_t *writer, const uint32_t *words, uint32_t word_ct);
+/// Append byte_ct bytes to .rodata as they are.
+void elf_writer_bytes(ElfWriter_t *writer, const void *bytes, uint32_t byte_ct);
+/// Close off the object file, once all of .rodata has been written.
+void elf_writer_end(ElfWriter_t *writer);
+
+#endif  /* _ELFWRITER_H_ */
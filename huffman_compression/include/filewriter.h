@@ -2,10 +2,78 @@
 #define _FILEWRITER_H_
 
 #include "huffman.h"
+#include "huff_gba_cost.h"
+#include "huff_select.h"
+#include "huff_pipeline.h"
+#include "elfwriter.h"
+#include "hex_emit.h"
 #include <stdio.h>
-void write_c_src_file(FILE *fp, const char *exename, const char *infile, const char *output_objname, size_t uncompressed_data_size, uint32_t *compdata, uint32_t comp_word_ct, HuffHeader_GBA_t gba_header, HuffTree_t *hufftree, HuffNode_GBA_t *gba_hufftree, uint32_t gba_table_len, DataSize_e huffcode_bitdepth);
-void write_asm_src_file(FILE *fp, const char *exename, const char *infile, const char *output_objname, size_t uncompressed_data_size, uint32_t *compdata, uint32_t comp_word_ct, HuffHeader_GBA_t gba_header, HuffTree_t *hufftree, HuffNode_GBA_t *gba_hufftree, uint32_t gba_table_len, DataSize_e huffcode_bitdepth);
 
-void write_header_file(FILE *fp, const char *exename, const char *infile, const char *outfile_name, const char *output_objname, size_t uncompressed_data_size, uint32_t comp_word_ct, uint32_t node_ct, uint32_t gba_table_len, DataSize_e huffcode_bitdepth, _Bool src_is_asm);
+/* State for writing a C/ASM source file, or an object file, piecewise: 
+ * *_begin writes everything up to the raw compressed data, then 
+ * write_src_file_words can be called as many times as needed as the 
+ * compressed words become available, and write_src_file_end closes 
+ * everything off. */
+typedef struct s_src_writer {
+  FILE *fp;
+  const char *output_objname;
+  uint32_t word_idx;  /// Count of elements written to the current array/section so far
+  char type;  /// 'c', 's' or 'o', same as the output src type opt
+  ElfWriter_t elf;  /// 'o' only
+  char *sym_names;  /// 'o' only: backs elf's symbol names, freed by write_src_file_end
+  HexEmitter_t emit;  /// 'c' and 's' only: has fp to itself until write_src_file_end
+  FILE *incbin_fp;  /// 's' only: if not NULL, gets the words raw instead (see write_src_file_incbin)
+} SrcWriter_t;
+
+/* Every src and header writer banners the original_data_size of the input 
+ * file itself, and if the data went through stage_ct pipeline stages (see 
+ * huff_pipeline.h) ahead of the codec, first applied first, what each one 
+ * output. */
+void write_c_src_file(FILE *fp, const char *exename, const char *infile, const char *output_objname, size_t original_data_size, const HuffPipelineStageInfo_t *stages, int stage_ct, uint32_t *compdata, uint32_t comp_word_ct, HuffHeader_GBA_t gba_header, HuffTree_t *hufftree, HuffNode_GBA_t *gba_hufftree, uint32_t gba_table_len, DataSize_e huffcode_bitdepth);
+/// With incbin_fp, the raw compressed data goes there instead (see write_src_file_incbin).
+void write_asm_src_file(FILE *fp, const char *exename, const char *infile, const char *output_objname, size_t original_data_size, const HuffPipelineStageInfo_t *stages, int stage_ct, uint32_t *compdata, uint32_t comp_word_ct, HuffHeader_GBA_t gba_header, HuffTree_t *hufftree, HuffNode_GBA_t *gba_hufftree, uint32_t gba_table_len, DataSize_e huffcode_bitdepth, FILE *incbin_fp, const char *incbin_name);
+
+/* Same as the above, but as an ARM ELF relocatable object (see elfwriter.h)
+ * with the same global symbols the ASM src file defines, so there's no 
+ * source for the toolchain to parse at all. */
+void write_obj_file(FILE *fp, const char *output_objname, const uint32_t *compdata, uint32_t comp_word_ct, HuffHeader_GBA_t gba_header, const HuffNode_GBA_t *gba_hufftree, uint32_t gba_table_len);
+
+void write_c_src_file_begin(SrcWriter_t *dst, FILE *fp, const char *exename, const char *infile, const char *output_objname, size_t original_data_size, const HuffPipelineStageInfo_t *stages, int stage_ct, uint32_t comp_word_ct, HuffHeader_GBA_t gba_header, HuffTree_t *hufftree, HuffNode_GBA_t *gba_hufftree, uint32_t gba_table_len, DataSize_e huffcode_bitdepth);
+void write_asm_src_file_begin(SrcWriter_t *dst, FILE *fp, const char *exename, const char *infile, const char *output_objname, size_t original_data_size, const HuffPipelineStageInfo_t *stages, int stage_ct, uint32_t comp_word_ct, HuffHeader_GBA_t gba_header, HuffTree_t *hufftree, HuffNode_GBA_t *gba_hufftree, uint32_t gba_table_len, DataSize_e huffcode_bitdepth);
+void write_obj_file_begin(SrcWriter_t *dst, FILE *fp, const char *output_objname, uint32_t comp_word_ct, HuffHeader_GBA_t gba_header, const HuffNode_GBA_t *gba_hufftree, uint32_t gba_table_len);
+void write_src_file_words(SrcWriter_t *writer, const uint32_t *words, uint32_t word_ct);
+/**
+ * @summary For an ASM src file, right after write_asm_src_file_begin: have 
+ * the assembler pull the words in from incbin_fp with .incbin, and write 
+ * them there raw from then on, instead of as .word lists it has to parse.
+ * @param incbin_name What .incbin opens incbin_fp by.
+ * */
+void write_src_file_incbin(SrcWriter_t *writer, FILE *incbin_fp, const char *incbin_name);
+void write_src_file_end(SrcWriter_t *writer);
+/// Give up on writer partway through, freeing what it holds without closing anything off.
+void write_src_file_abort(SrcWriter_t *writer);
+
+/**
+ * @summary Write a C decoder for output_objname's compressed data that 
+ * probes lut, lut_bits bits at a time (see huff_fast_lut.h), with lut placed 
+ * in lut_section.
+ * @param data_word_ct Word count of output_objname_Huffman_Compression_Data.
+ * */
+void write_fast_decoder_file(FILE *fp, const char *exename, const char *infile, const char *output_objname, const HuffTree_t *hufftree, const uint16_t *lut, int lut_bits, const char *lut_section, uint32_t data_word_ct);
+
+/* Writers for codecs other than Huffman, whose output is already exactly what
+ * the BIOS takes (header word included), so it goes out as one word array, 
+ * <output_objname>_<codec_name>_Compression_Data.
+ * decode_with says which SVC(s) can decompress it. 
+ * Both header writers also take uncompressed_data_size, what the codec's SVC
+ * decompresses the data to, i.e.: the last stage's output, and with -c auto,
+ * the selection that picked the codec (NULL otherwise). The ASM src writer takes incbin_fp the same as 
+ * write_asm_src_file. */
+void write_c_codec_src_file(FILE *fp, const char *exename, const char *infile, const char *output_objname, const char *codec_name, const char *decode_with, size_t original_data_size, const HuffPipelineStageInfo_t *stages, int stage_ct, const uint32_t *compdata, uint32_t comp_word_ct);
+void write_asm_codec_src_file(FILE *fp, const char *exename, const char *infile, const char *output_objname, const char *codec_name, const char *decode_with, size_t original_data_size, const HuffPipelineStageInfo_t *stages, int stage_ct, const uint32_t *compdata, uint32_t comp_word_ct, FILE *incbin_fp, const char *incbin_name);
+void write_obj_codec_file(FILE *fp, const char *output_objname, const char *codec_name, const uint32_t *compdata, uint32_t comp_word_ct);
+void write_codec_header_file(FILE *fp, const char *exename, const char *infile, const char *outfile_name, const char *output_objname, const char *codec_name, const char *decode_with, size_t uncompressed_data_size, size_t original_data_size, uint32_t comp_word_ct, int compression_type, const HuffPipelineStageInfo_t *stages, int stage_ct, const HuffSelectResult_t *selection);
+
+void write_header_file(FILE *fp, const char *exename, const char *infile, const char *outfile_name, const char *output_objname, size_t uncompressed_data_size, size_t original_data_size, uint32_t comp_word_ct, uint32_t node_ct, uint32_t gba_table_len, DataSize_e huffcode_bitdepth, _Bool src_is_asm, const HuffGBADecodeCost_t *decode_cost, int fast_lut_bits, const uint32_t *auto_byte_cts, const HuffPipelineStageInfo_t *stages, int stage_ct, const HuffSelectResult_t *selection);
 
 #endif  /* _FILEWRITER_H_ */
@@ -0,0 +1,41 @@
+#ifndef _HUFF_ARENA_H_
+#define _HUFF_ARENA_H_
+
+#include "binary_tree.h"
+#include <stddef.h>
+
+/* Bump allocator that owns everything allocated from it. Individual 
+ * allocations are never freed; the whole arena is released at once by 
+ * Huff_Arena_Destroy (or recycled by Huff_Arena_Reset). */
+typedef struct s_huff_arena HuffArena_t;
+
+/**
+ * @param block_size [OPTIONAL] Size of each backing block. If 0, uses
+ * HUFF_ARENA_DEFAULT_BLOCK_SIZE, which fits every node of a 256 leaf tree in
+ * a single block.
+ * */
+HuffArena_t *Huff_Arena_Create(size_t block_size);
+void *Huff_Arena_Alloc(HuffArena_t *arena, size_t size);
+void *Huff_Arena_Calloc(HuffArena_t *arena, size_t nmemb, size_t size);
+/**
+ * @summary Forget every allocation made so far, but keep the first backing 
+ * block around so the arena can be refilled without hitting malloc.
+ * */
+void Huff_Arena_Reset(HuffArena_t *arena);
+void Huff_Arena_Destroy(HuffArena_t *arena);
+
+#define HUFF_ARENA_DEFAULT_BLOCK_SIZE (32UL*1024UL)
+
+/* Node allocator hooks that plug an arena into a BST (see 
+ * BST_Init_With_Allocator). Dealloc is a no-op; nodes go away with the 
+ * arena, so the arena MUST outlive the BST. */
+void *Huff_Arena_BST_Node_Alloc_Cb(void *arena, size_t size);
+void Huff_Arena_BST_Node_Dealloc_Cb(void *arena, void *node);
+#define HUFF_ARENA_BST_NODE_ALLOCATOR(arena) \
+  ((BST_Node_Allocator_t) { \
+    .alloc = Huff_Arena_BST_Node_Alloc_Cb, \
+    .dealloc = Huff_Arena_BST_Node_Dealloc_Cb, \
+    .pool = (arena) \
+  })
+
+#endif  /* _HUFF_ARENA_H_ */
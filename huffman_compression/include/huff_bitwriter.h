@@ -0,0 +1,76 @@
+#ifndef _HUFF_BITWRITER_H_
+#define _HUFF_BITWRITER_H_
+
+#include <stdint.h>
+
+/* Packs huffcodes into 32-bit words, MSB-first, which is the bit order the
+ * GBA BIOS Huffman decompression SVC (0x13) reads its bitstream in.
+ * Pending bits sit left-aligned in a 64-bit accumulator, so appending a code
+ * is a single shift+or, and whole words are only written once 32 bits have
+ * piled up. */
+typedef struct s_huff_bitwriter {
+  uint64_t acc;  /// Pending bits, left-aligned (first bit written is bit 63)
+  int acc_len;  /// Count of pending bits in acc. Always < 32 between calls.
+  uint32_t *cursor;  /// Where the next completed word gets stored.
+} HuffBitWriter_t;
+
+static inline void Huff_BitWriter_Init(HuffBitWriter_t *bw, uint32_t *dst) {
+  bw->acc = 0;
+  bw->acc_len = 0;
+  bw->cursor = dst;
+}
+
+/**
+ * @summary Init as if bit_ofs zero bits had already been written to the word
+ * at dst. Lets separately encoded pieces of one bitstream each start mid-word
+ * and be ORed together at their shared boundary words afterward.
+ * @param bit_ofs [0, 31]
+ * */
+static inline void Huff_BitWriter_Init_At(HuffBitWriter_t *bw, uint32_t *dst,
+    int bit_ofs) {
+  bw->acc = 0;
+  bw->acc_len = bit_ofs;
+  bw->cursor = dst;
+}
+
+/**
+ * @param code Huffcode, right-aligned. Bits above codelen MUST be zero.
+ * @param codelen [1, 32]
+ * */
+static inline void Huff_BitWriter_Put32(HuffBitWriter_t *bw, uint32_t code, 
+    int codelen) {
+  bw->acc |= ((uint64_t)code) << (64 - bw->acc_len - codelen);
+  if ((bw->acc_len += codelen) >= 32) {
+    *bw->cursor++ = (uint32_t)(bw->acc>>32);
+    bw->acc <<= 32;
+    bw->acc_len -= 32;
+  }
+}
+
+/**
+ * @param code Huffcode, right-aligned. Bits above codelen MUST be zero.
+ * @param codelen [1, 64]
+ * */
+static inline void Huff_BitWriter_Put(HuffBitWriter_t *bw, uint64_t code, 
+    int codelen) {
+  if (codelen > 32) {
+    Huff_BitWriter_Put32(bw, (uint32_t)(code>>32), codelen-32);
+    codelen = 32;
+  }
+  Huff_BitWriter_Put32(bw, (uint32_t)code, codelen);
+}
+
+/**
+ * @summary Write out any pending bits as a final, zero-padded word.
+ * @return Pointer just past the last word written.
+ * */
+static inline uint32_t *Huff_BitWriter_Flush(HuffBitWriter_t *bw) {
+  if (bw->acc_len) {
+    *bw->cursor++ = (uint32_t)(bw->acc>>32);
+    bw->acc = 0;
+    bw->acc_len = 0;
+  }
+  return bw->cursor;
+}
+
+#endif  /* _HUFF_BITWRITER_H_ */
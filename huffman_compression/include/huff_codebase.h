@@ -1,19 +1,27 @@
 #ifndef _HUFF_CODEBASE_H_
 #define _HUFF_CODEBASE_H_
 
-#include "binary_tree.h"
 #include "huffman.h"
 #include <stdint.h>
 
+#define HUFF_CODEBASE_MAX_ENTRIES 256
+
 typedef struct s_codent {
   uint32_t data;
-  uint32_t codelen;
+  uint32_t codelen;  /// 0 iff data is not present in the tree the codebase was made from
   uint64_t code;  /// 64b for a code is probably overkill, but just in case
 } CodeEntry_t;
 
-typedef BST_t CodeBase_t;  // It's just a BST under the hood. Don't worry about it! 
-                           // Just only call Huff_Codebase_XYZ(...) functions with it.
-                           // Don't call any BST_XYZ(...) functions with it directly.
+/* Flat table, indexed directly by the data unit it encodes, so a lookup is
+ * just one load instead of a walk down a BST. Only the first 
+ * (1<<data_unit_bitlen) entries are ever used (i.e.: 16 for 4-bit codes).
+ * Still, only call Huff_Codebase_XYZ(...) functions with it. */
+typedef struct s_codebase {
+  CodeEntry_t entries[HUFF_CODEBASE_MAX_ENTRIES];
+  DataSize_e data_unit_bitlen;
+  int entry_ct;
+} CodeBase_t;
+
 const char *Huff_Codebase_Strerror(void);
 CodeBase_t *Huff_Codebase_Create(const HuffTree_t *tree);
 CodeEntry_t *Huff_Codebase_Get_Code(CodeBase_t *codebase, uint32_t data);
@@ -0,0 +1,72 @@
+#ifndef _HUFF_CTX_H_
+#define _HUFF_CTX_H_
+
+#include "huffman.h"
+#include "huff_codebase.h"
+#include <stddef.h>
+
+/* Allocator for everything a context hands back to its caller (compressed
+ * data, GBA tables, encoders). Leaving alloc NULL means malloc/free. */
+typedef void *(*Huff_Alloc_Cb_t)(void *pool, size_t size);
+typedef void (*Huff_Dealloc_Cb_t)(void *pool, void *ptr);
+typedef struct s_huff_allocator {
+  Huff_Alloc_Cb_t alloc;
+  Huff_Dealloc_Cb_t dealloc;
+  void *pool;
+} HuffAllocator_t;
+
+/* Everything a compression needs that would otherwise be shared between
+ * calls: error state, allocator, scratch space, and the code table. All of
+ * it is embedded, so a context can live on the stack and needs no teardown
+ * beyond Huff_Ctx_Destroy for ones made by Huff_Ctx_Create.
+ * One context per thread; a context MUST NOT be used by two threads at once.
+ * The context-less functions in huffman.h and huff_codebase.h all run on a
+ * thread-local default context. */
+typedef struct s_huff_ctx {
+  int err;  /// Last error. See Huff_Ctx_Strerror.
+  int codebase_err;  /// Last codebase error. See Huff_Ctx_Codebase_Strerror.
+  HuffAllocator_t allocator;
+  int freq[HUFF_CODEBASE_MAX_ENTRIES];  /// Histogram scratch
+  CodeBase_t codebase;  /// Rebuilt in place by every compression
+} HuffCtx_t;
+
+#define HUFF_CTX_INITIALIZER ((HuffCtx_t) { .err = 0 })
+
+HuffCtx_t *Huff_Ctx_Create(const HuffAllocator_t *allocator);
+void Huff_Ctx_Destroy(HuffCtx_t *ctx);
+/// @return The calling thread's default context.
+HuffCtx_t *Huff_Ctx_Default(void);
+void *Huff_Ctx_Alloc(HuffCtx_t *ctx, size_t size);
+/// Free anything a ctx function returned, other than trees and encoders.
+void Huff_Ctx_Free(HuffCtx_t *ctx, void *ptr);
+
+const char *Huff_Ctx_Strerror(const HuffCtx_t *ctx);
+const char *Huff_Ctx_Codebase_Strerror(const HuffCtx_t *ctx);
+
+HuffTree_t *Huff_Ctx_Tree_Create(HuffCtx_t *ctx, const void *data,
+    int word_ct, DataSize_e edata_unit_bit_len);
+HuffTree_t *Huff_Ctx_Tree_Create_From_Histogram(HuffCtx_t *ctx,
+    const int *freq, DataSize_e edata_unit_bit_len);
+HuffTree_t *Huff_Ctx_Tree_Create_Smallest(HuffCtx_t *ctx, const int *byte_freq,
+    uint32_t return_byte_cts[2]);
+uint32_t *Huff_Ctx_Compress(HuffCtx_t *ctx, const void *data,
+    HuffTree_t *hufftree, int word_ct, int *return_word_ct);
+uint32_t *Huff_Ctx_Compress_Parallel(HuffCtx_t *ctx, const void *data,
+    HuffTree_t *hufftree, int word_ct, int *return_word_ct, int thread_ct);
+HuffEncoder_t *Huff_Ctx_Encoder_Create(HuffCtx_t *ctx, const HuffTree_t *tree,
+    Huff_Word_Sink_Cb_t sink, void *sink_ctx);
+int Huff_Ctx_GBA_Header_Init(HuffCtx_t *ctx, HuffHeader_GBA_t *dst,
+    int decompressed_data_bytelen, DataSize_e data_unit_bitlen);
+HuffNode_GBA_t *Huff_Ctx_GBA_Huff_Table_Create(HuffCtx_t *ctx,
+    const HuffTree_t *tree, int *return_table_size);
+int Huff_Ctx_GBA_Huff_Table_Verify(HuffCtx_t *ctx,
+    const HuffNode_GBA_t *table, int table_size, DataSize_e data_unit_bitlen);
+
+/**
+ * @summary Fill dst with the codes for tree, in place.
+ * @return 0 on success, -1 (see Huff_Ctx_Codebase_Strerror) on failure.
+ * */
+int Huff_Ctx_Codebase_Init(HuffCtx_t *ctx, CodeBase_t *dst,
+    const HuffTree_t *tree);
+
+#endif  /* _HUFF_CTX_H_ */
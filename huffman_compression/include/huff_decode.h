@@ -0,0 +1,60 @@
+#ifndef _HUFF_DECODE_H_
+#define _HUFF_DECODE_H_
+
+#include "huffman.h"
+#include "huff_ctx.h"
+#include <stddef.h>
+#include <stdint.h>
+
+/* Host-side reference decoder for the exact format the GBA BIOS's Huffman
+ * SVC (0x13) takes: header word, tree size byte, node table, then the
+ * MSB-first 32-bit word bitstream. Decodes up to HUFF_DECODE_LUT_BITS bits
+ * per table lookup, only falling back to walking the node table a bit at a
+ * time for codes longer than that.
+ * The node table is walked with the BIOS's own offset math, so a table that
+ * decodes here decodes on hardware. */
+
+#define HUFF_DECODE_LUT_BITS 11
+
+/**
+ * @summary Decode a whole bitstream into dst in one go.
+ * @param dst Room for header.decomp_data_size bytes.
+ * @return 0 on success, -1 (see Huff_Strerror) if the header or table is
+ * bad, or the bitstream runs out before decomp_data_size bytes were decoded.
+ * */
+int Huff_Decode(HuffHeader_GBA_t header, const HuffNode_GBA_t *table,
+    int table_size, const uint32_t *bitstream, int word_ct, void *dst);
+int Huff_Ctx_Decode(HuffCtx_t *ctx, HuffHeader_GBA_t header,
+    const HuffNode_GBA_t *table, int table_size, const uint32_t *bitstream,
+    int word_ct, void *dst);
+/**
+ * @summary Decode a compressed blob laid out exactly as it'd be handed to
+ * the BIOS, i.e.: what the output src files hold.
+ * @param src MUST be word aligned.
+ * @param dst Room for the header's decompressed size in bytes.
+ * @return Decompressed byte count, or -1 (see Huff_Strerror).
+ * */
+long Huff_Decompress(const void *src, size_t src_byte_ct, void *dst);
+long Huff_Ctx_Decompress(HuffCtx_t *ctx, const void *src, size_t src_byte_ct,
+    void *dst);
+
+/* Streaming decoder. Takes the bitstream piecewise, e.g.: straight from a
+ * Huff_Encoder_Create sink, and hands decoded bytes to its own sink in
+ * order, a buffer at a time. The table MUST outlive the decoder. */
+typedef struct s_huff_decoder HuffDecoder_t;
+typedef void (*Huff_Byte_Sink_Cb_t)(const void *bytes, int byte_ct,
+    void *sink_ctx);
+HuffDecoder_t *Huff_Decoder_Create(HuffHeader_GBA_t header,
+    const HuffNode_GBA_t *table, int table_size, Huff_Byte_Sink_Cb_t sink,
+    void *sink_ctx);
+HuffDecoder_t *Huff_Ctx_Decoder_Create(HuffCtx_t *ctx, HuffHeader_GBA_t header,
+    const HuffNode_GBA_t *table, int table_size, Huff_Byte_Sink_Cb_t sink,
+    void *sink_ctx);
+/// Bits past the end of the data in the last word are ignored.
+void Huff_Decoder_Feed(HuffDecoder_t *dec, const uint32_t *words,
+    int word_ct);
+/// @return Total decoded byte count, or -1 (see Huff_Strerror) if the bitstream came up short.
+long Huff_Decoder_Finish(HuffDecoder_t *dec);
+void Huff_Decoder_Destroy(HuffDecoder_t *dec);
+
+#endif  /* _HUFF_DECODE_H_ */
@@ -0,0 +1,43 @@
+#ifndef _HUFF_DIFF_H_
+#define _HUFF_DIFF_H_
+
+#include "huffman.h"
+#include "huff_ctx.h"
+#include <stddef.h>
+#include <stdint.h>
+
+/* The GBA BIOS's difference filter format, as taken by SVC 0x16 (8-bit 
+ * units, written a byte at a time, for WRAM), 0x17 (8-bit units, written a 
+ * halfword at a time, for VRAM) and 0x18 (16-bit units): header word, then 
+ * the first unit as it is, and every unit after it as its difference from 
+ * the one before, wrapping around.
+ * It doesn't compress anything itself. It makes smooth data, e.g.: 
+ * gradients, heightmaps, PCM, cluster around 0, so a compressor run over 
+ * the filtered stream does much better. The BIOS doesn't chain SVCs, so on 
+ * the GBA, the stream gets decompressed into a buffer, then unfiltered. */
+
+/// What the BIOS expects in the header's id field for filtered data
+#define HUFF_DIFF_GBA_COMPRESSION_TYPE_ID 0x08
+/// Bytes the header adds ahead of the filtered data
+#define HUFF_DIFF_HEADER_SIZE 4
+
+/**
+ * @summary Filter data into a BIOS difference filter stream, header included.
+ * @param unit_bitlen 8 or 16. With 16, byte_ct MUST be even.
+ * @param dst Room for byte_ct + HUFF_DIFF_HEADER_SIZE bytes.
+ * @return The stream's byte count, or -1 (see Huff_Strerror).
+ * */
+long Huff_Diff_Filter(const void *data, size_t byte_ct, int unit_bitlen,
+    void *dst);
+long Huff_Ctx_Diff_Filter(HuffCtx_t *ctx, const void *data, size_t byte_ct,
+    int unit_bitlen, void *dst);
+/**
+ * @summary Undo Huff_Diff_Filter the way SVC 0x16-0x18 would.
+ * @param dst Room for the header's size in bytes.
+ * @return Unfiltered byte count, or -1 (see Huff_Strerror).
+ * */
+long Huff_Diff_Unfilter(const void *src, size_t src_byte_ct, void *dst);
+long Huff_Ctx_Diff_Unfilter(HuffCtx_t *ctx, const void *src,
+    size_t src_byte_ct, void *dst);
+
+#endif  /* _HUFF_DIFF_H_ */
@@ -0,0 +1,30 @@
+#ifndef _HUFF_ERRNO_H_
+#define _HUFF_ERRNO_H_
+
+/* Values of HuffCtx_t.err, shared by every source file that reports through
+ * a context. Only ever surfaced to callers as strings, by Huff_Strerror and
+ * Huff_Ctx_Strerror, so this stays out of the public headers. */
+enum e_huffman_errno {
+  HUFF_ERROR_NONE=0,
+  HUFF_ERROR_UNSUPPORTED_FEATURE,
+  HUFF_ERROR_INPUT_TOO_UNIFORM,
+  HUFF_ERROR_INPUT_TOO_SHORT,
+  HUFF_ERROR_SUBROOT_MISSING_DESCENDANT,
+  HUFF_ERROR_FREQ_TREE_MISSING_NODES,
+  HUFF_ERROR_UNEXPECTED_TREE_NODE_CT,
+  HUFF_ERROR_DATA_GIVEN_IS_NULL,
+  HUFF_ERROR_NO_TREE_SUPPLIED,
+  HUFF_ERROR_CODEBASE_ERR,
+  HUFF_ERROR_CODEBASE_MISSING_ENTRY,
+  HUFF_ERROR_NO_HEADER_SUPPLIED,
+  HUFF_ERROR_DATA_NOT_WORD_ALIGNABLE,
+  HUFF_ERROR_GBA_TABLE_ENTRY_OFS_OVERFLOW,
+  HUFF_ERROR_ALLOCATION_FAILED,
+  HUFF_ERROR_DATA_TOO_LARGE,
+  HUFF_ERROR_GBA_TABLE_MALFORMED,
+  HUFF_ERROR_BAD_HEADER,
+  HUFF_ERROR_DATA_TRUNCATED,
+  HUFF_ERROR_BAD_BACKREF,
+};
+
+#endif  /* _HUFF_ERRNO_H_ */
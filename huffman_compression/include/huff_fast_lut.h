@@ -0,0 +1,44 @@
+#ifndef _HUFF_FAST_LUT_H_
+#define _HUFF_FAST_LUT_H_
+
+#include "huffman.h"
+#include "huff_ctx.h"
+#include <stdint.h>
+
+/* Multi-bit lookup tables for decoders faster than the BIOS's, which walks
+ * the tree a bit at a time. Probing with the next lut_bits bits of the
+ * bitstream either decodes a whole code, or skips straight to where a
+ * longer code continues in the BIOS tree table, so the same compressed data
+ * works with both decoders.
+ * Every entry is a halfword: the code's length in the top 4 bits, and the
+ * decoded data unit in the rest. A length of 0 means the code is longer
+ * than lut_bits, and the rest is the table index to walk on from after
+ * consuming all lut_bits bits. */
+
+#define HUFF_FAST_LUT_MIN_BITS 1
+/// Any longer and an entry's length field would be out of room
+#define HUFF_FAST_LUT_MAX_BITS 12
+#define HUFF_FAST_LUT_LEN_SHIFT 12
+#define HUFF_FAST_LUT_PAYLOAD_MASK ((1<<HUFF_FAST_LUT_LEN_SHIFT)-1)
+
+/**
+ * @summary Build a lookup table probing lut_bits bits at a time for a GBA
+ * tree table (see Huff_GBA_Huff_Table_Create).
+ * @return The table's 1<<lut_bits entries, NULL (see Huff_Strerror) on
+ * failure. Free with Huff_Ctx_Free.
+ * */
+uint16_t *Huff_Fast_Lut_Create(const HuffNode_GBA_t *table, int table_size,
+    DataSize_e data_unit_bitlen, int lut_bits);
+uint16_t *Huff_Ctx_Fast_Lut_Create(HuffCtx_t *ctx,
+    const HuffNode_GBA_t *table, int table_size, DataSize_e data_unit_bitlen,
+    int lut_bits);
+/**
+ * @return Average table reads per decoded data unit for the exact data tree
+ * was built from, probing lut_bits bits at a time: one probe, plus, for 
+ * codes longer than lut_bits, one tree table read per bit past those and 
+ * one for the leaf. With lut_bits 0, it's the BIOS's count instead: one 
+ * read per bit, plus the leaf.
+ * */
+double Huff_Fast_Lut_Reads_Per_Unit(const HuffTree_t *tree, int lut_bits);
+
+#endif  /* _HUFF_FAST_LUT_H_ */
@@ -0,0 +1,99 @@
+#ifndef _HUFF_GBA_COST_H_
+#define _HUFF_GBA_COST_H_
+
+#include "huffman.h"
+#include "huff_lz77.h"
+#include "huff_rle.h"
+#include <stdint.h>
+
+/* Estimate of how long the GBA BIOS's Huffman SVC (0x13) takes to decompress
+ * a given tree's data, so assets can be budgeted against load times and
+ * per-frame streaming without running them on hardware.
+ * The BIOS walks the tree a bit at a time, re-reading one table byte from
+ * the source per bit, reads the bitstream a word at a time, and writes the
+ * output a word at a time. The BIOS code itself runs from BIOS ROM, 32-bit
+ * and zero wait-state, so what varies is how many bits get walked (the
+ * tree's depth at each data unit, weighted by frequency, i.e.: bit_ct) and
+ * the wait-states of wherever the source is read from.
+ * The per-step cycle counts below are estimates from the loop's instruction
+ * mix, not measurements, so treat results as ballpark (~10-20%). */
+
+/// CPU clock, in cycles per second
+#define HUFF_GBA_CPU_HZ 16777216
+/// Cycles per frame: 228 scanlines of 1232 cycles each
+#define HUFF_GBA_FRAME_CYCLES 280896
+
+/// ALU and branch cycles per bitstream bit walked, on top of its table read
+#define HUFF_GBA_COST_BIT_CYCLES 10
+/// Cycles per decoded data unit to pack it into the output word and go back to the root
+#define HUFF_GBA_COST_UNIT_CYCLES 10
+/// Cycles per output word stored, assuming the destination is VRAM or IWRAM
+#define HUFF_GBA_COST_OUT_WORD_CYCLES 7
+/// SVC entry and exit, header and tree size byte reads, and loop setup
+#define HUFF_GBA_COST_SETUP_CYCLES 80
+
+/* The other BIOS decompressors read their source a byte at a time and write 
+ * their output a byte at a time (the VRAM variants buffer a halfword, which 
+ * comes out about even), so their cost is counted per unit of their format 
+ * instead. Estimates from each loop's instruction mix, same as above. */
+/// Cycles per LZ77 flag byte, on top of reading it
+#define HUFF_GBA_COST_LZ77_FLAG_CYCLES 6
+/// Cycles per LZ77 literal, on top of reading it
+#define HUFF_GBA_COST_LZ77_LITERAL_CYCLES 8
+/// Cycles to unpack a back-reference's length and displacement, on top of reading it
+#define HUFF_GBA_COST_LZ77_MATCH_CYCLES 14
+/// Cycles per byte a back-reference copies back out of the output
+#define HUFF_GBA_COST_LZ77_COPY_CYCLES 9
+/// Cycles per run-length block's flag byte, on top of reading it
+#define HUFF_GBA_COST_RLE_BLOCK_CYCLES 10
+/// Cycles per byte a run writes
+#define HUFF_GBA_COST_RLE_RUN_BYTE_CYCLES 5
+/// Cycles per literal byte copied through, on top of reading it
+#define HUFF_GBA_COST_RLE_LITERAL_CYCLES 8
+/// Cycles per unit unfiltered, on top of reading it
+#define HUFF_GBA_COST_DIFF_UNIT_CYCLES 9
+
+/// Where the BIOS reads the compressed data (and so the tree table) from
+typedef enum e_huff_gba_region {
+  E_HUFF_GBA_REGION_ROM=0,  /// Cart ROM, WS0 at 3/1 wait-states, as most games set WAITCNT
+  E_HUFF_GBA_REGION_EWRAM,
+  E_HUFF_GBA_REGION_IWRAM,
+  E_HUFF_GBA_REGION_CT
+} HuffGBARegion_e;
+
+typedef struct s_huff_gba_decode_cost {
+  HuffGBARegion_e src_region;
+  uint64_t cycles;  /// Estimated total for the whole SVC call
+  uint64_t read_cycles;  /// How much of cycles is spent reading the source
+  uint64_t bits_walked;  /// Same as the tree's bit_ct
+  int worst_unit_cycles;  /// Cycles to decode one data unit with the longest code
+} HuffGBADecodeCost_t;
+
+/**
+ * @summary Estimate the BIOS's decode cost for the exact data tree was built
+ * from, read out of src_region.
+ * */
+void Huff_GBA_Decode_Cost_Estimate(HuffGBADecodeCost_t *dst,
+    const HuffTree_t *tree, HuffGBARegion_e src_region);
+/**
+ * @summary Estimate SVC 0x11/0x12's decode cost for LZ77 data whose parse 
+ * came out to stats, read out of src_region. bits_walked is left 0.
+ * */
+void Huff_GBA_LZ77_Decode_Cost_Estimate(HuffGBADecodeCost_t *dst,
+    const HuffLZ77Stats_t *stats, HuffGBARegion_e src_region);
+/// Same, for SVC 0x14/0x15 and run-length data segmented into stats.
+void Huff_GBA_RLE_Decode_Cost_Estimate(HuffGBADecodeCost_t *dst,
+    const HuffRLEStats_t *stats, HuffGBARegion_e src_region);
+/**
+ * @summary Same, for SVC 0x16-0x18 unfiltering byte_ct bytes of 
+ * unit_bitlen-bit units, read out of src_region, i.e.: wherever the codec 
+ * ahead of it decompressed them to.
+ * */
+void Huff_GBA_Diff_Decode_Cost_Estimate(HuffGBADecodeCost_t *dst,
+    uint32_t byte_ct, int unit_bitlen, HuffGBARegion_e src_region);
+/// @return Region's lowercase name, e.g.: "rom".
+const char *Huff_GBA_Region_Name(HuffGBARegion_e region);
+/// @return Region named name (case-insensitive), or -1 if there's no such region.
+int Huff_GBA_Region_From_Name(const char *name);
+
+#endif  /* _HUFF_GBA_COST_H_ */
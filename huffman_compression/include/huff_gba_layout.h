@@ -0,0 +1,44 @@
+#ifndef _HUFF_GBA_LAYOUT_H_
+#define _HUFF_GBA_LAYOUT_H_
+
+#include "huffman.h"
+
+/* Where every node of a hufftree goes in a GBA BIOS tree table.
+ * The table is made of 2-entry slots. Slot 0 holds the table size byte and
+ * the root; every other slot holds the two children of one subroot. A
+ * subroot's children MUST land in one of the 64 slots right after the
+ * subroot's own (its 6-bit descendants_ofs), which is the constraint the
+ * planner works around. */
+
+/// Slot count of the largest table: one per subroot of a 256 leaf tree, plus slot 0
+#define HUFF_GBA_LAYOUT_MAX_SLOTS 256
+/// How far past its own slot a subroot's children can be placed
+#define HUFF_GBA_LAYOUT_MAX_SLOT_DIST 64
+/* Slots sharing the compressed data's first 32 bytes with its 4 byte header.
+ * The data is emitted 32-byte aligned, so this is the one span the BIOS 
+ * decoder can read without crossing into another. */
+#define HUFF_GBA_LAYOUT_HOT_SLOT_CT ((32-4)/2)
+
+typedef struct s_huff_gba_layout {
+  /// owners[k] is the subroot whose children fill slot k. owners[0] is unused.
+  const HuffNode_t *owners[HUFF_GBA_LAYOUT_MAX_SLOTS];
+  int slot_ct;  /// Counting slot 0
+} HuffGBALayout_t;
+
+/**
+ * @summary Pick a slot for every subroot's children, such that every
+ * descendants_ofs fits in 6 bits. The hot slots go to the most frequently
+ * visited subroots, i.e.: the ones nearest the root on the common codes' 
+ * paths. Past those, it goes depth-first, smaller subtree first, which keeps
+ * few subroots waiting at once. Either way, whenever holding off any longer
+ * would leave a waiting subroot with nowhere in range to put its children, 
+ * it places whichever one runs out of room soonest. If the tree won't fit
+ * with the hot slots filled first, it's planned again without.
+ * @param node_ct Node count of the tree. Node ids MUST be unique and less
+ * than this.
+ * @return 0 on success, -1 if the planner can't fit the tree.
+ * */
+int Huff_GBA_Layout_Plan(HuffGBALayout_t *dst, const HuffNode_t *root,
+    int node_ct);
+
+#endif  /* _HUFF_GBA_LAYOUT_H_ */
@@ -0,0 +1,51 @@
+#ifndef _HUFF_HISTOGRAM_H_
+#define _HUFF_HISTOGRAM_H_
+
+#include "huffman.h"
+#include <stddef.h>
+#include <stdint.h>
+
+/* Data unit frequency counting, shared by tree construction, exact output 
+ * sizing, and anything else that needs to know what's in the data. 
+ * Every byte is counted into one of several interleaved tables, so runs of 
+ * the same value don't serialize on incrementing the same counter, and 4-bit
+ * histograms are folded out of the byte histogram rather than counted a 
+ * nibble at a time. */
+
+/**
+ * @summary Add the count of every byte value in data to counts.
+ * */
+void Huff_Histogram_Add_Bytes(uint32_t counts[256], const void *data, 
+    size_t byte_ct);
+/**
+ * @summary Add the count of every data unit in data to freq.
+ * @param freq Indexed by data unit value, so it needs 
+ * (1<<data_unit_bitlen) entries.
+ * */
+void Huff_Histogram_Add(int *freq, const void *data, int byte_ct, 
+    DataSize_e data_unit_bitlen);
+/**
+ * @summary Same as Huff_Histogram_Add, but data is split between thread_ct 
+ * threads, each counting into its own sub-histogram, and the 
+ * sub-histograms get merged at the end. Small data is just counted inline.
+ * @param thread_ct If <= 0, uses the online core count.
+ * */
+void Huff_Histogram_Add_Parallel(int *freq, const void *data, int byte_ct, 
+    DataSize_e data_unit_bitlen, int thread_ct);
+/**
+ * @summary Add a byte histogram, as counted by Huff_Histogram_Add_Bytes, to 
+ * the data unit histogram freq, splitting each byte's count between both of
+ * its nibbles for 4-bit units.
+ * @param freq Same as Huff_Histogram_Add's.
+ * */
+void Huff_Histogram_Fold(int *freq, const uint32_t counts[256], 
+    DataSize_e data_unit_bitlen);
+/**
+ * @return Order-0 (Shannon) entropy of the bytes counted, in bits per byte,
+ * i.e.: the fewest bits per byte any coder of single bytes could average.
+ * */
+double Huff_Histogram_Entropy(const uint32_t counts[256]);
+/// dst[i] += src[i] for every one of the unit_ct entries.
+void Huff_Histogram_Merge(int *dst, const int *src, int unit_ct);
+
+#endif  /* _HUFF_HISTOGRAM_H_ */
@@ -0,0 +1,26 @@
+#ifndef _HUFF_INPUT_H_
+#define _HUFF_INPUT_H_
+
+#include <stddef.h>
+
+/* An input file loaded for compression. data always spans padded_byte_ct
+ * bytes, i.e.: the file size rounded up to a word boundary, with the 
+ * padding bytes zeroed, so it can go straight to Huff_Tree_Create and 
+ * Huff_Compress. */
+typedef struct s_huff_input {
+  const void *data;
+  size_t byte_ct;  /// Original file size
+  size_t padded_byte_ct;
+  size_t map_len;  /// Nonzero iff data is an mmap'd view of the file
+} HuffInput_t;
+
+/**
+ * @summary Load a file, mapping it if it's a regular file and map_ok is set,
+ * otherwise (pipes, devices, empty files, or mmap failure) reading it into 
+ * a malloc'd buffer.
+ * @return 0 on success, -1 on failure with errno set.
+ * */
+int Huff_Input_Load(HuffInput_t *dst, const char *path, _Bool map_ok);
+void Huff_Input_Release(HuffInput_t *input);
+
+#endif  /* _HUFF_INPUT_H_ */
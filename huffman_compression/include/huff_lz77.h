@@ -0,0 +1,73 @@
+#ifndef _HUFF_LZ77_H_
+#define _HUFF_LZ77_H_
+
+#include "huffman.h"
+#include "huff_ctx.h"
+#include <stddef.h>
+#include <stdint.h>
+
+/* The GBA BIOS's LZ77 format, as taken by SVC 0x11 (writes a byte at a
+ * time, for WRAM) and SVC 0x12 (writes a halfword at a time, for VRAM):
+ * header word, then blocks of up to 8 units, each block led by a flag byte
+ * whose bits, MSB first, say whether each unit is a literal byte (0) or a
+ * big-endian halfword back-reference (1), (len-3)<<12 | (disp-1), copying
+ * len bytes from disp bytes back in the output.
+ * SVC 0x12 only writes every other byte, so the byte 1 back hasn't landed yet
+ * when a back-reference reads it. VRAM-safe data never references it. */
+
+/// What the BIOS expects in the header's id field for LZ77 data
+#define HUFF_LZ77_GBA_COMPRESSION_TYPE_ID 0x01
+#define HUFF_LZ77_MIN_MATCH 3
+#define HUFF_LZ77_MAX_MATCH 18
+#define HUFF_LZ77_WINDOW_SIZE 4096
+/// Smallest displacement SVC 0x12 can decode
+#define HUFF_LZ77_VRAM_MIN_DISP 2
+
+typedef struct s_huff_lz77_stats {
+  uint32_t literal_ct;
+  uint32_t match_ct;
+  uint32_t matched_byte_ct;  /// Bytes covered by back-references
+} HuffLZ77Stats_t;
+
+/**
+ * @summary Compress data into the BIOS's LZ77 format, header included,
+ * zero-padded to a whole word count.
+ * Every position's longest match within the window is found with hash
+ * chains, then the parse is picked back to front to minimize the output's
+ * size, instead of greedily taking the longest match at each step.
+ * @param vram_safe Never reference the byte 1 back, so SVC 0x12 can decode
+ * the output too.
+ * @param return_stats If not NULL, gets what the parse came out to.
+ * @return The compressed words, or NULL (see Huff_Strerror). Free with
+ * Huff_Ctx_Free.
+ * */
+uint32_t *Huff_LZ77_Compress(const void *data, size_t byte_ct, _Bool vram_safe,
+    int *return_word_ct, HuffLZ77Stats_t *return_stats);
+uint32_t *Huff_Ctx_LZ77_Compress(HuffCtx_t *ctx, const void *data,
+    size_t byte_ct, _Bool vram_safe, int *return_word_ct,
+    HuffLZ77Stats_t *return_stats);
+/**
+ * @summary Lower bound on Huff_LZ77_Compress's output size, from one pass 
+ * over data without looking for any matches: a byte no 3-byte sequence 
+ * within the window could start a back-reference covering can only be a 
+ * literal, and every other byte costs at least its share of the longest 
+ * back-reference.
+ * @return The bound in bytes, header and padding included, or -1 (see 
+ * Huff_Strerror).
+ * */
+long Huff_LZ77_Size_Bound(const void *data, size_t byte_ct);
+long Huff_Ctx_LZ77_Size_Bound(HuffCtx_t *ctx, const void *data, 
+    size_t byte_ct);
+/**
+ * @summary Decompress BIOS LZ77 data the way SVC 0x11 would, or with vram,
+ * the way SVC 0x12 would, i.e.: failing on back-references to the byte 1
+ * back.
+ * @param dst Room for the header's decompressed size in bytes.
+ * @return Decompressed byte count, or -1 (see Huff_Strerror).
+ * */
+long Huff_LZ77_Decompress(const void *src, size_t src_byte_ct, void *dst,
+    _Bool vram);
+long Huff_Ctx_LZ77_Decompress(HuffCtx_t *ctx, const void *src,
+    size_t src_byte_ct, void *dst, _Bool vram);
+
+#endif  /* _HUFF_LZ77_H_ */
@@ -0,0 +1,82 @@
+#ifndef _HUFF_PIPELINE_H_
+#define _HUFF_PIPELINE_H_
+
+#include "huffman.h"
+#include "huff_ctx.h"
+#include "huff_gba_cost.h"
+#include <stddef.h>
+#include <stdint.h>
+
+/* Chains of BIOS formats, e.g.: diff16 -> LZ77 -> Huffman, each stage
+ * compressing the whole output of the one before it, header included, in
+ * memory. The BIOS doesn't chain SVCs, so on the GBA it goes the other way
+ * around, one SVC per stage, last stage first: each one decompresses into a
+ * staging buffer the next one reads from, until the first stage's SVC
+ * writes the original data. Two staging buffers, used in turn, are all any
+ * chain needs, so a game can allocate them once up front. */
+
+typedef enum e_huff_stage {
+  E_HUFF_STAGE_DIFF8=0,
+  E_HUFF_STAGE_DIFF16,
+  E_HUFF_STAGE_LZ77,
+  E_HUFF_STAGE_LZ77_VRAM,  /// LZ77 that SVC 0x12 can decode too (see Huff_LZ77_Compress)
+  E_HUFF_STAGE_RLE,
+  E_HUFF_STAGE_HUFF4,
+  E_HUFF_STAGE_HUFF8,
+  E_HUFF_STAGE_CT
+} HuffStage_e;
+
+#define HUFF_PIPELINE_MAX_STAGES 4
+
+typedef struct s_huff_pipeline_stage_info {
+  HuffStage_e stage;
+  uint32_t in_byte_ct;  /// What the stage compressed, i.e.: what its SVC decompresses back to
+  uint32_t out_byte_ct;  /// Its output, header and padding included
+  uint64_t decode_cycles;  /// Estimated time its SVC takes (see huff_gba_cost.h)
+} HuffPipelineStageInfo_t;
+
+/**
+ * @summary Run data through stage_ct stages in order, each compressing the
+ * word-padded output of the one before it.
+ * @param src_region Where the GBA reads the last stage's output from, for
+ * its decode_cycles. Every other stage gets read from a staging buffer in
+ * EWRAM.
+ * @param return_info If not NULL, gets stage_ct entries, one per stage.
+ * @return The last stage's output, zero-padded to a whole word count, or
+ * NULL (see Huff_Strerror). Free with Huff_Ctx_Free.
+ * */
+uint32_t *Huff_Pipeline_Compress(const void *data, size_t byte_ct,
+    const HuffStage_e *stages, int stage_ct, HuffGBARegion_e src_region,
+    int *return_word_ct, HuffPipelineStageInfo_t *return_info);
+uint32_t *Huff_Ctx_Pipeline_Compress(HuffCtx_t *ctx, const void *data,
+    size_t byte_ct, const HuffStage_e *stages, int stage_ct,
+    HuffGBARegion_e src_region, int *return_word_ct,
+    HuffPipelineStageInfo_t *return_info);
+/**
+ * @summary Undo Huff_Pipeline_Compress the way the GBA would, one SVC per
+ * stage, last stage first, sizing each staging buffer by the header it
+ * decompresses.
+ * @param dst Room for the first stage's in_byte_ct.
+ * @return Decompressed byte count, or -1 (see Huff_Strerror).
+ * */
+long Huff_Pipeline_Decompress(const void *src, size_t src_byte_ct,
+    const HuffStage_e *stages, int stage_ct, void *dst);
+long Huff_Ctx_Pipeline_Decompress(HuffCtx_t *ctx, const void *src,
+    size_t src_byte_ct, const HuffStage_e *stages, int stage_ct, void *dst);
+/**
+ * @summary Size the two staging buffers decoding stages' output takes, as
+ * reported by Huff_Pipeline_Compress. The last stage's SVC decompresses
+ * into buffer 0, the one before it into buffer 1, then 0 again, and so on,
+ * and the first stage's SVC into the caller's own buffer.
+ * @param dst Gets 0 for a buffer a chain that short never uses.
+ * */
+void Huff_Pipeline_Staging_Sizes(const HuffPipelineStageInfo_t *info,
+    int stage_ct, uint32_t dst[2]);
+/// @return stage's lowercase name, e.g.: "diff16".
+const char *Huff_Stage_Name(HuffStage_e stage);
+/// @return The BIOS compression type in the header stage writes, e.g.: 0x1 for LZ77.
+int Huff_Stage_Compression_Type(HuffStage_e stage);
+/// @return The SVC(s) that decode stage's output, e.g.: "SVC 0x11/0x12".
+const char *Huff_Stage_SVC_Name(HuffStage_e stage);
+
+#endif  /* _HUFF_PIPELINE_H_ */
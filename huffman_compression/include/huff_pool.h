@@ -0,0 +1,43 @@
+#ifndef _HUFF_POOL_H_
+#define _HUFF_POOL_H_
+
+#include "huff_ctx.h"
+#include <stddef.h>
+
+/* Allocator that holds on to blocks freed back to it, and hands them out
+ * again to anything that fits, for a long-running process (e.g.: --watch)
+ * that compresses the same inputs over and over. After the first job, its
+ * output buffers and tables come back warm instead of going through malloc
+ * (and, for big ones, a fresh mmap to page fault in). Blocks get some
+ * headroom, so an input that grows a little between edits still fits.
+ * Plug one into a context with HUFF_POOL_ALLOCATOR. Like the context it's
+ * plugged into, a pool MUST NOT be used by two threads at once. */
+typedef struct s_huff_pool HuffPool_t;
+
+/**
+ * @param max_cached_bytes Most it holds on to at once. If 0, uses
+ * HUFF_POOL_DEFAULT_MAX_CACHED_BYTES.
+ * */
+HuffPool_t *Huff_Pool_Create(size_t max_cached_bytes);
+/**
+ * @summary Free every block the pool's holding on to. Blocks still handed
+ * out have to be freed back to it first.
+ * */
+void Huff_Pool_Destroy(HuffPool_t *pool);
+/// How many allocations were handed a held block, and how many hit malloc.
+void Huff_Pool_Counts(const HuffPool_t *pool, unsigned *reused_ct,
+    unsigned *malloced_ct);
+
+#define HUFF_POOL_DEFAULT_MAX_CACHED_BYTES (64UL*1024UL*1024UL)
+#define HUFF_POOL_MAX_BLOCKS 16
+
+void *Huff_Pool_Alloc_Cb(void *pool, size_t size);
+void Huff_Pool_Dealloc_Cb(void *pool, void *ptr);
+#define HUFF_POOL_ALLOCATOR(pool) \
+  ((HuffAllocator_t) { \
+    .alloc = Huff_Pool_Alloc_Cb, \
+    .dealloc = Huff_Pool_Dealloc_Cb, \
+    .pool = (pool) \
+  })
+
+#endif  /* _HUFF_POOL_H_ */
@@ -0,0 +1,58 @@
+#ifndef _HUFF_RLE_H_
+#define _HUFF_RLE_H_
+
+#include "huffman.h"
+#include "huff_ctx.h"
+#include <stddef.h>
+#include <stdint.h>
+
+/* The GBA BIOS's run-length format, as taken by SVC 0x14 (writes a byte at
+ * a time, for WRAM) and SVC 0x15 (writes a halfword at a time, for VRAM),
+ * which both decode the same data: header word, then blocks, each led by a
+ * flag byte. Flag bit 7 set means a run, (flag&0x7F)+3 copies of the one
+ * byte after it; clear means (flag&0x7F)+1 bytes copied as they are. */
+
+/// What the BIOS expects in the header's id field for run-length data
+#define HUFF_RLE_GBA_COMPRESSION_TYPE_ID 0x03
+#define HUFF_RLE_MIN_RUN 3
+#define HUFF_RLE_MAX_RUN 130
+#define HUFF_RLE_MAX_LITERALS 128
+
+typedef struct s_huff_rle_stats {
+  uint32_t run_ct;
+  uint32_t run_byte_ct;  /// Bytes covered by runs
+  uint32_t literal_block_ct;
+  uint32_t literal_byte_ct;
+} HuffRLEStats_t;
+
+/**
+ * @summary Compress data into the BIOS's run-length format, header
+ * included, zero-padded to a whole word count.
+ * Runs and literal blocks are segmented to minimize the output's size, e.g.:
+ * a run of 3 between literals costs more as its own block than it saves, so
+ * it stays in the literal block around it.
+ * @param return_stats If not NULL, gets what the segmentation came out to.
+ * @return The compressed words, or NULL (see Huff_Strerror). Free with
+ * Huff_Ctx_Free.
+ * */
+uint32_t *Huff_RLE_Compress(const void *data, size_t byte_ct,
+    int *return_word_ct, HuffRLEStats_t *return_stats);
+uint32_t *Huff_Ctx_RLE_Compress(HuffCtx_t *ctx, const void *data,
+    size_t byte_ct, int *return_word_ct, HuffRLEStats_t *return_stats);
+/**
+ * @summary Lower bound on Huff_RLE_Compress's output size, from one pass 
+ * over data: bytes outside any run of 3 or more can only be literals, and 
+ * every other byte costs at least its share of the longest run.
+ * @return The bound in bytes, header and padding included.
+ * */
+uint32_t Huff_RLE_Size_Bound(const void *data, size_t byte_ct);
+/**
+ * @summary Decompress BIOS run-length data the way SVC 0x14 and 0x15 would.
+ * @param dst Room for the header's decompressed size in bytes.
+ * @return Decompressed byte count, or -1 (see Huff_Strerror).
+ * */
+long Huff_RLE_Decompress(const void *src, size_t src_byte_ct, void *dst);
+long Huff_Ctx_RLE_Decompress(HuffCtx_t *ctx, const void *src,
+    size_t src_byte_ct, void *dst);
+
+#endif  /* _HUFF_RLE_H_ */
@@ -0,0 +1,82 @@
+#ifndef _HUFF_SELECT_H_
+#define _HUFF_SELECT_H_
+
+#include "huffman.h"
+#include "huff_ctx.h"
+#include "huff_gba_cost.h"
+#include <stddef.h>
+#include <stdint.h>
+
+/* Codec auto-selection: every codec the BIOS decompresses, each on the data
+ * as it is and on its difference filter streams, to find whichever comes
+ * out smallest, optionally weighed against how long it takes to decompress.
+ * Huffman sizes come exactly from the histograms, without compressing
+ * anything. Every other candidate gets a lower bound on its size from one
+ * cheap pass, and they're compressed on a pool of threads, smallest bound
+ * first, skipping any whose bound is already worse than the best found. */
+
+typedef enum e_huff_codec {
+  E_HUFF_CODEC_HUFF4=0,
+  E_HUFF_CODEC_HUFF8,
+  E_HUFF_CODEC_LZ77,
+  E_HUFF_CODEC_RLE,
+  E_HUFF_CODEC_CT
+} HuffCodec_e;
+
+/// Filters every codec gets tried behind, as bits of HuffSelectOpts_t.filter_mask
+#define HUFF_SELECT_FILTER_NONE   (1<<0)
+#define HUFF_SELECT_FILTER_DIFF8  (1<<1)
+#define HUFF_SELECT_FILTER_DIFF16 (1<<2)
+#define HUFF_SELECT_FILTER_ALL    (HUFF_SELECT_FILTER_NONE|HUFF_SELECT_FILTER_DIFF8|HUFF_SELECT_FILTER_DIFF16)
+#define HUFF_SELECT_FILTER_CT 3
+#define HUFF_SELECT_CANDIDATE_CT (E_HUFF_CODEC_CT*HUFF_SELECT_FILTER_CT)
+
+typedef struct s_huff_select_opts {
+  HuffGBARegion_e src_region;  /// Where the GBA reads the compressed data from
+  double frame_weight;  /// Output bytes one frame of decode time is worth. 0 picks on size alone
+  int filter_mask;  /// HUFF_SELECT_FILTER_XYZ bits. 0 means HUFF_SELECT_FILTER_ALL
+  int thread_ct;  /// If <= 0, uses the online core count
+  _Bool vram_safe;  /// Keep LZ77 decodable by SVC 0x12
+} HuffSelectOpts_t;
+
+typedef enum e_huff_select_status {
+  E_HUFF_SELECT_MEASURED=0,  /// byte_ct and decode_cycles are exact
+  E_HUFF_SELECT_PRUNED,  /// Its bound was worse than the best, so it wasn't compressed
+  E_HUFF_SELECT_FAILED  /// Its codec can't compress this data, e.g.: Huffman on a single byte value
+} HuffSelectStatus_e;
+
+typedef struct s_huff_select_candidate {
+  HuffCodec_e codec;
+  int diff_unit_bitlen;  /// 8 or 16 if the codec compresses a difference filter stream, 0 if not
+  HuffSelectStatus_e status;
+  uint32_t bound;  /// Lower bound on byte_ct
+  uint32_t byte_ct;  /// Output size, header and padding included
+  uint64_t decode_cycles;  /// Estimated BIOS decode time, unfiltering included
+  double score;  /// byte_ct plus decode time at the frame weight. Lowest wins
+} HuffSelectCandidate_t;
+
+typedef struct s_huff_select_result {
+  HuffSelectCandidate_t candidates[HUFF_SELECT_CANDIDATE_CT];
+  int candidate_ct;
+  int winner;  /// Index of the winning candidate
+  double frame_weight;
+} HuffSelectResult_t;
+
+/**
+ * @summary Find which codec and filter compress data best.
+ * @param opts NULL for the defaults: every filter, read from ROM, picked on
+ * size alone, on every core.
+ * @return 0 on success, -1 (see Huff_Strerror) if no candidate could
+ * compress data at all.
+ * */
+int Huff_Select_Codec(const void *data, size_t byte_ct,
+    const HuffSelectOpts_t *opts, HuffSelectResult_t *dst);
+int Huff_Ctx_Select_Codec(HuffCtx_t *ctx, const void *data, size_t byte_ct,
+    const HuffSelectOpts_t *opts, HuffSelectResult_t *dst);
+/// @return codec's lowercase name, e.g.: "lz77".
+const char *Huff_Codec_Name(HuffCodec_e codec);
+/// Write cand's name into dst, its filter first if it has one, e.g.: "diff16 -> lz77".
+void Huff_Select_Candidate_Name(char *dst, size_t dst_size,
+    const HuffSelectCandidate_t *cand);
+
+#endif  /* _HUFF_SELECT_H_ */
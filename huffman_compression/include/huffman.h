@@ -13,8 +13,8 @@ typedef enum e_data_size {
 } __attribute__ ((aligned(4))) DataSize_e;
 
 typedef struct s_htnode {
-  byte *data;  /// Should be null-terminated field.
-  int dlen;
+  int data;  /// Data unit encoded by this node if it's a leaf. -1 for subroots.
+  int id;  /// Unique, deterministic tie-break id assigned during tree construction
   int height;
   int freq;
   struct s_htnode *l, *r;  /// l corresponds to 0 and r to 1
@@ -25,6 +25,11 @@ typedef struct s_ht {
   int node_ct;
   int leaf_ct;
   DataSize_e data_unit_bitlen;
+  uint64_t bit_ct;  /// Encoded bit length of the data the tree was built from
+  /* What bit_ct would have been if the tree didn't have to fit a GBA tree 
+   * table (see Huff_Tree_Create_From_Histogram). */
+  uint64_t unconstrained_bit_ct;
+  struct s_huff_arena *arena;  /// Owns the tree and all of its nodes
 } HuffTree_t;
 
 typedef struct s_hsr_gba {
@@ -48,21 +53,92 @@ typedef struct s_hhdr_gba {
 #define HUFF_NODE_IS_LEAF(node) ((node->l==NULL) && (node->r==NULL))
 #define HUFF_NODE_HEIGHT(node) (node ? node->height : -1)
 
+/// Largest decompressed size the GBA header's 24-bit size field can hold
+#define HUFF_GBA_MAX_DECOMP_SIZE 0xFFFFFF
+/// What the BIOS expects in the header's id field for Huffman data
+#define HUFF_HEADER_GBA_COMPRESSION_TYPE_ID 0x02
+
+/* Everything below runs on the calling thread's default context (see 
+ * huff_ctx.h), which is also where Huff_Strerror gets its error from. Use the
+ * Huff_Ctx_XYZ(...) versions to keep separate error state and scratch per 
+ * caller. */
 const char *Huff_Strerror(void);
-void Huff_Node_Dealloc(HuffNode_t *node);
 /**
  * @summary Create huff tree. Data on GBA gets decompressed in 32-byte chunks, so
  * make sure the data passed to this function has a byte count that's divisible by 4,
  * hence why param 2 is word_ct and not byte_ct.
  * */
 HuffTree_t *Huff_Tree_Create(const void *data, int word_ct, DataSize_e edata_unit_bit_len);
+/**
+ * @summary Create huff tree from a histogram (see huff_histogram.h), 
+ * e.g.: when the data is too big to hold in memory all at once.
+ * Every tree made is guaranteed to fit a GBA BIOS tree table. When the plain
+ * Huffman tree doesn't, its codes get length-limited until one does, at the
+ * least cost possible, which the tree's bit_ct vs unconstrained_bit_ct shows.
+ * */
+HuffTree_t *Huff_Tree_Create_From_Histogram(const int *freq, 
+    DataSize_e edata_unit_bit_len);
 void Huff_Tree_Destroy(HuffTree_t *tree);
+/**
+ * @return Word count of the compressed bitstream for the exact data the tree
+ * was built from. Lets callers size outputs before compressing anything.
+ * */
+uint32_t Huff_Tree_Encoded_Word_Ct(const HuffTree_t *tree);
+/**
+ * @return Byte count of everything the BIOS gets handed for the exact data 
+ * the tree was built from: header, tree table, and bitstream, padding 
+ * included. Exact, without compressing anything.
+ * */
+uint32_t Huff_Tree_GBA_Byte_Ct(const HuffTree_t *tree);
+/**
+ * @summary Create both a 4 and an 8-bit hufftree from a byte histogram, and
+ * keep whichever compresses the data smaller by Huff_Tree_GBA_Byte_Ct. If
+ * only one of them can be made, that one's kept.
+ * @param byte_freq 8-bit histogram (see huff_histogram.h).
+ * @param return_byte_cts If not NULL, gets the predicted size of each, 4-bit
+ * first. 0 for one that couldn't be made.
+ * */
+HuffTree_t *Huff_Tree_Create_Smallest(const int *byte_freq, 
+    uint32_t return_byte_cts[2]);
 uint32_t *Huff_Compress(const void *data, HuffTree_t *hufftree, int word_ct, int *return_word_ct);
+/**
+ * @summary Same output as Huff_Compress, but encoded in chunks on thread_ct
+ * threads. Every chunk's exact bit length comes from its own histogram, so 
+ * each one knows where in the bitstream it starts before anything is encoded.
+ * Falls back to Huff_Compress when the data is too small to be worth it.
+ * @param thread_ct If <= 0, uses the online core count.
+ * */
+uint32_t *Huff_Compress_Parallel(const void *data, HuffTree_t *hufftree, 
+    int word_ct, int *return_word_ct, int thread_ct);
+
+/* Streaming encoder. Compresses data fed to it piecewise, handing every 
+ * completed word of the bitstream to a sink callback, so memory use doesn't
+ * depend on input size. Concatenating everything handed to the sink gives
+ * exactly what Huff_Compress would have returned for the same data. */
+typedef struct s_huff_encoder HuffEncoder_t;
+typedef void (*Huff_Word_Sink_Cb_t)(const uint32_t *words, int word_ct, 
+    void *sink_ctx);
+HuffEncoder_t *Huff_Encoder_Create(const HuffTree_t *tree, 
+    Huff_Word_Sink_Cb_t sink, void *sink_ctx);
+/// @return 0 on success, -1 (see Huff_Strerror) on failure.
+int Huff_Encoder_Feed(HuffEncoder_t *enc, const void *data, int byte_ct);
+/// @return Total count of words handed to the sink, final partial word included.
+int Huff_Encoder_Finish(HuffEncoder_t *enc);
+void Huff_Encoder_Destroy(HuffEncoder_t *enc);
 
 int Huff_GBA_Header_Init(HuffHeader_GBA_t *dst, int decompressed_data_bytelen,
     DataSize_e data_unit_bitlen);
 HuffNode_GBA_t *Huff_GBA_Huff_Table_Create(const HuffTree_t *tree, 
     int *return_table_size);
+/**
+ * @summary Walk a GBA tree table the way the BIOS decoder would, and make 
+ * sure every descendants_ofs lands inside the table, every entry before the
+ * padding is reached exactly once, and every leaf fits in a data unit.
+ * Huff_GBA_Huff_Table_Create already runs this on every table it makes.
+ * @return 0 if the table is sound, -1 (see Huff_Strerror) if not.
+ * */
+int Huff_GBA_Huff_Table_Verify(const HuffNode_GBA_t *table, int table_size, 
+    DataSize_e data_unit_bitlen);
 
 
 #endif  /* _HUFFMAN_H_ */
@@ -0,0 +1,63 @@
+#include "batch.h"
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+typedef struct s_batch {
+  uint8_t *jobs;
+  size_t job_size;
+  int job_ct;
+  Batch_Job_Cb_t run;
+  int next;  /// Index of the next job to hand out. Only touched atomically.
+  int fail_ct;  /// Only touched atomically.
+} Batch_t;
+
+static void *Batch_Worker(void *arg) {
+  Batch_t *batch = arg;
+  // ctx is a few KB, all embedded, so it lives on the worker's own stack
+  HuffCtx_t ctx = HUFF_CTX_INITIALIZER;
+  int idx;
+  while ((idx = __atomic_fetch_add(&batch->next, 1, __ATOMIC_RELAXED)) 
+      < batch->job_ct) {
+    if (0 > batch->run(&ctx, batch->jobs + batch->job_size*idx))
+      __atomic_fetch_add(&batch->fail_ct, 1, __ATOMIC_RELAXED);
+  }
+  return NULL;
+}
+
+int Batch_Default_Thread_Ct(void) {
+  long ct = sysconf(_SC_NPROCESSORS_ONLN);
+  return ct > 0 ? (int)ct : 1;
+}
+
+int Batch_Run(void *jobs, size_t job_size, int job_ct, int thread_ct, 
+    Batch_Job_Cb_t run) {
+  Batch_t batch = {
+    .jobs = jobs,
+    .job_size = job_size,
+    .job_ct = job_ct,
+    .run = run,
+    .next = 0,
+    .fail_ct = 0
+  };
+  if (job_ct <= 0)
+    return 0;
+  if (thread_ct <= 0)
+    thread_ct = Batch_Default_Thread_Ct();
+  if (thread_ct > job_ct)
+    thread_ct = job_ct;
+
+  // calling thread works too, so only thread_ct-1 extra threads get 
+  // spawned. If spawning fails, whoever did get spawned picks up the slack.
+  pthread_t workers[thread_ct];
+  int spawned = 0;
+  for (; spawned < thread_ct-1; ++spawned) {
+    if (pthread_create(&workers[spawned], NULL, Batch_Worker, &batch))
+      break;
+  }
+  Batch_Worker(&batch);
+  for (int i = 0; i < spawned; ++i)
+    pthread_join(workers[i], NULL);
+  return batch.fail_ct;
+}
@@ -17,6 +17,7 @@ struct bst {
   BST_Alloc_Cb_t alloc_cb;
   BST_Dealloc_Cb_t dealloc_cb;
   size_t data_len;
+  BST_Node_Allocator_t node_allocator;
   int count;
 } __attribute__ ((aligned(8)));
 
@@ -25,6 +26,7 @@ struct bst_info {
   BST_Alloc_Cb_t alloccb;
   BST_Dealloc_Cb_t dealloc_cb;
   size_t len;
+  BST_Node_Allocator_t node_allocator;
 } __attribute__ ((aligned(8)));
 
 #define NODE_HEIGHT(root) ((root!=NULL) ? ( root->height) : (-1))
@@ -82,15 +84,45 @@ static BST_Node_t *BST_Node_RL_Rotate(BST_Node_t *root) {
   return newroot;
 }
 
+static void *BST_Default_Node_Alloc(void *pool, size_t size) {
+  (void)pool;
+  return calloc(1, size);
+}
+
+static void BST_Default_Node_Dealloc(void *pool, void *node) {
+  (void)pool;
+  free(node);
+}
+
+#define NODE_ALLOC(allocator) \
+  ((BST_Node_t*)((allocator).alloc((allocator).pool, sizeof(BST_Node_t))))
+#define NODE_FREE(allocator, node) ((allocator).dealloc((allocator).pool, node))
+
 BST_t *BST_Init(BST_Cmp_Cb_t comparison_cb, BST_Alloc_Cb_t data_alloc_cb, BST_Dealloc_Cb_t data_dealloc_cb, size_t data_size) {
+  return BST_Init_With_Allocator(comparison_cb, data_alloc_cb, data_dealloc_cb, data_size, NULL);
+}
+
+BST_t *BST_Init_With_Allocator(BST_Cmp_Cb_t comparison_cb, BST_Alloc_Cb_t data_alloc_cb, BST_Dealloc_Cb_t data_dealloc_cb, size_t data_size, const BST_Node_Allocator_t *node_allocator) {
   if (NULL==comparison_cb) {
     return NULL;
   }
+  if (node_allocator != NULL && (NULL==node_allocator->alloc || NULL==node_allocator->dealloc)) {
+    return NULL;
+  }
   BST_t *ret = malloc(sizeof(*ret));
   ret->cmp_cb = comparison_cb;
   ret->alloc_cb = data_alloc_cb;
   ret->dealloc_cb = data_dealloc_cb;
   ret->data_len = data_size;
+  if (node_allocator != NULL) {
+    ret->node_allocator = *node_allocator;
+  } else {
+    ret->node_allocator = (BST_Node_Allocator_t) {
+      .alloc = BST_Default_Node_Alloc,
+      .dealloc = BST_Default_Node_Dealloc,
+      .pool = NULL
+    };
+  }
   ret->root = NULL;
   ret->count = 0;
   return ret;
@@ -101,7 +133,7 @@ BST_t *BST_Init(BST_Cmp_Cb_t comparison_cb, BST_Alloc_Cb_t data_alloc_cb, BST_De
 static BST_Node_t *Node_Add(const struct bst_info *const info,  BST_Node_t *root, void *data, bool *insert_occurred) {
   int diff;
   if (!root) {
-    root = calloc(1, sizeof(*root));
+    root = NODE_ALLOC(info->node_allocator);
     if (info->alloccb) {
       root->data = (info->alloccb)(data);
     } else if (info->len) {
@@ -147,7 +179,7 @@ static BST_Node_t *Node_Add(const struct bst_info *const info,  BST_Node_t *root
   return root;
 }
 
-static void Node_Dealloc(BST_Node_t *node, BST_Dealloc_Cb_t deallocator_cb) {
+static void Node_Dealloc(BST_Node_t *node, BST_Dealloc_Cb_t deallocator_cb, const BST_Node_Allocator_t *node_allocator) {
   if (!node)
     return;
   if (node->l || node->r) {
@@ -158,12 +190,12 @@ static void Node_Dealloc(BST_Node_t *node, BST_Dealloc_Cb_t deallocator_cb) {
   if (NULL==deallocator_cb) {  // if dealloc callback is NULL then either the data
                                // is assumed be static (stack-based) or the responsibility
                                // of freeing the data from heap falls on the caller
-    free(node);
+    NODE_FREE(*node_allocator, node);
     return;
   }
 
   deallocator_cb(node->data);
-  free(node);
+  NODE_FREE(*node_allocator, node);
 }
 
 static BST_Node_t *Node_Hibbard_Rebal(BST_Node_t *root) {
@@ -186,7 +218,7 @@ static BST_Node_t *Node_Hibbard_Rebal(BST_Node_t *root) {
   }
 }
 
-static BST_Node_t *Node_Hibbard_Delete(BST_Node_t *root, BST_Dealloc_Cb_t dealloc_cb) {
+static BST_Node_t *Node_Hibbard_Delete(BST_Node_t *root, BST_Dealloc_Cb_t dealloc_cb, const BST_Node_Allocator_t *node_allocator) {
   if (!root)
     return root;  // this should never happen, duh...
   BST_Node_t *stack[root->height+2];
@@ -207,7 +239,7 @@ static BST_Node_t *Node_Hibbard_Delete(BST_Node_t *root, BST_Dealloc_Cb_t deallo
 #ifndef _SUPPRESS_BST_WARNINGS_
     smallest_rsub->r = NULL;
 #endif
-    Node_Dealloc(smallest_rsub, dealloc_cb);
+    Node_Dealloc(smallest_rsub, dealloc_cb, node_allocator);
   }
   while (top > -1) {
     stack[top]->l = tmp;
@@ -238,17 +270,17 @@ static BST_Node_t *Node_Rm(const struct bst_info *const info, BST_Node_t *root,
 #ifndef _SUPPRESS_BST_WARNINGS_
       root->r = NULL;
 #endif
-      Node_Dealloc(root, info->dealloc_cb);
+      Node_Dealloc(root, info->dealloc_cb, &info->node_allocator);
       return tnode;
     } else if (!(root->r)) {
       tnode = root->l;
 #ifndef _SUPPRESS_BST_WARNINGS_
       root->l = NULL;
 #endif
-      Node_Dealloc(root, info->dealloc_cb);
+      Node_Dealloc(root, info->dealloc_cb, &info->node_allocator);
       return tnode;
     } else {
-      return Node_Hibbard_Delete(root, info->dealloc_cb);
+      return Node_Hibbard_Delete(root, info->dealloc_cb, &info->node_allocator);
     }
   }
   if ((!*remove_occurred))
@@ -296,15 +328,15 @@ bool BST_Contains(BST_t *tree, void *data, BST_Cmp_Cb_t custom_cmp_cb) {
   return false;
 }
 
-static void Node_Free_Subtree(BST_Node_t *root, BST_Dealloc_Cb_t data_dealloc_cb) {
+static void Node_Free_Subtree(BST_Node_t *root, BST_Dealloc_Cb_t data_dealloc_cb, const BST_Node_Allocator_t *node_allocator) {
   if (!root)
     return;
-  Node_Free_Subtree(root->l, data_dealloc_cb);
-  Node_Free_Subtree(root->r, data_dealloc_cb);
+  Node_Free_Subtree(root->l, data_dealloc_cb, node_allocator);
+  Node_Free_Subtree(root->r, data_dealloc_cb, node_allocator);
 #ifndef _SUPPRESS_BST_WARNINGS_
   root->l = root->r = NULL;
 #endif
-  Node_Dealloc(root, data_dealloc_cb);
+  Node_Dealloc(root, data_dealloc_cb, node_allocator);
 }
 
 void *BST_Remove_Minimum(BST_t *tree) {
@@ -323,7 +355,7 @@ void *BST_Remove_Minimum(BST_t *tree) {
           ((tree->root->l && tree->root->r) ? "left and right subtrees" : ((tree->root->l) ? "left subtree" : "right subtree")));
     }
 #endif
-    free(tree->root);
+    NODE_FREE(tree->node_allocator, tree->root);
     tree->root = NULL;
     tree->count = 0;
     return ret;
@@ -338,10 +370,10 @@ void *BST_Remove_Minimum(BST_t *tree) {
   ret = min->data;
   if (min->r) {
     BST_Node_t *tmp = min->r;
-    free(min);
+    NODE_FREE(tree->node_allocator, min);
     min = tmp;
   } else {
-    free(min);
+    NODE_FREE(tree->node_allocator, min);
     min = NULL;
   }
   while (top > -1) {
@@ -354,7 +386,7 @@ void *BST_Remove_Minimum(BST_t *tree) {
 }
 
 void BST_Close(BST_t *tree) {
-  Node_Free_Subtree(tree->root, tree->dealloc_cb);
+  Node_Free_Subtree(tree->root, tree->dealloc_cb, &tree->node_allocator);
   free(tree);
 }
 
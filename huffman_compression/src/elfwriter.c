@@ -0,0 +1,164 @@
+#include "elfwriter.h"
+#include <assert.h>
+#include <elf.h>
+#include <string.h>
+
+/// Section header indices, in the order they're written
+enum e_elf_writer_shndx {
+  E_ELF_SHNDX_NULL=0,
+  E_ELF_SHNDX_RODATA,
+  E_ELF_SHNDX_SYMTAB,
+  E_ELF_SHNDX_STRTAB,
+  E_ELF_SHNDX_SHSTRTAB,
+  E_ELF_SHNDX_CT
+};
+
+/// Indexed by enum e_elf_writer_shndx, as offsets into it
+static const char elf_writer_shstrtab[] = "\0.rodata\0.symtab\0.strtab\0.shstrtab";
+static const uint32_t elf_writer_shstrtab_ofs[E_ELF_SHNDX_CT] = {0, 1, 9, 17, 25};
+
+/// The null symbol, then .rodata's section symbol, ahead of the globals
+#define ELF_WRITER_LOCAL_SYM_CT 2
+
+static uint32_t align_up(uint32_t ofs, uint32_t align) {
+  return (ofs + align-1) & ~(align-1);
+}
+
+static uint32_t elf_writer_strtab_size(const ElfWriter_t *writer) {
+  uint32_t size = 1;
+  for (int i = 0; i < writer->sym_ct; ++i)
+    size += strlen(writer->syms[i].name) + 1;
+  return size;
+}
+
+/// Write zeroes until fp is at file offset ofs, given it's at cur now.
+static void elf_writer_pad(FILE *fp, uint32_t cur, uint32_t ofs) {
+  static const char zeroes[32];
+  while (cur < ofs) {
+    const uint32_t ct = ofs - cur < sizeof(zeroes) ? ofs - cur : sizeof(zeroes);
+    fwrite(zeroes, 1, ct, fp);
+    cur += ct;
+  }
+}
+
+void elf_writer_begin(ElfWriter_t *dst, FILE *fp, uint32_t rodata_size, uint32_t rodata_align, const ElfSymbol_t *syms, int sym_ct) {
+  assert(sym_ct <= ELF_WRITER_MAX_SYMBOLS);
+  assert(rodata_align && !(rodata_align & (rodata_align-1)));
+  *dst = (ElfWriter_t) {
+    .fp = fp,
+    .rodata_ofs = align_up(sizeof(Elf32_Ehdr), rodata_align),
+    .rodata_size = rodata_size,
+    .rodata_align = rodata_align,
+    .sym_ct = sym_ct
+  };
+  memcpy(dst->syms, syms, sizeof(*syms)*sym_ct);
+
+  // everything after .rodata is laid out in elf_writer_end the same way
+  const uint32_t symtab_ofs = align_up(dst->rodata_ofs + rodata_size, 4),
+        strtab_ofs = symtab_ofs + (ELF_WRITER_LOCAL_SYM_CT + sym_ct)*sizeof(Elf32_Sym),
+        shstrtab_ofs = strtab_ofs + elf_writer_strtab_size(dst);
+  const Elf32_Ehdr ehdr = {
+    .e_ident = {
+      ELFMAG0, ELFMAG1, ELFMAG2, ELFMAG3, ELFCLASS32, ELFDATA2LSB, EV_CURRENT,
+      ELFOSABI_NONE
+    },
+    .e_type = ET_REL,
+    .e_machine = EM_ARM,
+    .e_version = EV_CURRENT,
+    .e_shoff = align_up(shstrtab_ofs + sizeof(elf_writer_shstrtab), 4),
+    .e_flags = EF_ARM_EABI_VER5,
+    .e_ehsize = sizeof(Elf32_Ehdr),
+    .e_shentsize = sizeof(Elf32_Shdr),
+    .e_shnum = E_ELF_SHNDX_CT,
+    .e_shstrndx = E_ELF_SHNDX_SHSTRTAB
+  };
+  fwrite(&ehdr, sizeof(ehdr), 1, fp);
+  elf_writer_pad(fp, sizeof(ehdr), dst->rodata_ofs);
+}
+
+void elf_writer_bytes(ElfWriter_t *writer, const void *bytes, uint32_t byte_ct) {
+  fwrite(bytes, 1, byte_ct, writer->fp);
+  writer->written += byte_ct;
+}
+
+void elf_writer_words(ElfWriter_t *writer, const uint32_t *words, uint32_t word_ct) {
+  // the GBA is little-endian, and so is every host this builds for
+  elf_writer_bytes(writer, words, word_ct*4);
+}
+
+void elf_writer_end(ElfWriter_t *writer) {
+  FILE *fp = writer->fp;
+  const uint32_t symtab_ofs = align_up(writer->rodata_ofs + writer->rodata_size, 4),
+        symtab_size = (ELF_WRITER_LOCAL_SYM_CT + writer->sym_ct)*sizeof(Elf32_Sym),
+        strtab_ofs = symtab_ofs + symtab_size,
+        strtab_size = elf_writer_strtab_size(writer),
+        shstrtab_ofs = strtab_ofs + strtab_size,
+        shdr_ofs = align_up(shstrtab_ofs + sizeof(elf_writer_shstrtab), 4);
+  uint32_t name_ofs = 1;
+  assert(writer->written == writer->rodata_size);
+  elf_writer_pad(fp, writer->rodata_ofs + writer->written, symtab_ofs);
+
+  {
+    const Elf32_Sym locals[ELF_WRITER_LOCAL_SYM_CT] = {
+      {0},
+      {
+        .st_info = ELF32_ST_INFO(STB_LOCAL, STT_SECTION),
+        .st_shndx = E_ELF_SHNDX_RODATA
+      }
+    };
+    fwrite(locals, sizeof(locals), 1, fp);
+  }
+  for (int i = 0; i < writer->sym_ct; ++i) {
+    const Elf32_Sym sym = {
+      .st_name = name_ofs,
+      .st_value = writer->syms[i].ofs,
+      .st_size = writer->syms[i].size,
+      .st_info = ELF32_ST_INFO(STB_GLOBAL, STT_OBJECT),
+      .st_shndx = E_ELF_SHNDX_RODATA
+    };
+    fwrite(&sym, sizeof(sym), 1, fp);
+    name_ofs += strlen(writer->syms[i].name) + 1;
+  }
+
+  fputc('\0', fp);
+  for (int i = 0; i < writer->sym_ct; ++i)
+    fwrite(writer->syms[i].name, 1, strlen(writer->syms[i].name) + 1, fp);
+  fwrite(elf_writer_shstrtab, 1, sizeof(elf_writer_shstrtab), fp);
+  elf_writer_pad(fp, shstrtab_ofs + sizeof(elf_writer_shstrtab), shdr_ofs);
+
+  const Elf32_Shdr shdrs[E_ELF_SHNDX_CT] = {
+    [E_ELF_SHNDX_RODATA] = {
+      .sh_name = elf_writer_shstrtab_ofs[E_ELF_SHNDX_RODATA],
+      .sh_type = SHT_PROGBITS,
+      .sh_flags = SHF_ALLOC,
+      .sh_offset = writer->rodata_ofs,
+      .sh_size = writer->rodata_size,
+      .sh_addralign = writer->rodata_align
+    },
+    [E_ELF_SHNDX_SYMTAB] = {
+      .sh_name = elf_writer_shstrtab_ofs[E_ELF_SHNDX_SYMTAB],
+      .sh_type = SHT_SYMTAB,
+      .sh_offset = symtab_ofs,
+      .sh_size = symtab_size,
+      .sh_link = E_ELF_SHNDX_STRTAB,
+      .sh_info = ELF_WRITER_LOCAL_SYM_CT,  // index of the first global
+      .sh_addralign = 4,
+      .sh_entsize = sizeof(Elf32_Sym)
+    },
+    [E_ELF_SHNDX_STRTAB] = {
+      .sh_name = elf_writer_shstrtab_ofs[E_ELF_SHNDX_STRTAB],
+      .sh_type = SHT_STRTAB,
+      .sh_offset = strtab_ofs,
+      .sh_size = strtab_size,
+      .sh_addralign = 1
+    },
+    [E_ELF_SHNDX_SHSTRTAB] = {
+      .sh_name = elf_writer_shstrtab_ofs[E_ELF_SHNDX_SHSTRTAB],
+      .sh_type = SHT_STRTAB,
+      .sh_offset = shstrtab_ofs,
+      .sh_size = sizeof(elf_writer_shstrtab),
+      .sh_addralign = 1
+    }
+  };
+  fwrite(shdrs, sizeof(shdrs), 1, fp);
+}
@@ -1,37 +1,178 @@
 #include "huffman.h"
 #include "filewriter.h"
+#include "huff_fast_lut.h"
+#include "huff_pipeline.h"
 #include <assert.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
 
+/// Start writer's hex emitter on its fp, formatted by fmt.
+static void src_writer_emit_begin(SrcWriter_t *writer, HexEmitFormat_t fmt) {
+  int ret = Hex_Emit_Begin(&writer->emit, writer->fp, &fmt);
+  assert(!ret);
+  (void)ret;
+}
 
-void write_header_file(FILE *fp, const char *exename, const char *infile, const char *outfile_name, const char *output_objname, size_t uncompressed_data_size, uint32_t comp_word_ct, uint32_t node_ct, uint32_t gba_table_len, DataSize_e huffcode_bitdepth, _Bool src_is_asm) {
-  char header_guard_macroname[(strlen(outfile_name) - 2) + 1];
-  int i, header_guard_namelen = sizeof(header_guard_macroname)-1;
+/// Header guard macro name for outfile_name, minus its extension. dst needs room for strlen(outfile_name)-1 chars.
+static void header_guard_name(char *dst, const char *outfile_name) {
+  int i, len = strlen(outfile_name) - 2;
   for (char c = outfile_name[i=0]; '.'!=c; c = outfile_name[++i]) {
-    header_guard_macroname[i] = isalpha(c) ? toupper(c) : '_';
+    dst[i] = isalpha(c) ? toupper(c) : '_';
+  }
+  dst[len] = '\0';
+}
+
+
+/**
+ * @summary The banner's "Input File Original Size" line, and if the data went
+ * through stages ahead of the codec, a line for what each one output, each 
+ * led by line_prefix.
+ * */
+static void write_input_size_lines(FILE *fp, const char *line_prefix, size_t original_data_size, const HuffPipelineStageInfo_t *stages, int stage_ct) {
+  fprintf(fp, "%sInput File Original Size:\t%lu (Padded to 4-byte alignment)\n", 
+      line_prefix, original_data_size);
+  for (int i = 0; i < stage_ct; ++i) {
+    fprintf(fp, "%sStage %d Output Size:\t\t%u (%s)\n", line_prefix, i+1, 
+        stages[i].out_byte_ct, Huff_Stage_Name(stages[i].stage));
   }
-  header_guard_macroname[header_guard_namelen] = '\0';
+}
+
+/**
+ * @summary If the compressed data decompresses to the output of more stages 
+ * (see huff_pipeline.h), say which SVCs get it back to the original data, in 
+ * what order, and how big the staging buffers between them need to be.
+ * */
+static void write_staging_macros(FILE *fp, const char *output_objname, const char *codec_name, size_t uncompressed_data_size, const HuffPipelineStageInfo_t *stages, int stage_ct) {
+  HuffPipelineStageInfo_t chain[HUFF_PIPELINE_MAX_STAGES+1];
+  uint32_t staging[2];
+  uint64_t cycles = 0;
+  if (!stage_ct)
+    return;
+  // the codec written here is the chain's last stage, so it's decoded first
+  memcpy(chain, stages, sizeof(*stages)*stage_ct);
+  chain[stage_ct] = (HuffPipelineStageInfo_t) { .in_byte_ct = uncompressed_data_size };
+  Huff_Pipeline_Staging_Sizes(chain, stage_ct+1, staging);
+  fprintf(fp, "/* The decompressed data is the output of %d more stage%s, so it still needs decoding,\n"
+      " * one SVC per stage, each reading what the step before it wrote:\n"
+      " *   1. The %s SVC (see %s_Compression_Type) on %s_%s_Compression_Data, into staging buffer 0\n",
+      stage_ct, stage_ct == 1 ? "" : "s", codec_name, output_objname, output_objname, codec_name);
+  for (int i = stage_ct-1, step = 2; i >= 0; --i, ++step) {
+    fprintf(fp, " *   %d. %s (%s) on staging buffer %d, into ", step, 
+        Huff_Stage_SVC_Name(stages[i].stage), Huff_Stage_Name(stages[i].stage), 
+        (stage_ct-1-i)&1);
+    if (i)
+      fprintf(fp, "staging buffer %d\n", (stage_ct-i)&1);
+    else
+      fputs("the destination\n", fp);
+    cycles += stages[i].decode_cycles;
+  }
+  if (stage_ct > 1)
+    fprintf(fp, " * Steps 2-%d take", stage_ct+1);
+  else
+    fputs(" * Step 2 takes", fp);
+  fprintf(fp, " an est. %llu more cycles (%.2f frames), reading from EWRAM.\n"
+      " * Stage N is the Nth applied on the way in, and Stage_N_Decompressed_Size the size of\n"
+      " * what its SVC writes.", (unsigned long long)cycles, (double)cycles/HUFF_GBA_FRAME_CYCLES);
+  if (staging[1])
+    fputs(" Allocate both staging buffers once, and reuse them for every step.\n", fp);
+  else
+    fputs(" Only staging buffer 0 gets used.\n", fp);
+  fputs(" * */\n", fp);
+  fprintf(fp, "#define %s_Pipeline_Stage_Ct %d\n", output_objname, stage_ct+1);
+  for (int i = 0; i < stage_ct; ++i) {
+    fprintf(fp, "#define %s_Stage_%d_Compression_Type 0x%X\n", output_objname, i+1, 
+        Huff_Stage_Compression_Type(stages[i].stage));
+    fprintf(fp, "#define %s_Stage_%d_Decompressed_Size %u\n", output_objname, i+1, 
+        stages[i].in_byte_ct);
+  }
+  fprintf(fp, "#define %s_Staging_Buffer_0_Size %u\n", output_objname, staging[0]);
+  fprintf(fp, "#define %s_Staging_Buffer_1_Size %u\n", output_objname, staging[1]);
+  fprintf(fp, "#define %s_Original_Data_Size %u\n", output_objname, stages[0].in_byte_ct);
+  fprintf(fp, "#define %s_Pipeline_Decode_Cycle_Estimate %lluUL\n\n", output_objname, 
+      (unsigned long long)cycles);
+}
+
+/// Unit bits of the difference filter a chain starting with stages starts with, or 0
+static int pipeline_diff_unit_bitlen(const HuffPipelineStageInfo_t *stages, int stage_ct) {
+  if (!stage_ct)
+    return 0;
+  return stages[0].stage == E_HUFF_STAGE_DIFF8 ? 8 
+    : stages[0].stage == E_HUFF_STAGE_DIFF16 ? 16 : 0;
+}
+
+/**
+ * @summary Macros a game can dispatch the right SVC(s) by, without knowing 
+ * ahead of time which codec the data came out of, e.g.: with -c auto.
+ * */
+static void write_dispatch_macros(FILE *fp, const char *output_objname, const char *codec_name, int compression_type, int diff_unit_bitlen) {
+  fputs("/* BIOS compression type, i.e.: the high nibble of the data's first byte, which says\n"
+      " * which SVC decompresses it: 0x1 LZ77 (SVC 0x11/0x12), 0x2 Huffman (SVC 0x13),\n"
+      " * 0x3 run-length (SVC 0x14/0x15). */\n", fp);
+  fprintf(fp, "#define %s_Compression_Type 0x%X\n", output_objname, compression_type);
+  fputs("// Unit bits of the difference filter the data gets unfiltered by last, or 0 if it doesn't\n", fp);
+  fprintf(fp, "#define %s_Diff_Filter_Bits %d\n", output_objname, diff_unit_bitlen);
+  fprintf(fp, "#define %s_Compression_Data %s_%s_Compression_Data\n\n", output_objname, output_objname, codec_name);
+}
+
+/// With -c auto, list how every candidate did, as a comment block.
+static void write_selection_comment(FILE *fp, const HuffSelectResult_t *selection) {
+  char name[32];
+  if (!selection)
+    return;
+  Huff_Select_Candidate_Name(name, sizeof(name), &selection->candidates[selection->winner]);
+  fprintf(fp, "// Codec Auto-Selection:\t%s, out of %d candidates", name, selection->candidate_ct);
+  if (selection->frame_weight)
+    fprintf(fp, ", at %g bytes per frame of decode time\n", selection->frame_weight);
+  else
+    fputs(", on size alone\n", fp);
+  for (int i = 0; i < selection->candidate_ct; ++i) {
+    const HuffSelectCandidate_t *cand = &selection->candidates[i];
+    Huff_Select_Candidate_Name(name, sizeof(name), cand);
+    if (cand->status == E_HUFF_SELECT_MEASURED)
+      fprintf(fp, "//   %-16s%9u bytes, %.2f frames to decode%s\n", name, cand->byte_ct, 
+          (double)cand->decode_cycles/HUFF_GBA_FRAME_CYCLES, i == selection->winner ? " [picked]" : "");
+    else if (cand->status == E_HUFF_SELECT_PRUNED)
+      fprintf(fp, "//   %-16s%9u bytes at least, so not tried\n", name, cand->bound);
+    else
+      fprintf(fp, "//   %-16scan't compress this data\n", name);
+  }
+  fputs("// ---------------------------------------------------------------------------------------\n\n\n", fp);
+}
+
+void write_header_file(FILE *fp, const char *exename, const char *infile, const char *outfile_name, const char *output_objname, size_t uncompressed_data_size, size_t original_data_size, uint32_t comp_word_ct, uint32_t node_ct, uint32_t gba_table_len, DataSize_e huffcode_bitdepth, _Bool src_is_asm, const HuffGBADecodeCost_t *decode_cost, int fast_lut_bits, const uint32_t *auto_byte_cts, const HuffPipelineStageInfo_t *stages, int stage_ct, const HuffSelectResult_t *selection) {
+  char header_guard_macroname[(strlen(outfile_name) - 2) + 1];
+  header_guard_name(header_guard_macroname, outfile_name);
+  char bitdepth_desc[80] = "";
+  if (auto_byte_cts)
+    snprintf(bitdepth_desc, sizeof(bitdepth_desc), " (auto: 4-bit %u bytes, "
+        "8-bit %u bytes predicted)", auto_byte_cts[0], auto_byte_cts[1]);
   
 
   fprintf(fp,
       "// Autogenerated GBA Huffman Compression Header File using %s by Burton O Sumner 2024 (C)\n"
       "// ---------------------------------------------------------------------------------------\n"
-      "// Input File Name:\t\t%s\n"
-      "// Input File Original Size:\t%lu (Padded to 4-byte alignment)\n"
+      "// Input File Name:\t\t%s\n", exename, infile);
+  write_input_size_lines(fp, "// ", original_data_size, stages, stage_ct);
+  fprintf(fp,
       "// ---------------------------------------------------------------------------------------\n"
       "// Compressed Data Name:\t%s\n"
       "// Compressed Data Size:\t%u (Padded to 4-byte alignment)\n"
       "// ---------------------------------------------------------------------------------------\n"
       "// Huffman Tree Node Count:\t%u\n"
       "// Huffman Tree Size:\t\t%u\n"
-      "// Huffcode Bitdepth:\t\t%d\n"
+      "// Huffcode Bitdepth:\t\t%d%s\n"
+      "// ---------------------------------------------------------------------------------------\n"
+      "// Est. GBA Decode Cycles:\t%llu (%.2f ms, %.2f frames) reading from %s\n"
+      "// Est. Worst Cycles Per Unit:\t%d\n"
       "// ---------------------------------------------------------------------------------------\n\n\n",
-      exename, infile, uncompressed_data_size, output_objname, comp_word_ct*4, node_ct, gba_table_len-1,
-      huffcode_bitdepth);
-  
+      output_objname, comp_word_ct*4, node_ct, gba_table_len-1,
+      huffcode_bitdepth, bitdepth_desc, (unsigned long long)decode_cost->cycles, 
+      1000.0*decode_cost->cycles/HUFF_GBA_CPU_HZ, 
+      (double)decode_cost->cycles/HUFF_GBA_FRAME_CYCLES, 
+      Huff_GBA_Region_Name(decode_cost->src_region), decode_cost->worst_unit_cycles);
+  write_selection_comment(fp, selection);
   
   fprintf(fp, "#ifndef _%s_H_\n#define _%s_H_\n\n", header_guard_macroname, header_guard_macroname);
 
@@ -45,6 +186,11 @@ void write_header_file(FILE *fp, const char *exename, const char *infile, const
       " * entry of the huffman tree table): raw compressed data addr is %s_Huffman_Compression_Data + sizeof(GBA_Huffman_Compression_Header_t) + 1 + %s_Huffman_Tree_Size\n"
       " * */\n", fp);
   fprintf(fp, "#define %s_Huffman_Tree_Size %u\n\n", output_objname, gba_table_len-1);
+  fprintf(fp, "/* Estimated CPU cycles the BIOS Huffman SVC takes to decompress this, with the\n"
+      " * compressed data read from %s. Compare against %d cycles per frame.\n"
+      " * */\n", Huff_GBA_Region_Name(decode_cost->src_region), HUFF_GBA_FRAME_CYCLES);
+  fprintf(fp, "#define %s_Huffman_Decode_Cycle_Estimate %lluUL\n\n", output_objname, 
+      (unsigned long long)decode_cost->cycles);
 
   fputs("/**\n"
       " * This is the pointer you need to pass to SVC for GBA's BIOS-provided Huffman Decompression routine\n"
@@ -52,6 +198,8 @@ void write_header_file(FILE *fp, const char *exename, const char *infile, const
       " * */\n", fp);
   fprintf(fp, "extern const unsigned int %s_Huffman_Compression_Data[%lu];\n\n",
       output_objname, (sizeof(HuffHeader_GBA_t) + gba_table_len)/4 + comp_word_ct);
+  write_staging_macros(fp, output_objname, "Huffman", uncompressed_data_size, stages, stage_ct);
+  write_dispatch_macros(fp, output_objname, "Huffman", HUFF_HEADER_GBA_COMPRESSION_TYPE_ID, pipeline_diff_unit_bitlen(stages, stage_ct));
   
   fputs("/* Define header bitfield structs only if they weren't already\n"
       " * defined in another huffcode data file, hence the nested header guard here\n"
@@ -94,6 +242,13 @@ void write_header_file(FILE *fp, const char *exename, const char *infile, const
   }
 
 
+  if (fast_lut_bits) {
+    fprintf(fp, "\n/* Faster, non-BIOS decoder for the above, probing a %d-bit lookup table (see\n"
+        " * its own source file). dst MUST be word-aligned.\n"
+        " * */\n"
+        "void %s_Huffman_Fast_Decompress(void *dst);\n", fast_lut_bits, output_objname);
+  }
+
   fputs("\n\n", fp);
 
   fputs("#ifdef __cplusplus\n}\n#endif  /* C++ name mangler guard closer */\n\n", fp);
@@ -101,12 +256,13 @@ void write_header_file(FILE *fp, const char *exename, const char *infile, const
 }
 
 
-void write_c_src_file(FILE *fp, const char *exename, const char *infile, const char *output_objname, size_t uncompressed_data_size, uint32_t *compdata, uint32_t comp_word_ct, HuffHeader_GBA_t gba_header, HuffTree_t *hufftree, HuffNode_GBA_t *gba_hufftree, uint32_t gba_table_len, DataSize_e huffcode_bitdepth) {
+void write_c_src_file_begin(SrcWriter_t *dst, FILE *fp, const char *exename, const char *infile, const char *output_objname, size_t original_data_size, const HuffPipelineStageInfo_t *stages, int stage_ct, uint32_t comp_word_ct, HuffHeader_GBA_t gba_header, HuffTree_t *hufftree, HuffNode_GBA_t *gba_hufftree, uint32_t gba_table_len, DataSize_e huffcode_bitdepth) {
   fprintf(fp, 
       "// Autogenerated GBA Huffman Compression Source File using %s by Burton O Sumner 2024 (C)\n"
       "// ---------------------------------------------------------------------------------------\n"
-      "// Input File Name:\t\t%s\n"
-      "// Input File Original Size:\t%lu (Padded to 4-byte alignment)\n"
+      "// Input File Name:\t\t%s\n", exename, infile);
+  write_input_size_lines(fp, "// ", original_data_size, stages, stage_ct);
+  fprintf(fp,
       "// ---------------------------------------------------------------------------------------\n"
       "// Compressed Data Name:\t%s\n"
       "// Compressed Data Size:\t%u (Padded to 4-byte alignment)\n"
@@ -115,49 +271,42 @@ void write_c_src_file(FILE *fp, const char *exename, const char *infile, const c
       "// Huffman Tree Size:\t\t%u\n"
       "// Huffcode Bitdepth:\t\t%d\n"
       "// ---------------------------------------------------------------------------------------\n\n\n",
-      exename, infile, uncompressed_data_size, output_objname, comp_word_ct*4, hufftree->node_ct, gba_table_len-1,
+      output_objname, comp_word_ct*4, hufftree->node_ct, gba_table_len-1,
       huffcode_bitdepth);
 
-  fprintf(fp, "const unsigned int %s_Huffman_Compression_Data[%lu] = {\n\t",
+  // 32-byte aligned, so the header and the hot top of the tree table (see 
+  // huff_gba_layout.h) share one span
+  fprintf(fp, "const unsigned int %s_Huffman_Compression_Data[%lu] "
+      "__attribute__((aligned(32))) = {\n\t",
       output_objname, (sizeof(HuffHeader_GBA_t) + gba_table_len)/4 + comp_word_ct);
-  int column_number = 1;
-  {
-    const uint32_t *cursor, *last;
-    fprintf(fp, "0x%08X,", *((uint32_t*) &gba_header));
-    assert((gba_table_len&3) == 0);
-    cursor = (uint32_t*)gba_hufftree;
-    for (int i = 0, table_word_ct = gba_table_len>>2; i++ < table_word_ct; ++cursor)
-      if (column_number++&7) {
-        fprintf(fp, " 0x%08X,", *cursor);
-      } else {
-        fprintf(fp, "\n\t0x%08X,", *cursor);
-        column_number = 1;
-      }
-
-
-    for (cursor = compdata, last = compdata + comp_word_ct - 1; cursor != last; ++cursor)
-      if (column_number++&7) {
-        fprintf(fp, " 0x%08X,", *cursor);
-      } else {
-        fprintf(fp, "\n\t0x%08X,", *cursor);
-        column_number = 1;
-      }
-    
-    if (column_number&7) {
-      fprintf(fp, " 0x%08X\n};\n\n", *last);
-    } else {
-      fprintf(fp, "\n\t0x%08X\n};\n\n", *last);
-    }
-  }
+  *dst = (SrcWriter_t) {
+    .fp = fp,
+    .output_objname = output_objname,
+    .word_idx = 0,
+    .type = 'c'
+  };
+  src_writer_emit_begin(dst, HEX_EMIT_C_WORDS);
+  Hex_Emit_Elem(&dst->emit, *((uint32_t*) &gba_header));
+  ++dst->word_idx;
+  assert((gba_table_len&3) == 0);
+  write_src_file_words(dst, (uint32_t*)gba_hufftree, gba_table_len>>2);
 }
 
+void write_c_src_file(FILE *fp, const char *exename, const char *infile, const char *output_objname, size_t original_data_size, const HuffPipelineStageInfo_t *stages, int stage_ct, uint32_t *compdata, uint32_t comp_word_ct, HuffHeader_GBA_t gba_header, HuffTree_t *hufftree, HuffNode_GBA_t *gba_hufftree, uint32_t gba_table_len, DataSize_e huffcode_bitdepth) {
+  SrcWriter_t writer;
+  write_c_src_file_begin(&writer, fp, exename, infile, output_objname, original_data_size, stages, stage_ct, comp_word_ct, gba_header, hufftree, gba_hufftree, gba_table_len, huffcode_bitdepth);
+  write_src_file_words(&writer, compdata, comp_word_ct);
+  write_src_file_end(&writer);
+}
 
-void write_asm_src_file(FILE *fp, const char *exename, const char *infile, const char *output_objname, size_t uncompressed_data_size, uint32_t *compdata, uint32_t comp_word_ct, HuffHeader_GBA_t gba_header, HuffTree_t *hufftree, HuffNode_GBA_t *gba_hufftree, uint32_t gba_table_len, DataSize_e huffcode_bitdepth) {
+
+void write_asm_src_file_begin(SrcWriter_t *dst, FILE *fp, const char *exename, const char *infile, const char *output_objname, size_t original_data_size, const HuffPipelineStageInfo_t *stages, int stage_ct, uint32_t comp_word_ct, HuffHeader_GBA_t gba_header, HuffTree_t *hufftree, HuffNode_GBA_t *gba_hufftree, uint32_t gba_table_len, DataSize_e huffcode_bitdepth) {
   fprintf(fp, 
       "@  Autogenerated GBA Huffman Compression ASM (GNU Assembler Syntax) File using %s by Burton O Sumner 2024 (C)\n"
       "@  ---------------------------------------------------------------------------------------\n"
-      "@  Input File Name:\t\t%s\n"
-      "@  Input File Original Size:\t%lu (Padded to 4-byte alignment)\n"
+      "@  Input File Name:\t\t%s\n", exename, infile);
+  write_input_size_lines(fp, "@  ", original_data_size, stages, stage_ct);
+  fprintf(fp,
       "@  ---------------------------------------------------------------------------------------\n"
       "@  Compressed Data Name:\t%s\n"
       "@  Compressed Data Size:\t%u (Padded to 4-byte alignment)\n"
@@ -166,12 +315,12 @@ void write_asm_src_file(FILE *fp, const char *exename, const char *infile, const
       "@  Huffman Tree Size:\t\t%u\n"
       "@  Huffcode Bitdepth:\t\t%d\n"
       "@  ---------------------------------------------------------------------------------------\n\n\n",
-      exename, infile, uncompressed_data_size, output_objname, comp_word_ct*4, hufftree->node_ct, gba_table_len-1,
+      output_objname, comp_word_ct*4, hufftree->node_ct, gba_table_len-1,
       huffcode_bitdepth);
 
   fputc('\t', fp);
   fprintf(fp, ".section .rodata\n\t"
-      ".align 4\n\t"
+      ".balign 32\n\t"
       ".global %s_Huffman_Compression_Data\n\t"
       ".type %s_Huffman_Compression_Data %%object\n\t"
       ".global %s_Huffman_Compression_Header\n\t"
@@ -200,14 +349,13 @@ void write_asm_src_file(FILE *fp, const char *exename, const char *infile, const
     fprintf(fp, ".hword 0x%04X", *((uint16_t*) &gba_hufftree[2]));
     const uint32_t *remaining_tree_words = ((uint32_t*) &gba_hufftree[4]),
              remaining_tree_word_ct = (gba_table_len - 4)/4;
+    const HexEmitFormat_t fmt = HEX_EMIT_ASM_WORDS;
+    HexEmitter_t emit;
     assert((gba_table_len-4) == (remaining_tree_word_ct*4));
     
-    for (uint32_t i = 0, col = 0; i < remaining_tree_word_ct; col&=7, ++i) {
-      if (!col++) {
-        fprintf(fp, "\n\t.word 0x%08X", *remaining_tree_words++);
-      } else {
-        fprintf(fp, ", 0x%08X", *remaining_tree_words++);
-      }
+    if (0 == Hex_Emit_Begin(&emit, fp, &fmt)) {
+      Hex_Emit_Elems(&emit, remaining_tree_words, remaining_tree_word_ct);
+      Hex_Emit_End(&emit);
     }
     fprintf(fp, "\n\t"
         ".size %s_Huffman_Tree_Nodes_Table, .-%s_Huffman_Tree_Nodes_Table\n\t"
@@ -217,17 +365,310 @@ void write_asm_src_file(FILE *fp, const char *exename, const char *infile, const
         output_objname, output_objname, output_objname);
   }
 
-  const uint32_t *cur = compdata;
-  for (uint32_t i = 0, col = 0; i < comp_word_ct; col&=7, ++i) {
-    if (!col++) {
-      fprintf(fp, "\n\t.word 0x%08X", *cur++);
-    } else {
-      fprintf(fp, ", 0x%08X", *cur++);
-    }
+  *dst = (SrcWriter_t) {
+    .fp = fp,
+    .output_objname = output_objname,
+    .word_idx = 0,
+    .type = 's'
+  };
+  src_writer_emit_begin(dst, HEX_EMIT_ASM_WORDS);
+}
+
+void write_asm_src_file(FILE *fp, const char *exename, const char *infile, const char *output_objname, size_t original_data_size, const HuffPipelineStageInfo_t *stages, int stage_ct, uint32_t *compdata, uint32_t comp_word_ct, HuffHeader_GBA_t gba_header, HuffTree_t *hufftree, HuffNode_GBA_t *gba_hufftree, uint32_t gba_table_len, DataSize_e huffcode_bitdepth, FILE *incbin_fp, const char *incbin_name) {
+  SrcWriter_t writer;
+  write_asm_src_file_begin(&writer, fp, exename, infile, output_objname, original_data_size, stages, stage_ct, comp_word_ct, gba_header, hufftree, gba_hufftree, gba_table_len, huffcode_bitdepth);
+  if (incbin_fp)
+    write_src_file_incbin(&writer, incbin_fp, incbin_name);
+  write_src_file_words(&writer, compdata, comp_word_ct);
+  write_src_file_end(&writer);
+}
+
+void write_obj_file_begin(SrcWriter_t *dst, FILE *fp, const char *output_objname, uint32_t comp_word_ct, HuffHeader_GBA_t gba_header, const HuffNode_GBA_t *gba_hufftree, uint32_t gba_table_len) {
+  static const char *const suffixes[] = {
+    "_Huffman_Compression_Data", "_Huffman_Compression_Header", 
+    "_Huffman_Tree_Nodes_Table", "_Huffman_Raw_Compressed_Data"
+  };
+  const size_t name_size = strlen(output_objname) + sizeof("_Huffman_Raw_Compressed_Data");
+  const uint32_t table_end = sizeof(HuffHeader_GBA_t) + gba_table_len;
+  // laid out the same as the ASM src file's symbols
+  ElfSymbol_t syms[] = {
+    { .ofs = 0, .size = table_end + comp_word_ct*4 },
+    { .ofs = 0, .size = sizeof(HuffHeader_GBA_t) },
+    { .ofs = sizeof(HuffHeader_GBA_t) + 1, .size = gba_table_len - 1 },
+    { .ofs = table_end, .size = comp_word_ct*4 }
+  };
+  char *names = malloc(name_size*4);
+  assert(names);
+  for (int i = 0; i < 4; ++i) {
+    snprintf(names + i*name_size, name_size, "%s%s", output_objname, suffixes[i]);
+    syms[i].name = names + i*name_size;
+  }
+  *dst = (SrcWriter_t) {
+    .fp = fp,
+    .output_objname = output_objname,
+    .word_idx = table_end/4,
+    .type = 'o',
+    .sym_names = names
+  };
+  // 32-byte aligned, same as the C and ASM src files
+  elf_writer_begin(&dst->elf, fp, syms[0].size, 32, syms, 4);
+  elf_writer_bytes(&dst->elf, &gba_header, sizeof(gba_header));
+  assert((gba_table_len&3) == 0);
+  elf_writer_bytes(&dst->elf, gba_hufftree, gba_table_len);
+}
+
+void write_obj_file(FILE *fp, const char *output_objname, const uint32_t *compdata, uint32_t comp_word_ct, HuffHeader_GBA_t gba_header, const HuffNode_GBA_t *gba_hufftree, uint32_t gba_table_len) {
+  SrcWriter_t writer;
+  write_obj_file_begin(&writer, fp, output_objname, comp_word_ct, gba_header, gba_hufftree, gba_table_len);
+  write_src_file_words(&writer, compdata, comp_word_ct);
+  write_src_file_end(&writer);
+}
+
+void write_src_file_words(SrcWriter_t *writer, const uint32_t *words, uint32_t word_ct) {
+  if (writer->type == 'o') {
+    elf_writer_words(&writer->elf, words, word_ct);
+  } else if (writer->incbin_fp) {
+    Hex_Emit_Raw(writer->incbin_fp, words, word_ct, 4);
+  } else {
+    Hex_Emit_Elems(&writer->emit, words, word_ct);
   }
+  writer->word_idx += word_ct;
+}
 
-  fprintf(fp, "\n\t"
+void write_src_file_incbin(SrcWriter_t *writer, FILE *incbin_fp, const char *incbin_name) {
+  assert(writer->type == 's');
+  Hex_Emit_Str(&writer->emit, "\n\t.incbin \"");
+  Hex_Emit_Str(&writer->emit, incbin_name);
+  Hex_Emit_Str(&writer->emit, "\"");
+  writer->incbin_fp = incbin_fp;
+}
+
+void write_src_file_end(SrcWriter_t *writer) {
+  const char *output_objname = writer->output_objname;
+  if (writer->type == 'o') {
+    elf_writer_end(&writer->elf);
+    free(writer->sym_names);
+    writer->sym_names = NULL;
+    return;
+  }
+  if (writer->type == 'c') {
+    Hex_Emit_Str(&writer->emit, "\n};\n\n");
+    Hex_Emit_End(&writer->emit);
+    return;
+  }
+  Hex_Emit_End(&writer->emit);
+  fprintf(writer->fp, "\n\t"
       ".size %s_Huffman_Raw_Compressed_Data, .-%s_Huffman_Raw_Compressed_Data\n\t"
       ".size %s_Huffman_Compression_Data, .-%s_Huffman_Compression_Data\n\n",
       output_objname, output_objname, output_objname, output_objname);
 }
+
+void write_src_file_abort(SrcWriter_t *writer) {
+  if (writer->type == 'o') {
+    free(writer->sym_names);
+    writer->sym_names = NULL;
+  } else {
+    Hex_Emit_End(&writer->emit);
+  }
+}
+
+/* Body of the emitted fast decoder. It only depends on FASTDEC_LUT_BITS, 
+ * FASTDEC_DATA_WORD_CT, FastDec_Lut, and FastDec_Data, all defined per file
+ * ahead of it, so it builds for the GBA and for a host alike. */
+static const char fast_decoder_body[] =
+  "  const unsigned int *src = FastDec_Data, *const end = FastDec_Data + FASTDEC_DATA_WORD_CT;\n"
+  "  const unsigned char *const table = (const unsigned char*)(src+1);  // [0] is the tree size byte, [1] the root\n"
+  "  const unsigned int unit_bitlen = src[0]&15;\n"
+  "  unsigned int unit_ct = (src[0]>>8)*8/unit_bitlen;\n"
+  "  unsigned int *out = dst, acc = 0, acc_bits = 0, cur, avail = 32, next;\n"
+  "  src += (4 + (table[0]+1)*2)/4;\n"
+  "  cur = *src++;\n"
+  "  next = src < end ? *src++ : 0;\n"
+  "  // cur holds the next avail (1-32) bits of the bitstream, MSB-aligned; next, the word after\n"
+  "#define FASTDEC_CONSUME(n) do { \\\n"
+  "    unsigned int n_ = (n); \\\n"
+  "    if (n_ < avail) { \\\n"
+  "      cur <<= n_; \\\n"
+  "      avail -= n_; \\\n"
+  "    } else { \\\n"
+  "      n_ -= avail; \\\n"
+  "      cur = next << n_; \\\n"
+  "      avail = 32 - n_; \\\n"
+  "      next = src < end ? *src++ : 0; \\\n"
+  "    } \\\n"
+  "  } while (0)\n"
+  "  while (unit_ct--) {\n"
+  "    const unsigned int peek = (avail >= FASTDEC_LUT_BITS ? cur : cur | (next>>avail)) >> (32-FASTDEC_LUT_BITS);\n"
+  "    const unsigned int ent = FastDec_Lut[peek], len = ent>>12;\n"
+  "    unsigned int unit;\n"
+  "    if (len) {\n"
+  "      FASTDEC_CONSUME(len);\n"
+  "      unit = ent&0xFFF;\n"
+  "    } else {\n"
+  "      // longer than the lookup: walk the rest a bit at a time, same as the BIOS\n"
+  "      unsigned int node = ent&0xFFF;\n"
+  "      FASTDEC_CONSUME(FASTDEC_LUT_BITS);\n"
+  "      for (;;) {\n"
+  "        const unsigned int subroot = table[node], bit = cur>>31,\n"
+  "              child = (node&~1U) + ((subroot&63)<<1) + 2 + bit;\n"
+  "        FASTDEC_CONSUME(1);\n"
+  "        if (subroot & (0x80>>bit)) {\n"
+  "          unit = table[child];\n"
+  "          break;\n"
+  "        }\n"
+  "        node = child;\n"
+  "      }\n"
+  "    }\n"
+  "    acc |= unit<<acc_bits;\n"
+  "    if ((acc_bits += unit_bitlen) == 32) {\n"
+  "      *out++ = acc;\n"
+  "      acc = acc_bits = 0;\n"
+  "    }\n"
+  "  }\n"
+  "#undef FASTDEC_CONSUME\n";
+
+void write_fast_decoder_file(FILE *fp, const char *exename, const char *infile, const char *output_objname, const HuffTree_t *hufftree, const uint16_t *lut, int lut_bits, const char *lut_section, uint32_t data_word_ct) {
+  fprintf(fp,
+      "// Autogenerated GBA Huffman Fast Decoder Source File using %s by Burton O Sumner 2024 (C)\n"
+      "// ---------------------------------------------------------------------------------------\n"
+      "// Input File Name:\t\t%s\n"
+      "// Compressed Data Name:\t%s\n"
+      "// Lookup Bits:\t\t\t%d\n"
+      "// Lookup Table Size:\t\t%u (In section %s)\n"
+      "// ---------------------------------------------------------------------------------------\n"
+      "// Lookup Bits | Table Size | Table Reads Per Unit (BIOS: %.2f)\n",
+      exename, infile, output_objname, lut_bits, 
+      (unsigned)(sizeof(*lut)<<lut_bits), lut_section, 
+      Huff_Fast_Lut_Reads_Per_Unit(hufftree, 0));
+  for (int bits = 4; bits <= HUFF_FAST_LUT_MAX_BITS; ++bits) {
+    fprintf(fp, "// %11d | %10u | %.3f%s\n", bits, (unsigned)(sizeof(*lut)<<bits),
+        Huff_Fast_Lut_Reads_Per_Unit(hufftree, bits), bits == lut_bits ? " <-" : "");
+  }
+  fputs("// ---------------------------------------------------------------------------------------\n\n"
+      "/* Decodes the same data as the BIOS Huffman SVC, straight from the\n"
+      " * compressed data, but probes the lookup table for up to FASTDEC_LUT_BITS\n"
+      " * bits of code at a time instead of walking the tree a bit at a time.\n"
+      " * */\n\n", fp);
+  fprintf(fp, "#define FASTDEC_LUT_BITS %d\n"
+      "#define FASTDEC_DATA_WORD_CT %u\n\n"
+      "extern const unsigned int %s_Huffman_Compression_Data[FASTDEC_DATA_WORD_CT];\n"
+      "#define FastDec_Data %s_Huffman_Compression_Data\n\n",
+      lut_bits, data_word_ct, output_objname, output_objname);
+  fprintf(fp, "static const unsigned short FastDec_Lut[1<<FASTDEC_LUT_BITS] "
+      "__attribute__((section(\"%s\"), aligned(4))) = {", lut_section);
+  {
+    const HexEmitFormat_t fmt = {
+      .elem_bytes = 2, .cols = 16, .first = "\n\t", .row = ",\n\t", .sep = ", "
+    };
+    HexEmitter_t emit;
+    if (0 == Hex_Emit_Begin(&emit, fp, &fmt)) {
+      Hex_Emit_Elems(&emit, lut, 1<<lut_bits);
+      Hex_Emit_End(&emit);
+    }
+  }
+  fputs("\n};\n\n", fp);
+  fprintf(fp, "/**\n"
+      " * @param dst MUST be word-aligned, with room for %s_Huffman_Compression_Data's\n"
+      " * decompressed size. Only ever written a word at a time, so it can be VRAM.\n"
+      " * */\n"
+      "void %s_Huffman_Fast_Decompress(void *dst);\n"
+      "void %s_Huffman_Fast_Decompress(void *dst) {\n", 
+      output_objname, output_objname, output_objname);
+  fputs(fast_decoder_body, fp);
+  fputs("}\n\n#undef FastDec_Data\n", fp);
+}
+
+/// The comment block atop every codec src and header file, each line led by line_prefix.
+static void write_codec_comment_block(FILE *fp, const char *line_prefix, const char *what, const char *exename, const char *infile, const char *output_objname, const char *codec_name, const char *decode_with, size_t original_data_size, const HuffPipelineStageInfo_t *stages, int stage_ct, uint32_t comp_word_ct) {
+  const char *p = line_prefix;
+  fprintf(fp,
+      "%sAutogenerated GBA %s Compression %s using %s by Burton O Sumner 2024 (C)\n"
+      "%s---------------------------------------------------------------------------------------\n"
+      "%sInput File Name:\t\t%s\n",
+      p, codec_name, what, exename, p, p, infile);
+  write_input_size_lines(fp, p, original_data_size, stages, stage_ct);
+  fprintf(fp,
+      "%s---------------------------------------------------------------------------------------\n"
+      "%sCompressed Data Name:\t%s\n"
+      "%sCompressed Data Size:\t%u (Padded to 4-byte alignment)\n"
+      "%s---------------------------------------------------------------------------------------\n"
+      "%sDecompress With:\t\t%s\n"
+      "%s---------------------------------------------------------------------------------------\n\n\n",
+      p, p, output_objname, p, comp_word_ct*4, p, p, decode_with, p);
+}
+
+void write_c_codec_src_file(FILE *fp, const char *exename, const char *infile, const char *output_objname, const char *codec_name, const char *decode_with, size_t original_data_size, const HuffPipelineStageInfo_t *stages, int stage_ct, const uint32_t *compdata, uint32_t comp_word_ct) {
+  SrcWriter_t writer = {
+    .fp = fp,
+    .output_objname = output_objname,
+    .word_idx = 0,
+    .type = 'c'
+  };
+  write_codec_comment_block(fp, "// ", "Source File", exename, infile, output_objname, codec_name, decode_with, original_data_size, stages, stage_ct, comp_word_ct);
+  fprintf(fp, "const unsigned int %s_%s_Compression_Data[%u] "
+      "__attribute__((aligned(4))) = {\n\t",
+      output_objname, codec_name, comp_word_ct);
+  src_writer_emit_begin(&writer, HEX_EMIT_C_WORDS);
+  write_src_file_words(&writer, compdata, comp_word_ct);
+  write_src_file_end(&writer);
+}
+
+void write_asm_codec_src_file(FILE *fp, const char *exename, const char *infile, const char *output_objname, const char *codec_name, const char *decode_with, size_t original_data_size, const HuffPipelineStageInfo_t *stages, int stage_ct, const uint32_t *compdata, uint32_t comp_word_ct, FILE *incbin_fp, const char *incbin_name) {
+  SrcWriter_t writer = {
+    .fp = fp,
+    .output_objname = output_objname,
+    .word_idx = 0,
+    .type = 's'
+  };
+  write_codec_comment_block(fp, "@  ", "ASM (GNU Assembler Syntax) File", exename, infile, output_objname, codec_name, decode_with, original_data_size, stages, stage_ct, comp_word_ct);
+  fprintf(fp, "\t.section .rodata\n\t"
+      ".balign 4\n\t"
+      ".global %s_%s_Compression_Data\n\t"
+      ".type %s_%s_Compression_Data %%object\n"
+      "%s_%s_Compression_Data:",
+      output_objname, codec_name, output_objname, codec_name, output_objname, 
+      codec_name);
+  src_writer_emit_begin(&writer, HEX_EMIT_ASM_WORDS);
+  if (incbin_fp)
+    write_src_file_incbin(&writer, incbin_fp, incbin_name);
+  write_src_file_words(&writer, compdata, comp_word_ct);
+  Hex_Emit_End(&writer.emit);
+  fprintf(fp, "\n\t.size %s_%s_Compression_Data, .-%s_%s_Compression_Data\n\n",
+      output_objname, codec_name, output_objname, codec_name);
+}
+
+void write_obj_codec_file(FILE *fp, const char *output_objname, const char *codec_name, const uint32_t *compdata, uint32_t comp_word_ct) {
+  const size_t name_size = strlen(output_objname) + strlen(codec_name) + sizeof("__Compression_Data");
+  char name[name_size];
+  const ElfSymbol_t sym = { .name = name, .ofs = 0, .size = comp_word_ct*4 };
+  ElfWriter_t elf;
+  snprintf(name, name_size, "%s_%s_Compression_Data", output_objname, codec_name);
+  elf_writer_begin(&elf, fp, sym.size, 4, &sym, 1);
+  elf_writer_words(&elf, compdata, comp_word_ct);
+  elf_writer_end(&elf);
+}
+
+void write_codec_header_file(FILE *fp, const char *exename, const char *infile, const char *outfile_name, const char *output_objname, const char *codec_name, const char *decode_with, size_t uncompressed_data_size, size_t original_data_size, uint32_t comp_word_ct, int compression_type, const HuffPipelineStageInfo_t *stages, int stage_ct, const HuffSelectResult_t *selection) {
+  char header_guard_macroname[(strlen(outfile_name) - 2) + 1];
+  header_guard_name(header_guard_macroname, outfile_name);
+  write_codec_comment_block(fp, "// ", "Header File", exename, infile, output_objname, codec_name, decode_with, original_data_size, stages, stage_ct, comp_word_ct);
+  write_selection_comment(fp, selection);
+
+  fprintf(fp, "#ifndef _%s_H_\n#define _%s_H_\n\n", header_guard_macroname, header_guard_macroname);
+  fputs("#ifdef __cplusplus\nextern \"C\" {\n#endif  /* C++ name mangler guard opener */\n\n", fp);
+
+  fputs("// Use this macro to declare the empty data buffer you want the decompressed data stored in.\n", fp);
+  fprintf(fp, "#define %s_Decompressed_Data_Size %lu\n\n", output_objname, uncompressed_data_size);
+  fprintf(fp, "/**\n"
+      " * This is the pointer you need to pass via R0 (aka function param 0) to the\n"
+      " * BIOS-provided decompression routine: %s\n"
+      " * */\n", decode_with);
+  fprintf(fp, "extern const unsigned int %s_%s_Compression_Data[%u];\n\n",
+      output_objname, codec_name, comp_word_ct);
+  write_staging_macros(fp, output_objname, codec_name, uncompressed_data_size, stages, stage_ct);
+  write_dispatch_macros(fp, output_objname, codec_name, compression_type, pipeline_diff_unit_bitlen(stages, stage_ct));
+  fputs("\n", fp);
+
+  fputs("#ifdef __cplusplus\n}\n#endif  /* C++ name mangler guard closer */\n\n", fp);
+  fprintf(fp, "#endif  /* _%s_H_ */\n", header_guard_macroname);
+}
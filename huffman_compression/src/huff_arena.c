@@ -0,0 +1,109 @@
+#include "huff_arena.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define HUFF_ARENA_ALIGN 16UL
+#define ALIGN_UP(n) (((n) + (HUFF_ARENA_ALIGN-1)) & ~(HUFF_ARENA_ALIGN-1))
+
+typedef struct s_huff_arena_block {
+  struct s_huff_arena_block *next;
+  size_t cap, used;
+  // pad header out so that buf starts on an alignment boundary
+  uint8_t pad[HUFF_ARENA_ALIGN - (sizeof(void*) + 2*sizeof(size_t))%HUFF_ARENA_ALIGN];
+  uint8_t buf[];
+} HuffArenaBlock_t;
+
+struct s_huff_arena {
+  HuffArenaBlock_t *head;  /// Block currently being bumped. Older blocks follow.
+  HuffArenaBlock_t *first;  /// Block made by Huff_Arena_Create. Kept by reset.
+  size_t block_size;
+};
+
+static HuffArenaBlock_t *Huff_Arena_Block_Create(size_t cap, 
+    HuffArenaBlock_t *next) {
+  HuffArenaBlock_t *ret = malloc(sizeof(*ret) + cap);
+  if (!ret)
+    return NULL;
+  ret->next = next;
+  ret->cap = cap;
+  ret->used = 0;
+  return ret;
+}
+
+HuffArena_t *Huff_Arena_Create(size_t block_size) {
+  HuffArena_t *ret = malloc(sizeof(*ret));
+  if (!ret)
+    return NULL;
+  ret->block_size = block_size ? ALIGN_UP(block_size) 
+                               : HUFF_ARENA_DEFAULT_BLOCK_SIZE;
+  if (!(ret->head = Huff_Arena_Block_Create(ret->block_size, NULL))) {
+    free(ret);
+    return NULL;
+  }
+  ret->first = ret->head;
+  return ret;
+}
+
+void *Huff_Arena_Alloc(HuffArena_t *arena, size_t size) {
+  HuffArenaBlock_t *blk = arena->head;
+  void *ret;
+  size = ALIGN_UP(size);
+  if (blk->cap - blk->used < size) {
+    if (size > arena->block_size) {
+      // oversized requests get a block of their own, tucked in behind the 
+      // head, so they don't waste the remainder of the current block
+      HuffArenaBlock_t *big = Huff_Arena_Block_Create(size, blk->next);
+      if (!big)
+        return NULL;
+      big->used = size;
+      blk->next = big;
+      return big->buf;
+    }
+    if (!(blk = Huff_Arena_Block_Create(arena->block_size, blk)))
+      return NULL;
+    arena->head = blk;
+  }
+  ret = &blk->buf[blk->used];
+  blk->used += size;
+  return ret;
+}
+
+void *Huff_Arena_Calloc(HuffArena_t *arena, size_t nmemb, size_t size) {
+  void *ret = Huff_Arena_Alloc(arena, nmemb*size);
+  if (ret)
+    memset(ret, 0, nmemb*size);
+  return ret;
+}
+
+void Huff_Arena_Reset(HuffArena_t *arena) {
+  HuffArenaBlock_t *blk, *nxt;
+  for (blk = arena->head; blk; blk = nxt) {
+    nxt = blk->next;
+    if (blk != arena->first)
+      free(blk);
+  }
+  arena->head = arena->first;
+  arena->head->next = NULL;
+  arena->head->used = 0;
+}
+
+void Huff_Arena_Destroy(HuffArena_t *arena) {
+  HuffArenaBlock_t *blk, *nxt;
+  if (!arena)
+    return;
+  for (blk = arena->head; blk; blk = nxt) {
+    nxt = blk->next;
+    free(blk);
+  }
+  free(arena);
+}
+
+void *Huff_Arena_BST_Node_Alloc_Cb(void *arena, size_t size) {
+  return Huff_Arena_Calloc(arena, 1, size);
+}
+
+void Huff_Arena_BST_Node_Dealloc_Cb(void *arena, void *node) {
+  (void)arena;
+  (void)node;
+}
@@ -1,7 +1,8 @@
 #include "huff_codebase.h"
-#include "binary_tree.h"
+#include "huff_ctx.h"
 #include "huffman.h"
 #include <stdlib.h>
+#include <string.h>
 
 enum e_huff_codebase_errno {
   HUFF_CODEBASE_ERROR_NONE=0,
@@ -9,11 +10,10 @@ enum e_huff_codebase_errno {
   HUFF_CODEBASE_ERROR_BAD_HUFFTREE_GIVEN,
   HUFF_CODEBASE_ERROR_ALLOCATION_FAILED
 };
-static enum e_huff_codebase_errno huff_cberrno = HUFF_CODEBASE_ERROR_NONE;
 
 #define ERRCASE(c) case c: return #c
-const char *Huff_Codebase_Strerror(void) {
-  switch (huff_cberrno) {
+const char *Huff_Ctx_Codebase_Strerror(const HuffCtx_t *ctx) {
+  switch ((enum e_huff_codebase_errno)ctx->codebase_err) {
     case HUFF_CODEBASE_ERROR_NONE: 
       return "No error to report.";
     ERRCASE(HUFF_CODEBASE_ERROR_MAX_CODELEN_REACHED);
@@ -24,14 +24,10 @@ const char *Huff_Codebase_Strerror(void) {
   }
 }
 
-static int Data_Against_Codent_Cmp_Cb(const void *data, const void *codent) {
-  return (*((const uint32_t*) data)) - (((const CodeEntry_t*) codent)->data);
+const char *Huff_Codebase_Strerror(void) {
+  return Huff_Ctx_Codebase_Strerror(Huff_Ctx_Default());
 }
 
-static int Codent_Cmp_Cb(const void *a, const void *b) {
-  const CodeEntry_t *c0=a, *c1=b;
-  return (c0->data - c1->data);
-}
 #define warnf(fmt, ...) fprintf(stderr, WARN_PREFIX fmt, __VA_ARGS__)
 #define warn(s) fputs(WARN_PREFIX s, stderr)
 #define soft_assertf(expr, fmt, ...) do { \
@@ -41,11 +37,12 @@ static int Codent_Cmp_Cb(const void *a, const void *b) {
     } \
   } while (0)
 
-void Huff_Codebase_Fill(CodeBase_t *dst, HuffNode_t *root, 
+static void Huff_Codebase_Fill(CodeBase_t *dst, HuffNode_t *root, 
     CodeEntry_t *const codent) {
   if (HUFF_NODE_IS_LEAF(root)) {
-    codent->data = root->data[0];
-    BST_Add(dst, codent);
+    codent->data = root->data;
+    dst->entries[codent->data] = *codent;
+    ++(dst->entry_ct);
     return;
   }
   ++(codent->codelen);
@@ -58,40 +55,60 @@ void Huff_Codebase_Fill(CodeBase_t *dst, HuffNode_t *root,
   codent->code>>=1;
 }
 
-CodeBase_t *Huff_Codebase_Create(const HuffTree_t *tree) {
+int Huff_Ctx_Codebase_Init(HuffCtx_t *ctx, CodeBase_t *dst, 
+    const HuffTree_t *tree) {
   CodeEntry_t tmp = {0};
-  CodeBase_t *ret;
-  huff_cberrno = HUFF_CODEBASE_ERROR_BAD_HUFFTREE_GIVEN;
+  ctx->codebase_err = HUFF_CODEBASE_ERROR_BAD_HUFFTREE_GIVEN;
   if (!tree)
-    return NULL;
+    return -1;
   if (!tree->root)
-    return NULL;
+    return -1;
   if (HUFF_NODE_IS_LEAF(tree->root))
-    return NULL;
-  huff_cberrno = HUFF_CODEBASE_ERROR_NONE;
-  ret = BST_Init(Codent_Cmp_Cb, NULL, free, sizeof(tmp));
+    return -1;
+  if ((1<<tree->data_unit_bitlen) > HUFF_CODEBASE_MAX_ENTRIES)
+    return -1;
+  ctx->codebase_err = HUFF_CODEBASE_ERROR_NONE;
+  if ((1+tree->root->height) > 64) {
+    ctx->codebase_err = HUFF_CODEBASE_ERROR_MAX_CODELEN_REACHED;
+    return -1;
+  }
+  // zero only the entries this tree's data units index, so that every one
+  // not filled in below keeps codelen=0, which is what marks it as missing
+  // from the tree
+  memset(dst->entries, 0, sizeof(*dst->entries)<<tree->data_unit_bitlen);
+  dst->data_unit_bitlen = tree->data_unit_bitlen;
+  dst->entry_ct = 0;
+  Huff_Codebase_Fill(dst, tree->root, &tmp);
+  return 0;
+}
+
+CodeBase_t *Huff_Codebase_Create(const HuffTree_t *tree) {
+  HuffCtx_t *ctx = Huff_Ctx_Default();
+  CodeBase_t *ret = malloc(sizeof(*ret));
   if (!ret) {
-    huff_cberrno = HUFF_CODEBASE_ERROR_ALLOCATION_FAILED;
+    ctx->codebase_err = HUFF_CODEBASE_ERROR_ALLOCATION_FAILED;
     return NULL;
   }
-  if ((1+tree->root->height) > 64) {
-    BST_Close(ret);
-    huff_cberrno = HUFF_CODEBASE_ERROR_MAX_CODELEN_REACHED;
+  if (0 > Huff_Ctx_Codebase_Init(ctx, ret, tree)) {
+    free(ret);
     return NULL;
   }
-  Huff_Codebase_Fill(ret, tree->root, &tmp);
   return ret;
 }
 
 CodeEntry_t *Huff_Codebase_Get_Code(CodeBase_t *codebase, uint32_t data) {
+  CodeEntry_t *ret;
   if (!codebase)
     return NULL;
-  return BST_Retrieve(codebase, &data, Data_Against_Codent_Cmp_Cb);
+  if (data >= (1U<<codebase->data_unit_bitlen))
+    return NULL;
+  ret = &codebase->entries[data];
+  return ret->codelen ? ret : NULL;
 }
 
 
 void Huff_Codebase_Destroy(CodeBase_t *codebase) {
   if (!codebase)
     return;
-  BST_Close(codebase);
+  free(codebase);
 }
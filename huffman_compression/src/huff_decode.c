@@ -0,0 +1,257 @@
+#include "huff_decode.h"
+#include "huff_errno.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Decoded bytes get handed to a streaming decoder's sink this many at a time
+#define HUFF_DECODE_BUF_SIZE 0x1000
+// Table index of the root; it's where every code starts
+#define HUFF_DECODE_ROOT 1
+
+typedef struct s_huff_decode_ent {
+  uint16_t value;  /// The data unit if is_leaf, else the table index the code continues from
+  uint8_t len;  /// Bits of the code consumed by this lookup
+  uint8_t is_leaf;
+} HuffDecodeEnt_t;
+
+struct s_huff_decoder {
+  HuffCtx_t *ctx;  /// Where errors and the decoder's own memory go
+  const HuffNode_GBA_t *table;
+  DataSize_e data_unit_bitlen;
+  uint32_t units_left;
+  uint64_t bits;  /// Bits fed but not yet decoded, MSB-aligned
+  int bit_ct;
+  int node;  /// Where a code that ran past the end of the last feed left off
+  _Bool high_nibble;
+  byte *out;
+  size_t out_len, out_cap, out_total;
+  Huff_Byte_Sink_Cb_t sink;
+  void *sink_ctx;
+  HuffDecodeEnt_t lut[1<<HUFF_DECODE_LUT_BITS];
+  byte buf[HUFF_DECODE_BUF_SIZE];
+};
+
+/**
+ * @summary Fill in every lookup entry under the subroot at table index at,
+ * whose code so far is prefix, depth bits long. Codes that end within
+ * HUFF_DECODE_LUT_BITS bits fill every entry they're a prefix of; longer
+ * ones get one entry pointing at where to carry on walking from.
+ * */
+static void Huff_Decode_Lut_Fill(HuffDecodeEnt_t *lut,
+    const HuffNode_GBA_t *table, int at, uint32_t prefix, int depth) {
+  const HuffSubroot_GBA_t subroot = table[at].subroot;
+  const int child = (at&~1) + 2*subroot.descendants_ofs + 2, len = depth+1;
+  for (int side = 0; side < 2; ++side) {
+    uint32_t code = (prefix<<1)|side;
+    if (side ? subroot.r_is_leaf : subroot.l_is_leaf) {
+      const int shift = HUFF_DECODE_LUT_BITS - len;
+      const HuffDecodeEnt_t ent = {
+        .value = table[child+side].leaf, .len = len, .is_leaf = 1
+      };
+      for (uint32_t i = 0; i < (1U<<shift); ++i)
+        lut[(code<<shift)|i] = ent;
+    } else if (len == HUFF_DECODE_LUT_BITS) {
+      lut[code] = (HuffDecodeEnt_t) {
+        .value = child+side, .len = len, .is_leaf = 0
+      };
+    } else {
+      Huff_Decode_Lut_Fill(lut, table, child+side, code, len);
+    }
+  }
+}
+
+static int Huff_Decoder_Init(HuffCtx_t *ctx, HuffDecoder_t *dec,
+    HuffHeader_GBA_t header, const HuffNode_GBA_t *table, int table_size) {
+  if (!table) {
+    ctx->err = HUFF_ERROR_NO_TREE_SUPPLIED;
+    return -1;
+  }
+  if (header.id_reserved != HUFF_HEADER_GBA_COMPRESSION_TYPE_ID
+      || (header.data_unit_bitlen != E_DATA_UNIT_4_BITS
+        && header.data_unit_bitlen != E_DATA_UNIT_8_BITS)) {
+    ctx->err = HUFF_ERROR_BAD_HEADER;
+    return -1;
+  }
+  // walking the table is only safe once it's known to be a sound tree
+  if (0 > Huff_Ctx_GBA_Huff_Table_Verify(ctx, table, table_size,
+        header.data_unit_bitlen))
+    return -1;
+  dec->ctx = ctx;
+  dec->table = table;
+  dec->data_unit_bitlen = header.data_unit_bitlen;
+  // the size field is a plain int bitfield, so it reads back sign-extended
+  dec->units_left = (((uint32_t)header.decomp_data_size)&HUFF_GBA_MAX_DECOMP_SIZE)
+    * 8 / header.data_unit_bitlen;
+  dec->bits = 0;
+  dec->bit_ct = 0;
+  dec->node = HUFF_DECODE_ROOT;
+  dec->high_nibble = 0;
+  dec->out_len = dec->out_total = 0;
+  Huff_Decode_Lut_Fill(dec->lut, table, HUFF_DECODE_ROOT, 0, 0);
+  return 0;
+}
+
+static inline void Huff_Decoder_Emit(HuffDecoder_t *dec, unsigned unit) {
+  if (dec->data_unit_bitlen == E_DATA_UNIT_8_BITS) {
+    dec->out[dec->out_len++] = unit;
+  } else if (!dec->high_nibble) {
+    dec->out[dec->out_len] = unit;
+    dec->high_nibble = 1;
+  } else {
+    dec->out[dec->out_len++] |= unit<<4;
+    dec->high_nibble = 0;
+  }
+  --dec->units_left;
+  if (dec->out_len == dec->out_cap && dec->sink) {
+    dec->sink(dec->out, dec->out_len, dec->sink_ctx);
+    dec->out_total += dec->out_len;
+    dec->out_len = 0;
+  }
+}
+
+void Huff_Decoder_Feed(HuffDecoder_t *dec, const uint32_t *words,
+    int word_ct) {
+  const uint32_t *const end = words + word_ct;
+  const HuffNode_GBA_t *const table = dec->table;
+  uint64_t bits = dec->bits;
+  int bit_ct = dec->bit_ct, node = dec->node;
+  while (dec->units_left) {
+    if (bit_ct <= 32 && words != end) {
+      bits |= ((uint64_t)*words++) << (32 - bit_ct);
+      bit_ct += 32;
+    }
+    if (node == HUFF_DECODE_ROOT && bit_ct >= HUFF_DECODE_LUT_BITS) {
+      const HuffDecodeEnt_t ent = dec->lut[bits>>(64-HUFF_DECODE_LUT_BITS)];
+      bits <<= ent.len;
+      bit_ct -= ent.len;
+      if (ent.is_leaf) {
+        Huff_Decoder_Emit(dec, ent.value);
+        continue;
+      }
+      node = ent.value;
+    }
+    // Codes longer than the lookup, and whatever's left at the very end,
+    // get walked a bit at a time, same as the BIOS would.
+    while (bit_ct) {
+      const HuffSubroot_GBA_t subroot = table[node].subroot;
+      const int child = (node&~1) + 2*subroot.descendants_ofs + 2,
+            bit = bits>>63;
+      bits <<= 1;
+      --bit_ct;
+      if (bit ? subroot.r_is_leaf : subroot.l_is_leaf) {
+        Huff_Decoder_Emit(dec, table[child+bit].leaf);
+        node = HUFF_DECODE_ROOT;
+        break;
+      }
+      node = child+bit;
+    }
+    if (!bit_ct && words == end)
+      break;
+  }
+  dec->bits = bits;
+  dec->bit_ct = bit_ct;
+  dec->node = node;
+}
+
+HuffDecoder_t *Huff_Ctx_Decoder_Create(HuffCtx_t *ctx, HuffHeader_GBA_t header,
+    const HuffNode_GBA_t *table, int table_size, Huff_Byte_Sink_Cb_t sink,
+    void *sink_ctx) {
+  HuffDecoder_t *ret;
+  if (!(ret = Huff_Ctx_Alloc(ctx, sizeof(*ret)))) {
+    ctx->err = HUFF_ERROR_ALLOCATION_FAILED;
+    return NULL;
+  }
+  if (0 > Huff_Decoder_Init(ctx, ret, header, table, table_size)) {
+    Huff_Ctx_Free(ctx, ret);
+    return NULL;
+  }
+  ret->out = ret->buf;
+  ret->out_cap = sizeof(ret->buf);
+  ret->sink = sink;
+  ret->sink_ctx = sink_ctx;
+  return ret;
+}
+
+HuffDecoder_t *Huff_Decoder_Create(HuffHeader_GBA_t header,
+    const HuffNode_GBA_t *table, int table_size, Huff_Byte_Sink_Cb_t sink,
+    void *sink_ctx) {
+  return Huff_Ctx_Decoder_Create(Huff_Ctx_Default(), header, table,
+      table_size, sink, sink_ctx);
+}
+
+long Huff_Decoder_Finish(HuffDecoder_t *dec) {
+  if (dec->units_left) {
+    dec->ctx->err = HUFF_ERROR_DATA_TRUNCATED;
+    return -1;
+  }
+  if (dec->out_len && dec->sink)
+    dec->sink(dec->out, dec->out_len, dec->sink_ctx);
+  dec->out_total += dec->out_len;
+  dec->out_len = 0;
+  return dec->out_total;
+}
+
+void Huff_Decoder_Destroy(HuffDecoder_t *dec) {
+  if (!dec)
+    return;
+  Huff_Ctx_Free(dec->ctx, dec);
+}
+
+int Huff_Ctx_Decode(HuffCtx_t *ctx, HuffHeader_GBA_t header,
+    const HuffNode_GBA_t *table, int table_size, const uint32_t *bitstream,
+    int word_ct, void *dst) {
+  HuffDecoder_t *dec;
+  if (!bitstream || !dst) {
+    ctx->err = HUFF_ERROR_DATA_GIVEN_IS_NULL;
+    return -1;
+  }
+  // Same decoder, minus the sink: it writes straight into dst, which has
+  // room for everything.
+  if (!(dec = Huff_Ctx_Decoder_Create(ctx, header, table, table_size, NULL,
+          NULL)))
+    return -1;
+  dec->out = dst;
+  dec->out_cap = ((uint32_t)header.decomp_data_size)&HUFF_GBA_MAX_DECOMP_SIZE;
+  Huff_Decoder_Feed(dec, bitstream, word_ct);
+  int ret = (0 > Huff_Decoder_Finish(dec)) ? -1 : 0;
+  Huff_Decoder_Destroy(dec);
+  return ret;
+}
+
+int Huff_Decode(HuffHeader_GBA_t header, const HuffNode_GBA_t *table,
+    int table_size, const uint32_t *bitstream, int word_ct, void *dst) {
+  return Huff_Ctx_Decode(Huff_Ctx_Default(), header, table, table_size,
+      bitstream, word_ct, dst);
+}
+
+long Huff_Ctx_Decompress(HuffCtx_t *ctx, const void *src, size_t src_byte_ct,
+    void *dst) {
+  const byte *cursor = src;
+  HuffHeader_GBA_t header;
+  size_t table_size;
+  if (!src) {
+    ctx->err = HUFF_ERROR_DATA_GIVEN_IS_NULL;
+    return -1;
+  }
+  if (src_byte_ct < sizeof(header) + 4) {
+    ctx->err = HUFF_ERROR_DATA_TRUNCATED;
+    return -1;
+  }
+  memcpy(&header, cursor, sizeof(header));
+  cursor += sizeof(header);
+  // the tree size byte counts halfwords, minus one, same as the BIOS reads it
+  table_size = (cursor[0]+1)*2;
+  if (sizeof(header) + table_size > src_byte_ct) {
+    ctx->err = HUFF_ERROR_DATA_TRUNCATED;
+    return -1;
+  }
+  if (0 > Huff_Ctx_Decode(ctx, header, (const HuffNode_GBA_t*)cursor,
+        table_size, (const uint32_t*)(cursor + table_size),
+        (src_byte_ct - sizeof(header) - table_size)/4, dst))
+    return -1;
+  return ((uint32_t)header.decomp_data_size)&HUFF_GBA_MAX_DECOMP_SIZE;
+}
+
+long Huff_Decompress(const void *src, size_t src_byte_ct, void *dst) {
+  return Huff_Ctx_Decompress(Huff_Ctx_Default(), src, src_byte_ct, dst);
+}
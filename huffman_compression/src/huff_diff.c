@@ -0,0 +1,102 @@
+#include "huff_diff.h"
+#include "huff_errno.h"
+#include <string.h>
+
+long Huff_Ctx_Diff_Filter(HuffCtx_t *ctx, const void *data, size_t byte_ct,
+    int unit_bitlen, void *dst) {
+  byte *out = dst;
+  if (!data || !dst) {
+    ctx->err = HUFF_ERROR_DATA_GIVEN_IS_NULL;
+    return -1;
+  }
+  if (unit_bitlen != 8 && unit_bitlen != 16) {
+    ctx->err = HUFF_ERROR_UNSUPPORTED_FEATURE;
+    return -1;
+  }
+  if (!byte_ct) {
+    ctx->err = HUFF_ERROR_INPUT_TOO_SHORT;
+    return -1;
+  }
+  if (byte_ct > HUFF_GBA_MAX_DECOMP_SIZE) {
+    ctx->err = HUFF_ERROR_DATA_TOO_LARGE;
+    return -1;
+  }
+  if (unit_bitlen == 16 && (byte_ct&1)) {
+    ctx->err = HUFF_ERROR_DATA_NOT_WORD_ALIGNABLE;
+    return -1;
+  }
+  *out++ = HUFF_DIFF_GBA_COMPRESSION_TYPE_ID<<4 | unit_bitlen/8;
+  *out++ = byte_ct;
+  *out++ = byte_ct>>8;
+  *out++ = byte_ct>>16;
+  if (unit_bitlen == 8) {
+    const byte *in = data;
+    out[0] = in[0];
+    for (size_t i = 1; i < byte_ct; ++i)
+      out[i] = in[i] - in[i-1];
+  } else {
+    // halfwords are little-endian on the GBA, whatever the host is
+    const byte *in = data;
+    uint16_t prev = 0, cur, diff;
+    for (size_t i = 0; i < byte_ct; i += 2) {
+      cur = in[i] | in[i+1]<<8;
+      diff = cur - prev;
+      out[i] = diff;
+      out[i+1] = diff>>8;
+      prev = cur;
+    }
+  }
+  return byte_ct + HUFF_DIFF_HEADER_SIZE;
+}
+
+long Huff_Diff_Filter(const void *data, size_t byte_ct, int unit_bitlen,
+    void *dst) {
+  return Huff_Ctx_Diff_Filter(Huff_Ctx_Default(), data, byte_ct, unit_bitlen,
+      dst);
+}
+
+long Huff_Ctx_Diff_Unfilter(HuffCtx_t *ctx, const void *src,
+    size_t src_byte_ct, void *dst) {
+  const byte *in = src;
+  byte *out = dst;
+  uint32_t size;
+  int unit_bitlen;
+  if (!src || !dst) {
+    ctx->err = HUFF_ERROR_DATA_GIVEN_IS_NULL;
+    return -1;
+  }
+  if (src_byte_ct < HUFF_DIFF_HEADER_SIZE) {
+    ctx->err = HUFF_ERROR_DATA_TRUNCATED;
+    return -1;
+  }
+  unit_bitlen = (in[0]&15)*8;
+  if (in[0]>>4 != HUFF_DIFF_GBA_COMPRESSION_TYPE_ID
+      || (unit_bitlen != 8 && unit_bitlen != 16)) {
+    ctx->err = HUFF_ERROR_BAD_HEADER;
+    return -1;
+  }
+  size = in[1] | in[2]<<8 | in[3]<<16;
+  in += HUFF_DIFF_HEADER_SIZE;
+  if (src_byte_ct - HUFF_DIFF_HEADER_SIZE < size) {
+    ctx->err = HUFF_ERROR_DATA_TRUNCATED;
+    return -1;
+  }
+  if (unit_bitlen == 8) {
+    byte acc = 0;
+    for (uint32_t i = 0; i < size; ++i)
+      out[i] = acc += in[i];
+  } else {
+    uint16_t acc = 0;
+    // the BIOS works a halfword at a time, so a trailing odd byte is dropped
+    for (uint32_t i = 0; i+1 < size; i += 2) {
+      acc += in[i] | in[i+1]<<8;
+      out[i] = acc;
+      out[i+1] = acc>>8;
+    }
+  }
+  return size;
+}
+
+long Huff_Diff_Unfilter(const void *src, size_t src_byte_ct, void *dst) {
+  return Huff_Ctx_Diff_Unfilter(Huff_Ctx_Default(), src, src_byte_ct, dst);
+}
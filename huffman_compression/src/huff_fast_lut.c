@@ -0,0 +1,79 @@
+#include "huff_fast_lut.h"
+#include "huff_errno.h"
+
+// Table index of the root; it's where every code starts
+#define HUFF_FAST_LUT_ROOT 1
+
+/**
+ * @summary Fill in every entry under the subroot at table index at, whose
+ * code so far is prefix, depth bits long.
+ * */
+static void Huff_Fast_Lut_Fill(uint16_t *lut, int lut_bits,
+    const HuffNode_GBA_t *table, int at, uint32_t prefix, int depth) {
+  const HuffSubroot_GBA_t subroot = table[at].subroot;
+  const int child = (at&~1) + 2*subroot.descendants_ofs + 2, len = depth+1;
+  for (int side = 0; side < 2; ++side) {
+    const uint32_t code = (prefix<<1)|side;
+    if (side ? subroot.r_is_leaf : subroot.l_is_leaf) {
+      const int shift = lut_bits - len;
+      const uint16_t ent = (len<<HUFF_FAST_LUT_LEN_SHIFT) | table[child+side].leaf;
+      for (uint32_t i = 0; i < (1U<<shift); ++i)
+        lut[(code<<shift)|i] = ent;
+    } else if (len == lut_bits) {
+      lut[code] = child+side;
+    } else {
+      Huff_Fast_Lut_Fill(lut, lut_bits, table, child+side, code, len);
+    }
+  }
+}
+
+uint16_t *Huff_Ctx_Fast_Lut_Create(HuffCtx_t *ctx,
+    const HuffNode_GBA_t *table, int table_size, DataSize_e data_unit_bitlen,
+    int lut_bits) {
+  uint16_t *ret;
+  if (!table) {
+    ctx->err = HUFF_ERROR_NO_TREE_SUPPLIED;
+    return NULL;
+  }
+  if (lut_bits < HUFF_FAST_LUT_MIN_BITS || lut_bits > HUFF_FAST_LUT_MAX_BITS) {
+    ctx->err = HUFF_ERROR_UNSUPPORTED_FEATURE;
+    return NULL;
+  }
+  // walking the table is only safe once it's known to be a sound tree
+  if (0 > Huff_Ctx_GBA_Huff_Table_Verify(ctx, table, table_size,
+        data_unit_bitlen))
+    return NULL;
+  if (!(ret = Huff_Ctx_Alloc(ctx, sizeof(*ret)<<lut_bits))) {
+    ctx->err = HUFF_ERROR_ALLOCATION_FAILED;
+    return NULL;
+  }
+  Huff_Fast_Lut_Fill(ret, lut_bits, table, HUFF_FAST_LUT_ROOT, 0, 0);
+  return ret;
+}
+
+uint16_t *Huff_Fast_Lut_Create(const HuffNode_GBA_t *table, int table_size,
+    DataSize_e data_unit_bitlen, int lut_bits) {
+  return Huff_Ctx_Fast_Lut_Create(Huff_Ctx_Default(), table, table_size,
+      data_unit_bitlen, lut_bits);
+}
+
+/// Table reads spent decoding every unit under node, at depth bits deep
+static uint64_t Huff_Fast_Lut_Reads(const HuffNode_t *node, int depth,
+    int lut_bits) {
+  if (HUFF_NODE_IS_LEAF(node)) {
+    // the BIOS reads every subroot on the way down, then the leaf
+    if (!lut_bits)
+      return (uint64_t)node->freq * (depth+1);
+    return (uint64_t)node->freq 
+      * (1 + (depth > lut_bits ? depth - lut_bits + 1 : 0));
+  }
+  return Huff_Fast_Lut_Reads(node->l, depth+1, lut_bits)
+    + Huff_Fast_Lut_Reads(node->r, depth+1, lut_bits);
+}
+
+double Huff_Fast_Lut_Reads_Per_Unit(const HuffTree_t *tree, int lut_bits) {
+  if (!tree || !tree->root->freq)
+    return 0.0;
+  return (double)Huff_Fast_Lut_Reads(tree->root, 0, lut_bits)
+    / tree->root->freq;
+}
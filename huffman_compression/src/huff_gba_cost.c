@@ -0,0 +1,102 @@
+#include "huff_gba_cost.h"
+#include <strings.h>
+
+typedef struct s_huff_gba_region_timing {
+  const char *name;
+  int access16;  /// Cycles for one nonsequential 8 or 16-bit read
+  int access32;  /// Cycles for one nonsequential 32-bit read
+} HuffGBARegionTiming_t;
+
+/* 16-bit buses take a 32-bit read as a nonsequential access followed by a
+ * sequential one. */
+static const HuffGBARegionTiming_t huff_gba_region_timings[E_HUFF_GBA_REGION_CT] = {
+  [E_HUFF_GBA_REGION_ROM] = { .name = "rom", .access16 = 1+3, .access32 = (1+3)+(1+1) },
+  [E_HUFF_GBA_REGION_EWRAM] = { .name = "ewram", .access16 = 1+2, .access32 = (1+2)+(1+2) },
+  [E_HUFF_GBA_REGION_IWRAM] = { .name = "iwram", .access16 = 1, .access32 = 1 }
+};
+
+void Huff_GBA_Decode_Cost_Estimate(HuffGBADecodeCost_t *dst,
+    const HuffTree_t *tree, HuffGBARegion_e src_region) {
+  const HuffGBARegionTiming_t *timing = &huff_gba_region_timings[src_region];
+  const uint64_t unit_ct = tree->root->freq,
+        in_word_ct = Huff_Tree_Encoded_Word_Ct(tree),
+        out_word_ct = unit_ct*tree->data_unit_bitlen/32;
+  // Loads are a code fetch, the data access, then an internal cycle
+  const int node_read = 1 + timing->access16 + 1,
+        word_read = 1 + timing->access32 + 1;
+
+  dst->src_region = src_region;
+  dst->bits_walked = tree->bit_ct;
+  dst->read_cycles = tree->bit_ct*node_read + in_word_ct*word_read;
+  dst->cycles = HUFF_GBA_COST_SETUP_CYCLES + dst->read_cycles
+    + tree->bit_ct*HUFF_GBA_COST_BIT_CYCLES
+    + unit_ct*HUFF_GBA_COST_UNIT_CYCLES
+    + out_word_ct*HUFF_GBA_COST_OUT_WORD_CYCLES;
+  dst->worst_unit_cycles = tree->root->height
+    * (HUFF_GBA_COST_BIT_CYCLES + node_read) + HUFF_GBA_COST_UNIT_CYCLES;
+}
+
+void Huff_GBA_LZ77_Decode_Cost_Estimate(HuffGBADecodeCost_t *dst,
+    const HuffLZ77Stats_t *stats, HuffGBARegion_e src_region) {
+  const HuffGBARegionTiming_t *timing = &huff_gba_region_timings[src_region];
+  const uint64_t flag_ct = (stats->literal_ct + stats->match_ct + 7)/8;
+  const int byte_read = 1 + timing->access16 + 1;
+
+  dst->src_region = src_region;
+  dst->bits_walked = 0;
+  dst->read_cycles = (flag_ct + stats->literal_ct + 2ULL*stats->match_ct)
+    * byte_read;
+  dst->cycles = HUFF_GBA_COST_SETUP_CYCLES + dst->read_cycles
+    + flag_ct*HUFF_GBA_COST_LZ77_FLAG_CYCLES
+    + (uint64_t)stats->literal_ct*HUFF_GBA_COST_LZ77_LITERAL_CYCLES
+    + (uint64_t)stats->match_ct*HUFF_GBA_COST_LZ77_MATCH_CYCLES
+    + (uint64_t)stats->matched_byte_ct*HUFF_GBA_COST_LZ77_COPY_CYCLES;
+  dst->worst_unit_cycles = 2*byte_read + HUFF_GBA_COST_LZ77_MATCH_CYCLES
+    + HUFF_LZ77_MAX_MATCH*HUFF_GBA_COST_LZ77_COPY_CYCLES;
+}
+
+void Huff_GBA_RLE_Decode_Cost_Estimate(HuffGBADecodeCost_t *dst,
+    const HuffRLEStats_t *stats, HuffGBARegion_e src_region) {
+  const HuffGBARegionTiming_t *timing = &huff_gba_region_timings[src_region];
+  const uint64_t block_ct = stats->run_ct + stats->literal_block_ct;
+  const int byte_read = 1 + timing->access16 + 1;
+
+  dst->src_region = src_region;
+  dst->bits_walked = 0;
+  // every block's flag, every run's byte, and every literal
+  dst->read_cycles = (block_ct + stats->run_ct + stats->literal_byte_ct)
+    * byte_read;
+  dst->cycles = HUFF_GBA_COST_SETUP_CYCLES + dst->read_cycles
+    + block_ct*HUFF_GBA_COST_RLE_BLOCK_CYCLES
+    + (uint64_t)stats->run_byte_ct*HUFF_GBA_COST_RLE_RUN_BYTE_CYCLES
+    + (uint64_t)stats->literal_byte_ct*HUFF_GBA_COST_RLE_LITERAL_CYCLES;
+  dst->worst_unit_cycles = 2*byte_read + HUFF_GBA_COST_RLE_BLOCK_CYCLES
+    + HUFF_RLE_MAX_RUN*HUFF_GBA_COST_RLE_RUN_BYTE_CYCLES;
+}
+
+void Huff_GBA_Diff_Decode_Cost_Estimate(HuffGBADecodeCost_t *dst,
+    uint32_t byte_ct, int unit_bitlen, HuffGBARegion_e src_region) {
+  const HuffGBARegionTiming_t *timing = &huff_gba_region_timings[src_region];
+  const uint64_t unit_ct = byte_ct/(unit_bitlen/8);
+  const int unit_read = 1 + timing->access16 + 1;
+
+  dst->src_region = src_region;
+  dst->bits_walked = 0;
+  dst->read_cycles = unit_ct*unit_read;
+  dst->cycles = HUFF_GBA_COST_SETUP_CYCLES + dst->read_cycles 
+    + unit_ct*HUFF_GBA_COST_DIFF_UNIT_CYCLES;
+  dst->worst_unit_cycles = unit_read + HUFF_GBA_COST_DIFF_UNIT_CYCLES;
+}
+
+const char *Huff_GBA_Region_Name(HuffGBARegion_e region) {
+  if ((unsigned)region >= E_HUFF_GBA_REGION_CT)
+    return "[N/A]";
+  return huff_gba_region_timings[region].name;
+}
+
+int Huff_GBA_Region_From_Name(const char *name) {
+  for (int i = 0; i < E_HUFF_GBA_REGION_CT; ++i)
+    if (!strcasecmp(name, huff_gba_region_timings[i].name))
+      return i;
+  return -1;
+}
@@ -0,0 +1,103 @@
+#include "huff_gba_layout.h"
+#include <string.h>
+
+typedef struct s_huff_gba_pending {
+  const HuffNode_t *node;
+  int deadline;  /// Last slot its children can go in
+} HuffGBAPending_t;
+
+static int Huff_GBA_Subroot_Ct(const HuffNode_t *node, int *subroot_cts) {
+  if (HUFF_NODE_IS_LEAF(node))
+    return 0;
+  return subroot_cts[node->id] = 1 + Huff_GBA_Subroot_Ct(node->l, subroot_cts)
+    + Huff_GBA_Subroot_Ct(node->r, subroot_cts);
+}
+
+/* Subroots only ever join the pending list at the slot after everything
+ * already on it, so the list is always sorted by deadline. Placing them in
+ * that order from slot on is the best any order could do, and it only works
+ * if the i-th one's deadline is at least slot+i.
+ * skip is left out, as if it had just been placed; -1 to skip nothing. */
+static _Bool Huff_GBA_Pending_Fits(const HuffGBAPending_t *pending, int ct,
+    int skip, int slot) {
+  for (int i = 0; i < ct; ++i) {
+    if (i == skip)
+      continue;
+    if (pending[i].deadline < slot++)
+      return 0;
+  }
+  return 1;
+}
+
+/// Index of the pending subroot the decoder passes through most often
+static int Huff_GBA_Pending_Hottest(const HuffGBAPending_t *pending, int ct) {
+  int ret = 0;
+  for (int i = 1; i < ct; ++i)
+    if (pending[i].node->freq > pending[ret].node->freq)
+      ret = i;
+  return ret;
+}
+
+static int Huff_GBA_Layout_Plan_From(HuffGBALayout_t *dst, 
+    const HuffNode_t *root, const int *subroot_cts, int hot_slot_ct) {
+  HuffGBAPending_t pending[HUFF_GBA_LAYOUT_MAX_SLOTS];
+  int pending_ct = 0, pick;
+
+  // the root sits in slot 0, right after the table size byte
+  pending[pending_ct++] = (HuffGBAPending_t) {
+    .node = root, .deadline = HUFF_GBA_LAYOUT_MAX_SLOT_DIST
+  };
+  dst->owners[0] = NULL;
+  dst->slot_ct = 1;
+  while (pending_ct) {
+    int slot = dst->slot_ct;
+    // Hottest first while still in the hot span, depth-first after that,
+    // unless leaving the rest for later would strand one of them.
+    pick = (slot < hot_slot_ct) 
+      ? Huff_GBA_Pending_Hottest(pending, pending_ct) : pending_ct-1;
+    if (!Huff_GBA_Pending_Fits(pending, pending_ct, pick, slot+1)) {
+      if (!Huff_GBA_Pending_Fits(pending, pending_ct, -1, slot))
+        return -1;
+      pick = 0;
+    }
+
+    const HuffNode_t *cur = pending[pick].node, *first, *second;
+    memmove(&pending[pick], &pending[pick+1],
+        sizeof(*pending)*(pending_ct - pick - 1));
+    --pending_ct;
+    dst->owners[dst->slot_ct++] = cur;
+
+    // Push the bigger subtree first, so the smaller one gets finished off
+    // before its sibling has been waiting long.
+    first = cur->l, second = cur->r;
+    if (!HUFF_NODE_IS_LEAF(first) && !HUFF_NODE_IS_LEAF(second)
+        && subroot_cts[first->id] < subroot_cts[second->id]) {
+      first = cur->r, second = cur->l;
+    }
+    if (!HUFF_NODE_IS_LEAF(first))
+      pending[pending_ct++] = (HuffGBAPending_t) {
+        .node = first, .deadline = slot + HUFF_GBA_LAYOUT_MAX_SLOT_DIST
+      };
+    if (!HUFF_NODE_IS_LEAF(second))
+      pending[pending_ct++] = (HuffGBAPending_t) {
+        .node = second, .deadline = slot + HUFF_GBA_LAYOUT_MAX_SLOT_DIST
+      };
+  }
+  return 0;
+}
+
+int Huff_GBA_Layout_Plan(HuffGBALayout_t *dst, const HuffNode_t *root,
+    int node_ct) {
+  if (!root || HUFF_NODE_IS_LEAF(root) || node_ct > 2*HUFF_GBA_LAYOUT_MAX_SLOTS)
+    return -1;
+  int subroot_cts[node_ct];
+  if (Huff_GBA_Subroot_Ct(root, subroot_cts) >= HUFF_GBA_LAYOUT_MAX_SLOTS)
+    return -1;
+  // Filling the hot span breadth-first leaves more subroots waiting once 
+  // it's full, which can be what keeps a big tree from fitting. Fitting at 
+  // all matters more.
+  if (0 <= Huff_GBA_Layout_Plan_From(dst, root, subroot_cts, 
+        HUFF_GBA_LAYOUT_HOT_SLOT_CT))
+    return 0;
+  return Huff_GBA_Layout_Plan_From(dst, root, subroot_cts, 0);
+}
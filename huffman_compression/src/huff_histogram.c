@@ -0,0 +1,147 @@
+#include "huff_histogram.h"
+#include "batch.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define HUFF_HISTOGRAM_TABLE_CT 4
+// Below this, zeroing and summing the interleaved tables costs more than it saves
+#define HUFF_HISTOGRAM_SMALL_LEN 256
+// Smallest slice worth handing a thread of its own
+#define HUFF_HISTOGRAM_MIN_SLICE (256*1024)
+
+#define COUNT_WORD(tables, w) do { \
+    ++tables[0][(w)&0xFF]; \
+    ++tables[1][((w)>>8)&0xFF]; \
+    ++tables[2][((w)>>16)&0xFF]; \
+    ++tables[3][((w)>>24)&0xFF]; \
+    ++tables[0][((w)>>32)&0xFF]; \
+    ++tables[1][((w)>>40)&0xFF]; \
+    ++tables[2][((w)>>48)&0xFF]; \
+    ++tables[3][(w)>>56]; \
+  } while (0)
+
+void Huff_Histogram_Add_Bytes(uint32_t counts[256], const void *data, 
+    size_t byte_ct) {
+  const byte *cursor = data, *end = cursor + byte_ct;
+  if (byte_ct < HUFF_HISTOGRAM_SMALL_LEN) {
+    while (cursor != end)
+      ++counts[*cursor++];
+    return;
+  }
+
+  // Consecutive bytes land in different tables, so a run of one value 
+  // increments 4 independent counters in turn instead of 1 counter whose 
+  // every increment has to wait on the last one's store.
+  uint32_t tables[HUFF_HISTOGRAM_TABLE_CT][256];
+  uint64_t w0, w1;
+  memset(tables, 0, sizeof(tables));
+  for (; end - cursor >= 16; cursor += 16) {
+    // memcpy, since data has no alignment guarantee. Compiles to plain loads.
+    memcpy(&w0, cursor, sizeof(w0));
+    memcpy(&w1, cursor+8, sizeof(w1));
+    COUNT_WORD(tables, w0);
+    COUNT_WORD(tables, w1);
+  }
+  while (cursor != end)
+    ++tables[0][*cursor++];
+  for (int i = 0; i < 256; ++i)
+    counts[i] += tables[0][i] + tables[1][i] + tables[2][i] + tables[3][i];
+}
+
+void Huff_Histogram_Fold(int *freq, const uint32_t counts[256], 
+    DataSize_e data_unit_bitlen) {
+  if (data_unit_bitlen == E_DATA_UNIT_4_BITS) {
+    // every byte value holds one of each nibble, so a byte's count goes to
+    // both of them. Skips splitting each byte apart during the count itself.
+    int lo[16] = {0}, hi[16] = {0};
+    for (int i = 0; i < 256; ++i) {
+      lo[i&15] += counts[i];
+      hi[i>>4] += counts[i];
+    }
+    for (int i = 0; i < 16; ++i)
+      freq[i] += lo[i] + hi[i];
+    return;
+  }
+  for (int i = 0; i < 256; ++i)
+    freq[i] += counts[i];
+}
+
+void Huff_Histogram_Add(int *freq, const void *data, int byte_ct, 
+    DataSize_e data_unit_bitlen) {
+  uint32_t counts[256] = {0};
+  if (byte_ct <= 0)
+    return;
+  Huff_Histogram_Add_Bytes(counts, data, byte_ct);
+  Huff_Histogram_Fold(freq, counts, data_unit_bitlen);
+}
+
+double Huff_Histogram_Entropy(const uint32_t counts[256]) {
+  uint64_t total = 0;
+  double ret = 0.0;
+  for (int i = 0; i < 256; ++i)
+    total += counts[i];
+  if (!total)
+    return 0.0;
+  for (int i = 0; i < 256; ++i) {
+    if (!counts[i])
+      continue;
+    const double p = (double)counts[i]/total;
+    ret -= p*log2(p);
+  }
+  return ret;
+}
+
+void Huff_Histogram_Merge(int *dst, const int *src, int unit_ct) {
+  for (int i = 0; i < unit_ct; ++i)
+    dst[i] += src[i];
+}
+
+typedef struct s_huff_histogram_slice {
+  const byte *data;
+  size_t byte_ct;
+  uint32_t counts[256];
+} HuffHistogramSlice_t;
+
+static int Huff_Histogram_Slice_Cb(HuffCtx_t *ctx, void *job) {
+  HuffHistogramSlice_t *slice = job;
+  (void)ctx;
+  Huff_Histogram_Add_Bytes(slice->counts, slice->data, slice->byte_ct);
+  return 0;
+}
+
+void Huff_Histogram_Add_Parallel(int *freq, const void *data, int byte_ct, 
+    DataSize_e data_unit_bitlen, int thread_ct) {
+  int slice_ct;
+  if (byte_ct <= 0)
+    return;
+  if (thread_ct <= 0)
+    thread_ct = Batch_Default_Thread_Ct();
+  slice_ct = byte_ct/HUFF_HISTOGRAM_MIN_SLICE;
+  if (slice_ct > thread_ct)
+    slice_ct = thread_ct;
+  if (slice_ct < 2) {
+    Huff_Histogram_Add(freq, data, byte_ct, data_unit_bitlen);
+    return;
+  }
+
+  HuffHistogramSlice_t *slices = malloc(sizeof(*slices)*slice_ct);
+  uint32_t counts[256] = {0};
+  size_t slice_len = byte_ct/slice_ct;
+  if (!slices) {
+    Huff_Histogram_Add(freq, data, byte_ct, data_unit_bitlen);
+    return;
+  }
+  for (int i = 0; i < slice_ct; ++i) {
+    slices[i].data = (const byte*)data + i*slice_len;
+    slices[i].byte_ct = (i == slice_ct-1) ? byte_ct - i*slice_len : slice_len;
+    memset(slices[i].counts, 0, sizeof(slices[i].counts));
+  }
+  Batch_Run(slices, sizeof(*slices), slice_ct, thread_ct, 
+      Huff_Histogram_Slice_Cb);
+  for (int i = 0; i < slice_ct; ++i)
+    for (int j = 0; j < 256; ++j)
+      counts[j] += slices[i].counts[j];
+  free(slices);
+  Huff_Histogram_Fold(freq, counts, data_unit_bitlen);
+}
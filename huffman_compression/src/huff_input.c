@@ -0,0 +1,99 @@
+#include "huff_input.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define WORD_ALIGN_UP(n) (((n) + 3UL) & ~3UL)
+#define HUFF_INPUT_READ_CHUNK 0x10000UL
+
+/* A mapping past EOF reads as zeros up to the end of the last page, and 
+ * since pages are word multiples, the word-alignment padding is always 
+ * in there. Mapping the padded length covers it without a copy. */
+static int Huff_Input_Map(HuffInput_t *dst, int fd, size_t byte_ct) {
+  size_t map_len = WORD_ALIGN_UP(byte_ct);
+  void *map = mmap(NULL, map_len, PROT_READ, MAP_PRIVATE, fd, 0);
+  if (map == MAP_FAILED)
+    return -1;
+  madvise(map, map_len, MADV_SEQUENTIAL);
+  *dst = (HuffInput_t) {
+    .data = map,
+    .byte_ct = byte_ct,
+    .padded_byte_ct = map_len,
+    .map_len = map_len
+  };
+  return 0;
+}
+
+static int Huff_Input_Read(HuffInput_t *dst, int fd, size_t size_hint) {
+  size_t cap = WORD_ALIGN_UP(size_hint ? size_hint : HUFF_INPUT_READ_CHUNK),
+         len = 0;
+  uint8_t *buf = malloc(cap), *tmp;
+  ssize_t readlen;
+  if (!buf)
+    return -1;
+  for (;;) {
+    // always leave room for the word padding
+    if (cap - len < 4) {
+      if (!(tmp = realloc(buf, cap *= 2))) {
+        free(buf);
+        return -1;
+      }
+      buf = tmp;
+    }
+    readlen = read(fd, buf + len, cap - len - 3);
+    if (readlen < 0) {
+      if (errno == EINTR)
+        continue;
+      free(buf);
+      return -1;
+    }
+    if (!readlen)
+      break;
+    len += readlen;
+  }
+  memset(buf + len, 0, WORD_ALIGN_UP(len) - len);
+  *dst = (HuffInput_t) {
+    .data = buf,
+    .byte_ct = len,
+    .padded_byte_ct = WORD_ALIGN_UP(len),
+    .map_len = 0
+  };
+  return 0;
+}
+
+int Huff_Input_Load(HuffInput_t *dst, const char *path, _Bool map_ok) {
+  struct stat st;
+  int fd, ret, errno_save;
+  if (0 > (fd = open(path, O_RDONLY)))
+    return -1;
+  if (0 > fstat(fd, &st)) {
+    errno_save = errno;
+    close(fd);
+    errno = errno_save;
+    return -1;
+  }
+  ret = -1;
+  if (map_ok && S_ISREG(st.st_mode) && st.st_size > 0)
+    ret = Huff_Input_Map(dst, fd, st.st_size);
+  if (ret < 0)
+    ret = Huff_Input_Read(dst, fd, S_ISREG(st.st_mode) ? st.st_size + 4 : 0);
+  errno_save = errno;
+  close(fd);
+  errno = errno_save;
+  return ret;
+}
+
+void Huff_Input_Release(HuffInput_t *input) {
+  if (!input || !input->data)
+    return;
+  if (input->map_len)
+    munmap((void*)input->data, input->map_len);
+  else
+    free((void*)input->data);
+  input->data = NULL;
+}
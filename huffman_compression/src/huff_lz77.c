@@ -0,0 +1,291 @@
+#include "huff_lz77.h"
+#include "huff_errno.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define HUFF_LZ77_HASH_BITS 15
+#define HUFF_LZ77_WINDOW_MASK (HUFF_LZ77_WINDOW_SIZE-1)
+/// Most chain links followed looking for a position's longest match
+#define HUFF_LZ77_CHAIN_DEPTH 256
+/// Huff_LZ77_Size_Bound only keeps one position per hash, so it can afford 
+/// enough of them for collisions within the window to be rare
+#define HUFF_LZ77_BOUND_HASH_BITS 20
+/// Output bits per literal and per back-reference, their flag bit included
+#define HUFF_LZ77_LITERAL_COST 9
+#define HUFF_LZ77_MATCH_COST 17
+
+static inline uint32_t Huff_LZ77_Hash_Bits(const byte *at, int bits) {
+  return (((uint32_t)at[0]<<16 | at[1]<<8 | at[2]) * 2654435761U) >> (32 - bits);
+}
+
+static inline uint32_t Huff_LZ77_Hash(const byte *at) {
+  return Huff_LZ77_Hash_Bits(at, HUFF_LZ77_HASH_BITS);
+}
+
+/**
+ * @summary Find the longest match within the window for every position,
+ * min_disp or more bytes back. Positions without one get a match_len of 0.
+ * @return 0 on success, -1 (see Huff_Strerror) on failure.
+ * */
+static int Huff_LZ77_Find_Matches(HuffCtx_t *ctx, const byte *data,
+    uint32_t byte_ct, uint32_t min_disp, uint8_t *match_len,
+    uint16_t *match_disp) {
+  // head: latest position per hash; prev: the position before it with the
+  // same hash, which only needs to reach back as far as the window does
+  int32_t *head = malloc(sizeof(*head)<<HUFF_LZ77_HASH_BITS),
+          *prev = malloc(sizeof(*prev)*HUFF_LZ77_WINDOW_SIZE);
+  if (!head || !prev) {
+    free(head);
+    free(prev);
+    ctx->err = HUFF_ERROR_ALLOCATION_FAILED;
+    return -1;
+  }
+  memset(head, 0xFF, sizeof(*head)<<HUFF_LZ77_HASH_BITS);
+
+  for (uint32_t pos = 0; pos < byte_ct; ++pos) {
+    const uint32_t max_len = (byte_ct - pos < HUFF_LZ77_MAX_MATCH)
+      ? byte_ct - pos : HUFF_LZ77_MAX_MATCH;
+    uint32_t best_len = HUFF_LZ77_MIN_MATCH-1, best_disp = 0;
+    if (max_len >= HUFF_LZ77_MIN_MATCH) {
+      const uint32_t h = Huff_LZ77_Hash(data+pos);
+      int32_t cand = head[h];
+      for (int depth = HUFF_LZ77_CHAIN_DEPTH; cand >= 0 && depth
+          && pos - cand <= HUFF_LZ77_WINDOW_SIZE;
+          --depth, cand = prev[cand&HUFF_LZ77_WINDOW_MASK]) {
+        const uint32_t disp = pos - cand;
+        uint32_t len = 0;
+        // can't beat best_len without matching the byte just past it
+        if (disp < min_disp || data[cand+best_len] != data[pos+best_len])
+          continue;
+        while (len < max_len && data[cand+len] == data[pos+len])
+          ++len;
+        if (len > best_len) {
+          best_len = len;
+          best_disp = disp;
+          if (len == max_len)
+            break;
+        }
+      }
+      prev[pos&HUFF_LZ77_WINDOW_MASK] = head[h];
+      head[h] = pos;
+    }
+    match_len[pos] = best_disp ? best_len : 0;
+    match_disp[pos] = best_disp;
+  }
+  free(head);
+  free(prev);
+  return 0;
+}
+
+/**
+ * @summary Pick the cheapest parse, back to front: every position either
+ * takes a literal, or any length of its longest match, since every shorter
+ * length is there at the same displacement. Every unit costs the same no
+ * matter its displacement or length, so this is the smallest output the
+ * matches found allow. match_len gets overwritten with the length picked at
+ * every position, 1 meaning a literal.
+ * @return 0 on success, -1 (see Huff_Strerror) on failure.
+ * */
+static int Huff_LZ77_Parse(HuffCtx_t *ctx, uint32_t byte_ct,
+    uint8_t *match_len) {
+  uint32_t *cost = malloc(sizeof(*cost)*(byte_ct+1));
+  if (!cost) {
+    ctx->err = HUFF_ERROR_ALLOCATION_FAILED;
+    return -1;
+  }
+  cost[byte_ct] = 0;
+  for (uint32_t pos = byte_ct; pos--; ) {
+    uint32_t best = HUFF_LZ77_LITERAL_COST + cost[pos+1], pick = 1;
+    // <=, so ties go to the longer match and the output has fewer units
+    for (uint32_t len = HUFF_LZ77_MIN_MATCH; len <= match_len[pos]; ++len) {
+      if (HUFF_LZ77_MATCH_COST + cost[pos+len] <= best) {
+        best = HUFF_LZ77_MATCH_COST + cost[pos+len];
+        pick = len;
+      }
+    }
+    cost[pos] = best;
+    match_len[pos] = pick;
+  }
+  free(cost);
+  return 0;
+}
+
+uint32_t *Huff_Ctx_LZ77_Compress(HuffCtx_t *ctx, const void *data,
+    size_t byte_ct, _Bool vram_safe, int *return_word_ct,
+    HuffLZ77Stats_t *return_stats) {
+  const byte *src = data;
+  HuffLZ77Stats_t stats = {0};
+  uint8_t *match_len;
+  uint16_t *match_disp;
+  uint32_t *ret;
+  byte *out;
+  if (!data) {
+    ctx->err = HUFF_ERROR_DATA_GIVEN_IS_NULL;
+    return NULL;
+  }
+  if (!byte_ct) {
+    ctx->err = HUFF_ERROR_INPUT_TOO_SHORT;
+    return NULL;
+  }
+  if (byte_ct > HUFF_GBA_MAX_DECOMP_SIZE) {
+    ctx->err = HUFF_ERROR_DATA_TOO_LARGE;
+    return NULL;
+  }
+  match_len = malloc(sizeof(*match_len)*byte_ct);
+  match_disp = malloc(sizeof(*match_disp)*byte_ct);
+  // worst case is all literals: a flag byte per 8, plus header and padding
+  ret = Huff_Ctx_Alloc(ctx, 4 + byte_ct + (byte_ct+7)/8 + 3);
+  if (!match_len || !match_disp || !ret) {
+    ctx->err = HUFF_ERROR_ALLOCATION_FAILED;
+    goto FAIL;
+  }
+  if (0 > Huff_LZ77_Find_Matches(ctx, src, byte_ct,
+        vram_safe ? HUFF_LZ77_VRAM_MIN_DISP : 1, match_len, match_disp))
+    goto FAIL;
+  if (0 > Huff_LZ77_Parse(ctx, byte_ct, match_len))
+    goto FAIL;
+
+  out = (byte*)ret;
+  *out++ = HUFF_LZ77_GBA_COMPRESSION_TYPE_ID<<4;
+  *out++ = byte_ct;
+  *out++ = byte_ct>>8;
+  *out++ = byte_ct>>16;
+  for (uint32_t pos = 0; pos < byte_ct; ) {
+    byte *flags = out++;
+    *flags = 0;
+    for (int unit = 0; unit < 8 && pos < byte_ct; ++unit) {
+      const uint32_t len = match_len[pos];
+      if (len == 1) {
+        *out++ = src[pos++];
+        ++stats.literal_ct;
+        continue;
+      }
+      const uint32_t ref = (len-HUFF_LZ77_MIN_MATCH)<<12 | (match_disp[pos]-1);
+      *flags |= 0x80>>unit;
+      *out++ = ref>>8;
+      *out++ = ref;
+      pos += len;
+      ++stats.match_ct;
+      stats.matched_byte_ct += len;
+    }
+  }
+  while ((uintptr_t)(out - (byte*)ret)&3)
+    *out++ = 0;
+  *return_word_ct = (out - (byte*)ret)/4;
+  if (return_stats)
+    *return_stats = stats;
+  free(match_len);
+  free(match_disp);
+  return ret;
+
+FAIL:
+  free(match_len);
+  free(match_disp);
+  Huff_Ctx_Free(ctx, ret);
+  return NULL;
+}
+
+uint32_t *Huff_LZ77_Compress(const void *data, size_t byte_ct, _Bool vram_safe,
+    int *return_word_ct, HuffLZ77Stats_t *return_stats) {
+  return Huff_Ctx_LZ77_Compress(Huff_Ctx_Default(), data, byte_ct, vram_safe,
+      return_word_ct, return_stats);
+}
+
+long Huff_Ctx_LZ77_Size_Bound(HuffCtx_t *ctx, const void *data, 
+    size_t byte_ct) {
+  const byte *src = data;
+  // Where the last possible back-reference's coverage ends. Hash collisions
+  // only make positions look matchable that aren't, which loosens the 
+  // bound but never breaks it.
+  uint32_t covered_end = 0, literal_ct = 0;
+  int32_t *head;
+  if (!data) {
+    ctx->err = HUFF_ERROR_DATA_GIVEN_IS_NULL;
+    return -1;
+  }
+  if (NULL == (head = malloc(sizeof(*head)<<HUFF_LZ77_BOUND_HASH_BITS))) {
+    ctx->err = HUFF_ERROR_ALLOCATION_FAILED;
+    return -1;
+  }
+  memset(head, 0xFF, sizeof(*head)<<HUFF_LZ77_BOUND_HASH_BITS);
+  for (uint32_t pos = 0; pos < byte_ct; ++pos) {
+    if (pos + HUFF_LZ77_MIN_MATCH <= byte_ct) {
+      const uint32_t h = Huff_LZ77_Hash_Bits(src+pos, HUFF_LZ77_BOUND_HASH_BITS);
+      if (head[h] >= 0 && pos - head[h] <= HUFF_LZ77_WINDOW_SIZE)
+        covered_end = pos + HUFF_LZ77_MAX_MATCH;
+      head[h] = pos;
+    }
+    if (pos >= covered_end)
+      ++literal_ct;
+  }
+  free(head);
+  // in eighths of a byte: 9 per literal, 17 per back-reference, which 
+  // covers at most HUFF_LZ77_MAX_MATCH bytes
+  const uint64_t eighths = (uint64_t)literal_ct*HUFF_LZ77_LITERAL_COST
+    + ((uint64_t)(byte_ct - literal_ct)*HUFF_LZ77_MATCH_COST 
+        + HUFF_LZ77_MAX_MATCH-1)/HUFF_LZ77_MAX_MATCH;
+  return (4 + (eighths+7)/8 + 3)&~3UL;
+}
+
+long Huff_LZ77_Size_Bound(const void *data, size_t byte_ct) {
+  return Huff_Ctx_LZ77_Size_Bound(Huff_Ctx_Default(), data, byte_ct);
+}
+
+long Huff_Ctx_LZ77_Decompress(HuffCtx_t *ctx, const void *src,
+    size_t src_byte_ct, void *dst, _Bool vram) {
+  const byte *in = src, *const in_end = in + src_byte_ct;
+  byte *out = dst;
+  uint32_t size, pos = 0;
+  if (!src || !dst) {
+    ctx->err = HUFF_ERROR_DATA_GIVEN_IS_NULL;
+    return -1;
+  }
+  if (src_byte_ct < 4) {
+    ctx->err = HUFF_ERROR_DATA_TRUNCATED;
+    return -1;
+  }
+  if (in[0]>>4 != HUFF_LZ77_GBA_COMPRESSION_TYPE_ID) {
+    ctx->err = HUFF_ERROR_BAD_HEADER;
+    return -1;
+  }
+  size = in[1] | in[2]<<8 | in[3]<<16;
+  in += 4;
+  while (pos < size) {
+    if (in == in_end) {
+      ctx->err = HUFF_ERROR_DATA_TRUNCATED;
+      return -1;
+    }
+    const byte flags = *in++;
+    for (int unit = 0; unit < 8 && pos < size; ++unit) {
+      if (!(flags & (0x80>>unit))) {
+        if (in == in_end) {
+          ctx->err = HUFF_ERROR_DATA_TRUNCATED;
+          return -1;
+        }
+        out[pos++] = *in++;
+        continue;
+      }
+      if (in_end - in < 2) {
+        ctx->err = HUFF_ERROR_DATA_TRUNCATED;
+        return -1;
+      }
+      const uint32_t len = (in[0]>>4) + HUFF_LZ77_MIN_MATCH,
+            disp = ((in[0]&15)<<8 | in[1]) + 1;
+      in += 2;
+      if (disp > pos || (vram && disp < HUFF_LZ77_VRAM_MIN_DISP)) {
+        ctx->err = HUFF_ERROR_BAD_BACKREF;
+        return -1;
+      }
+      // the BIOS stops as soon as it's written size bytes, even mid-copy
+      for (uint32_t i = 0; i < len && pos < size; ++i, ++pos)
+        out[pos] = out[pos-disp];
+    }
+  }
+  return size;
+}
+
+long Huff_LZ77_Decompress(const void *src, size_t src_byte_ct, void *dst,
+    _Bool vram) {
+  return Huff_Ctx_LZ77_Decompress(Huff_Ctx_Default(), src, src_byte_ct, dst,
+      vram);
+}
@@ -0,0 +1,274 @@
+#include "huff_pipeline.h"
+#include "huff_errno.h"
+#include "huff_histogram.h"
+#include "huff_lz77.h"
+#include "huff_rle.h"
+#include "huff_diff.h"
+#include "huff_decode.h"
+#include <stdlib.h>
+#include <string.h>
+
+static const char *const huff_stage_names[E_HUFF_STAGE_CT] = {
+  [E_HUFF_STAGE_DIFF8] = "diff8",
+  [E_HUFF_STAGE_DIFF16] = "diff16",
+  [E_HUFF_STAGE_LZ77] = "lz77",
+  [E_HUFF_STAGE_LZ77_VRAM] = "lz77",
+  [E_HUFF_STAGE_RLE] = "rle",
+  [E_HUFF_STAGE_HUFF4] = "huff4",
+  [E_HUFF_STAGE_HUFF8] = "huff8"
+};
+
+static const char *const huff_stage_svc_names[E_HUFF_STAGE_CT] = {
+  [E_HUFF_STAGE_DIFF8] = "SVC 0x16/0x17",
+  [E_HUFF_STAGE_DIFF16] = "SVC 0x18",
+  [E_HUFF_STAGE_LZ77] = "SVC 0x11",
+  [E_HUFF_STAGE_LZ77_VRAM] = "SVC 0x11/0x12",
+  [E_HUFF_STAGE_RLE] = "SVC 0x14/0x15",
+  [E_HUFF_STAGE_HUFF4] = "SVC 0x13",
+  [E_HUFF_STAGE_HUFF8] = "SVC 0x13"
+};
+
+const char *Huff_Stage_Name(HuffStage_e stage) {
+  return (unsigned)stage < E_HUFF_STAGE_CT ? huff_stage_names[stage] : "?";
+}
+
+const char *Huff_Stage_SVC_Name(HuffStage_e stage) {
+  return (unsigned)stage < E_HUFF_STAGE_CT ? huff_stage_svc_names[stage] : "?";
+}
+
+int Huff_Stage_Compression_Type(HuffStage_e stage) {
+  switch (stage) {
+    case E_HUFF_STAGE_DIFF8:
+    case E_HUFF_STAGE_DIFF16:
+      return HUFF_DIFF_GBA_COMPRESSION_TYPE_ID;
+    case E_HUFF_STAGE_LZ77:
+    case E_HUFF_STAGE_LZ77_VRAM:
+      return HUFF_LZ77_GBA_COMPRESSION_TYPE_ID;
+    case E_HUFF_STAGE_RLE:
+      return HUFF_RLE_GBA_COMPRESSION_TYPE_ID;
+    default:
+      return HUFF_HEADER_GBA_COMPRESSION_TYPE_ID;
+  }
+}
+
+/**
+ * @summary Huffman-compress data into one array the way SVC 0x13 takes it:
+ * header, tree table (tree size byte included), then the bitstream.
+ * */
+static uint32_t *Huff_Pipeline_Huffman(HuffCtx_t *ctx, const void *data,
+    size_t byte_ct, DataSize_e bitdepth, HuffGBARegion_e src_region,
+    int *return_word_ct, HuffGBADecodeCost_t *cost) {
+  HuffHeader_GBA_t header;
+  HuffTree_t *tree;
+  HuffNode_GBA_t *table = NULL;
+  uint32_t *bits = NULL, *ret = NULL;
+  int freq[256] = {0}, bit_word_ct = 0, table_size = 0;
+  if (byte_ct&3) {
+    ctx->err = HUFF_ERROR_DATA_NOT_WORD_ALIGNABLE;
+    return NULL;
+  }
+  if (byte_ct > HUFF_GBA_MAX_DECOMP_SIZE) {
+    ctx->err = HUFF_ERROR_DATA_TOO_LARGE;
+    return NULL;
+  }
+  Huff_Histogram_Add(freq, data, byte_ct, bitdepth);
+  if (NULL == (tree = Huff_Ctx_Tree_Create_From_Histogram(ctx, freq, bitdepth)))
+    return NULL;
+  if (NULL == (bits = Huff_Ctx_Compress(ctx, data, tree, byte_ct/4,
+          &bit_word_ct)))
+    goto CLEANUP;
+  if (0 > Huff_Ctx_GBA_Header_Init(ctx, &header, byte_ct, bitdepth))
+    goto CLEANUP;
+  if (NULL == (table = Huff_Ctx_GBA_Huff_Table_Create(ctx, tree, &table_size)))
+    goto CLEANUP;
+  *return_word_ct = (sizeof(header) + table_size)/4 + bit_word_ct;
+  if (NULL == (ret = Huff_Ctx_Alloc(ctx, *return_word_ct*4))) {
+    ctx->err = HUFF_ERROR_ALLOCATION_FAILED;
+    goto CLEANUP;
+  }
+  memcpy(ret, &header, sizeof(header));
+  memcpy((byte*)ret + sizeof(header), table, table_size);
+  memcpy((byte*)ret + sizeof(header) + table_size, bits, bit_word_ct*4);
+  Huff_GBA_Decode_Cost_Estimate(cost, tree, src_region);
+CLEANUP:
+  Huff_Tree_Destroy(tree);
+  Huff_Ctx_Free(ctx, bits);
+  Huff_Ctx_Free(ctx, table);
+  return ret;
+}
+
+/// Same, for the difference filter, which only pads its stream out to words
+static uint32_t *Huff_Pipeline_Diff(HuffCtx_t *ctx, const void *data,
+    size_t byte_ct, int unit_bitlen, HuffGBARegion_e src_region,
+    int *return_word_ct, HuffGBADecodeCost_t *cost) {
+  const size_t stream_size = byte_ct + HUFF_DIFF_HEADER_SIZE;
+  uint32_t *ret;
+  *return_word_ct = (stream_size + 3)/4;
+  if (NULL == (ret = Huff_Ctx_Alloc(ctx, *return_word_ct*4))) {
+    ctx->err = HUFF_ERROR_ALLOCATION_FAILED;
+    return NULL;
+  }
+  ret[*return_word_ct-1] = 0;
+  if (0 > Huff_Ctx_Diff_Filter(ctx, data, byte_ct, unit_bitlen, ret)) {
+    Huff_Ctx_Free(ctx, ret);
+    return NULL;
+  }
+  Huff_GBA_Diff_Decode_Cost_Estimate(cost, byte_ct, unit_bitlen, src_region);
+  return ret;
+}
+
+uint32_t *Huff_Ctx_Pipeline_Compress(HuffCtx_t *ctx, const void *data,
+    size_t byte_ct, const HuffStage_e *stages, int stage_ct,
+    HuffGBARegion_e src_region, int *return_word_ct,
+    HuffPipelineStageInfo_t *return_info) {
+  const void *in = data;
+  uint32_t *out = NULL;
+  int word_ct = 0;
+  if (!data || !stages) {
+    ctx->err = HUFF_ERROR_DATA_GIVEN_IS_NULL;
+    return NULL;
+  }
+  if (stage_ct < 1 || stage_ct > HUFF_PIPELINE_MAX_STAGES) {
+    ctx->err = HUFF_ERROR_UNSUPPORTED_FEATURE;
+    return NULL;
+  }
+  for (int i = 0; i < stage_ct; ++i) {
+    // every stage's output but the last gets decoded into a staging buffer
+    const HuffGBARegion_e region = i+1 < stage_ct
+      ? E_HUFF_GBA_REGION_EWRAM : src_region;
+    HuffGBADecodeCost_t cost;
+    HuffLZ77Stats_t lz77_stats;
+    HuffRLEStats_t rle_stats;
+    switch (stages[i]) {
+      case E_HUFF_STAGE_DIFF8:
+      case E_HUFF_STAGE_DIFF16:
+        out = Huff_Pipeline_Diff(ctx, in, byte_ct,
+            stages[i] == E_HUFF_STAGE_DIFF8 ? 8 : 16, region, &word_ct, &cost);
+        break;
+      case E_HUFF_STAGE_LZ77:
+      case E_HUFF_STAGE_LZ77_VRAM:
+        out = Huff_Ctx_LZ77_Compress(ctx, in, byte_ct,
+            stages[i] == E_HUFF_STAGE_LZ77_VRAM, &word_ct, &lz77_stats);
+        if (out)
+          Huff_GBA_LZ77_Decode_Cost_Estimate(&cost, &lz77_stats, region);
+        break;
+      case E_HUFF_STAGE_RLE:
+        out = Huff_Ctx_RLE_Compress(ctx, in, byte_ct, &word_ct, &rle_stats);
+        if (out)
+          Huff_GBA_RLE_Decode_Cost_Estimate(&cost, &rle_stats, region);
+        break;
+      case E_HUFF_STAGE_HUFF4:
+      case E_HUFF_STAGE_HUFF8:
+        out = Huff_Pipeline_Huffman(ctx, in, byte_ct,
+            stages[i] == E_HUFF_STAGE_HUFF4
+              ? E_DATA_UNIT_4_BITS : E_DATA_UNIT_8_BITS,
+            region, &word_ct, &cost);
+        break;
+      default:
+        ctx->err = HUFF_ERROR_UNSUPPORTED_FEATURE;
+        out = NULL;
+        break;
+    }
+    if (in != data)
+      Huff_Ctx_Free(ctx, (void*)in);
+    if (!out)
+      return NULL;
+    if (return_info) {
+      return_info[i] = (HuffPipelineStageInfo_t) {
+        .stage = stages[i],
+        .in_byte_ct = byte_ct,
+        .out_byte_ct = word_ct*4,
+        .decode_cycles = cost.cycles
+      };
+    }
+    in = out;
+    byte_ct = word_ct*4;
+  }
+  *return_word_ct = word_ct;
+  return out;
+}
+
+uint32_t *Huff_Pipeline_Compress(const void *data, size_t byte_ct,
+    const HuffStage_e *stages, int stage_ct, HuffGBARegion_e src_region,
+    int *return_word_ct, HuffPipelineStageInfo_t *return_info) {
+  return Huff_Ctx_Pipeline_Compress(Huff_Ctx_Default(), data, byte_ct,
+      stages, stage_ct, src_region, return_word_ct, return_info);
+}
+
+long Huff_Ctx_Pipeline_Decompress(HuffCtx_t *ctx, const void *src,
+    size_t src_byte_ct, const HuffStage_e *stages, int stage_ct, void *dst) {
+  const byte *in = src;
+  byte *staged = NULL, *out;
+  long ret = -1;
+  if (!src || !stages || !dst) {
+    ctx->err = HUFF_ERROR_DATA_GIVEN_IS_NULL;
+    return -1;
+  }
+  if (stage_ct < 1 || stage_ct > HUFF_PIPELINE_MAX_STAGES) {
+    ctx->err = HUFF_ERROR_UNSUPPORTED_FEATURE;
+    return -1;
+  }
+  for (int i = stage_ct-1; i >= 0; --i, in = out, src_byte_ct = ret) {
+    if (src_byte_ct < 4) {
+      ctx->err = HUFF_ERROR_DATA_TRUNCATED;
+      goto FAIL;
+    }
+    if (in[0]>>4 != Huff_Stage_Compression_Type(stages[i])) {
+      ctx->err = HUFF_ERROR_BAD_HEADER;
+      goto FAIL;
+    }
+    out = dst;
+    if (i) {
+      // the BIOS decoders write whole words, so leave room to round up to one
+      const size_t staged_size = in[1] | in[2]<<8 | in[3]<<16;
+      if (NULL == (out = malloc((staged_size + 3)&~(size_t)3))) {
+        ctx->err = HUFF_ERROR_ALLOCATION_FAILED;
+        goto FAIL;
+      }
+    }
+    switch (stages[i]) {
+      case E_HUFF_STAGE_DIFF8:
+      case E_HUFF_STAGE_DIFF16:
+        ret = Huff_Ctx_Diff_Unfilter(ctx, in, src_byte_ct, out);
+        break;
+      case E_HUFF_STAGE_LZ77:
+      case E_HUFF_STAGE_LZ77_VRAM:
+        ret = Huff_Ctx_LZ77_Decompress(ctx, in, src_byte_ct, out,
+            stages[i] == E_HUFF_STAGE_LZ77_VRAM);
+        break;
+      case E_HUFF_STAGE_RLE:
+        ret = Huff_Ctx_RLE_Decompress(ctx, in, src_byte_ct, out);
+        break;
+      default:
+        ret = Huff_Ctx_Decompress(ctx, in, src_byte_ct, out);
+        break;
+    }
+    // what this stage read from is done with, whether it decoded or not
+    free(staged);
+    staged = i ? out : NULL;
+    if (ret < 0)
+      goto FAIL;
+  }
+  return ret;
+FAIL:
+  free(staged);
+  return -1;
+}
+
+long Huff_Pipeline_Decompress(const void *src, size_t src_byte_ct,
+    const HuffStage_e *stages, int stage_ct, void *dst) {
+  return Huff_Ctx_Pipeline_Decompress(Huff_Ctx_Default(), src, src_byte_ct,
+      stages, stage_ct, dst);
+}
+
+void Huff_Pipeline_Staging_Sizes(const HuffPipelineStageInfo_t *info,
+    int stage_ct, uint32_t dst[2]) {
+  dst[0] = dst[1] = 0;
+  // stage i decodes into buffer (stage_ct-1-i)%2, except stage 0, which
+  // decodes into the caller's
+  for (int i = stage_ct-1; i > 0; --i) {
+    uint32_t *size = &dst[(stage_ct-1-i)&1];
+    if (info[i].in_byte_ct > *size)
+      *size = info[i].in_byte_ct;
+  }
+}
@@ -0,0 +1,88 @@
+#include "huff_pool.h"
+#include <stdint.h>
+#include <stdlib.h>
+
+#define HUFF_POOL_ALIGN 16UL
+#define ALIGN_UP(n) (((n) + (HUFF_POOL_ALIGN-1)) & ~(HUFF_POOL_ALIGN-1))
+/// Blocks at least this big get an eighth again as much, rounded up to a page
+#define HUFF_POOL_HEADROOM_MIN (64UL*1024UL)
+#define HUFF_POOL_PAGE_SIZE 4096UL
+
+typedef struct s_huff_pool_block {
+  size_t cap;
+  // pad header out so that buf starts on an alignment boundary
+  uint8_t pad[HUFF_POOL_ALIGN - sizeof(size_t)%HUFF_POOL_ALIGN];
+  uint8_t buf[];
+} HuffPoolBlock_t;
+
+struct s_huff_pool {
+  HuffPoolBlock_t *held[HUFF_POOL_MAX_BLOCKS];
+  int held_ct;
+  size_t held_bytes, max_held_bytes;
+  unsigned reused_ct, malloced_ct;
+};
+
+HuffPool_t *Huff_Pool_Create(size_t max_cached_bytes) {
+  HuffPool_t *ret = calloc(1, sizeof(*ret));
+  if (ret)
+    ret->max_held_bytes = max_cached_bytes ? max_cached_bytes
+                                           : HUFF_POOL_DEFAULT_MAX_CACHED_BYTES;
+  return ret;
+}
+
+void Huff_Pool_Destroy(HuffPool_t *pool) {
+  if (!pool)
+    return;
+  for (int i = 0; i < pool->held_ct; ++i)
+    free(pool->held[i]);
+  free(pool);
+}
+
+void Huff_Pool_Counts(const HuffPool_t *pool, unsigned *reused_ct,
+    unsigned *malloced_ct) {
+  *reused_ct = pool->reused_ct;
+  *malloced_ct = pool->malloced_ct;
+}
+
+void *Huff_Pool_Alloc_Cb(void *pool_, size_t size) {
+  HuffPool_t *pool = pool_;
+  HuffPoolBlock_t *blk;
+  int best = -1;
+  size = ALIGN_UP(size);
+  // smallest held block it fits in, as long as that's not 4x too big for it
+  for (int i = 0; i < pool->held_ct; ++i) {
+    const size_t cap = pool->held[i]->cap;
+    if (cap >= size && cap/4 <= size
+        && (best < 0 || cap < pool->held[best]->cap))
+      best = i;
+  }
+  if (best >= 0) {
+    blk = pool->held[best];
+    pool->held[best] = pool->held[--pool->held_ct];
+    pool->held_bytes -= blk->cap;
+    ++pool->reused_ct;
+    return blk->buf;
+  }
+  if (size >= HUFF_POOL_HEADROOM_MIN)
+    size = (size + size/8 + HUFF_POOL_PAGE_SIZE-1) & ~(HUFF_POOL_PAGE_SIZE-1);
+  if (!(blk = malloc(sizeof(*blk) + size)))
+    return NULL;
+  blk->cap = size;
+  ++pool->malloced_ct;
+  return blk->buf;
+}
+
+void Huff_Pool_Dealloc_Cb(void *pool_, void *ptr) {
+  HuffPool_t *pool = pool_;
+  HuffPoolBlock_t *blk;
+  if (!ptr)
+    return;
+  blk = (HuffPoolBlock_t*)((uint8_t*)ptr - offsetof(HuffPoolBlock_t, buf));
+  if (pool->held_ct == HUFF_POOL_MAX_BLOCKS
+      || pool->held_bytes + blk->cap > pool->max_held_bytes) {
+    free(blk);
+    return;
+  }
+  pool->held[pool->held_ct++] = blk;
+  pool->held_bytes += blk->cap;
+}
@@ -0,0 +1,223 @@
+#include "huff_rle.h"
+#include "huff_errno.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Big enough to hold every index either window can span
+#define HUFF_RLE_WINDOW_CAP 256
+
+/* Sliding window minimum of a DP cost over the next few positions. Indices
+ * come in in decreasing order and leave once they're too far ahead; values
+ * stay increasing from head (the minimum) to tail, since an entry that
+ * isn't smaller than a newer one can never be the minimum again. */
+typedef struct s_huff_rle_window {
+  uint32_t idx[HUFF_RLE_WINDOW_CAP], val[HUFF_RLE_WINDOW_CAP];
+  uint32_t head, tail;
+} HuffRLEWindow_t;
+
+static inline void Huff_RLE_Window_Push(HuffRLEWindow_t *w, uint32_t idx,
+    uint32_t val) {
+  while (w->tail != w->head
+      && w->val[(w->tail-1)%HUFF_RLE_WINDOW_CAP] >= val)
+    --w->tail;
+  w->idx[w->tail%HUFF_RLE_WINDOW_CAP] = idx;
+  w->val[w->tail++%HUFF_RLE_WINDOW_CAP] = val;
+}
+
+/// Drop every index past max_idx.
+static inline void Huff_RLE_Window_Evict(HuffRLEWindow_t *w, uint32_t max_idx) {
+  while (w->head != w->tail && w->idx[w->head%HUFF_RLE_WINDOW_CAP] > max_idx)
+    ++w->head;
+}
+
+/**
+ * @summary Pick the segmentation with the smallest output, back to front.
+ * A literal block of k bytes costs 1+k, and a run of any length, 2, so from
+ * every position, the cheapest block is found by the minimum over the
+ * positions it could end at, which slide along with it.
+ * @param pick Gets the block picked at every position: a literal count if
+ * positive, a run length if negative.
+ * @return 0 on success, -1 (see Huff_Strerror) on failure.
+ * */
+static int Huff_RLE_Segment(HuffCtx_t *ctx, const byte *data,
+    uint32_t byte_ct, int16_t *pick) {
+  uint32_t *cost = malloc(sizeof(*cost)*(byte_ct+1)), run_end = byte_ct;
+  HuffRLEWindow_t *lits = malloc(sizeof(*lits)), *runs = malloc(sizeof(*runs));
+  if (!cost || !lits || !runs) {
+    free(cost);
+    free(lits);
+    free(runs);
+    ctx->err = HUFF_ERROR_ALLOCATION_FAILED;
+    return -1;
+  }
+  lits->head = lits->tail = runs->head = runs->tail = 0;
+  cost[byte_ct] = 0;
+  for (uint32_t pos = byte_ct; pos--; ) {
+    uint32_t best;
+    // a literal block from pos to end costs 1 + (end-pos) + cost[end]
+    Huff_RLE_Window_Push(lits, pos+1, cost[pos+1] + pos+1);
+    Huff_RLE_Window_Evict(lits, pos + HUFF_RLE_MAX_LITERALS);
+    best = 1 + lits->val[lits->head%HUFF_RLE_WINDOW_CAP] - pos;
+    pick[pos] = lits->idx[lits->head%HUFF_RLE_WINDOW_CAP] - pos;
+
+    // a run can only end within the run of equal bytes pos is in
+    if (pos+1 == byte_ct || data[pos] != data[pos+1]) {
+      run_end = pos+1;
+      runs->head = runs->tail = 0;
+    }
+    if (pos + HUFF_RLE_MIN_RUN <= run_end)
+      Huff_RLE_Window_Push(runs, pos + HUFF_RLE_MIN_RUN,
+          cost[pos + HUFF_RLE_MIN_RUN]);
+    Huff_RLE_Window_Evict(runs, pos + HUFF_RLE_MAX_RUN);
+    if (runs->head != runs->tail
+        && 2 + runs->val[runs->head%HUFF_RLE_WINDOW_CAP] < best) {
+      best = 2 + runs->val[runs->head%HUFF_RLE_WINDOW_CAP];
+      pick[pos] = -(int)(runs->idx[runs->head%HUFF_RLE_WINDOW_CAP] - pos);
+    }
+    cost[pos] = best;
+  }
+  free(cost);
+  free(lits);
+  free(runs);
+  return 0;
+}
+
+uint32_t *Huff_Ctx_RLE_Compress(HuffCtx_t *ctx, const void *data,
+    size_t byte_ct, int *return_word_ct, HuffRLEStats_t *return_stats) {
+  const byte *src = data;
+  HuffRLEStats_t stats = {0};
+  int16_t *pick;
+  uint32_t *ret;
+  byte *out;
+  if (!data) {
+    ctx->err = HUFF_ERROR_DATA_GIVEN_IS_NULL;
+    return NULL;
+  }
+  if (!byte_ct) {
+    ctx->err = HUFF_ERROR_INPUT_TOO_SHORT;
+    return NULL;
+  }
+  if (byte_ct > HUFF_GBA_MAX_DECOMP_SIZE) {
+    ctx->err = HUFF_ERROR_DATA_TOO_LARGE;
+    return NULL;
+  }
+  pick = malloc(sizeof(*pick)*byte_ct);
+  // worst case is all literals: a flag byte per 128, plus header and padding
+  ret = Huff_Ctx_Alloc(ctx, 4 + byte_ct +
+      (byte_ct+HUFF_RLE_MAX_LITERALS-1)/HUFF_RLE_MAX_LITERALS + 3);
+  if (!pick || !ret) {
+    ctx->err = HUFF_ERROR_ALLOCATION_FAILED;
+    goto FAIL;
+  }
+  if (0 > Huff_RLE_Segment(ctx, src, byte_ct, pick))
+    goto FAIL;
+
+  out = (byte*)ret;
+  *out++ = HUFF_RLE_GBA_COMPRESSION_TYPE_ID<<4;
+  *out++ = byte_ct;
+  *out++ = byte_ct>>8;
+  *out++ = byte_ct>>16;
+  for (uint32_t pos = 0, len; pos < byte_ct; pos += len) {
+    if (pick[pos] < 0) {
+      len = -pick[pos];
+      *out++ = 0x80 | (len - HUFF_RLE_MIN_RUN);
+      *out++ = src[pos];
+      ++stats.run_ct;
+      stats.run_byte_ct += len;
+    } else {
+      len = pick[pos];
+      *out++ = len-1;
+      memcpy(out, src+pos, len);
+      out += len;
+      ++stats.literal_block_ct;
+      stats.literal_byte_ct += len;
+    }
+  }
+  while ((uintptr_t)(out - (byte*)ret)&3)
+    *out++ = 0;
+  *return_word_ct = (out - (byte*)ret)/4;
+  if (return_stats)
+    *return_stats = stats;
+  free(pick);
+  return ret;
+
+FAIL:
+  free(pick);
+  Huff_Ctx_Free(ctx, ret);
+  return NULL;
+}
+
+uint32_t *Huff_RLE_Compress(const void *data, size_t byte_ct,
+    int *return_word_ct, HuffRLEStats_t *return_stats) {
+  return Huff_Ctx_RLE_Compress(Huff_Ctx_Default(), data, byte_ct,
+      return_word_ct, return_stats);
+}
+
+uint32_t Huff_RLE_Size_Bound(const void *data, size_t byte_ct) {
+  const byte *src = data;
+  uint64_t literal_ct = 0;
+  for (size_t pos = 0, len; pos < byte_ct; pos += len) {
+    for (len = 1; pos+len < byte_ct && src[pos+len] == src[pos]; ++len)
+      continue;
+    if (len < HUFF_RLE_MIN_RUN)
+      literal_ct += len;
+  }
+  // in 1/(128*130)ths of a byte: a literal costs itself plus at least 1/128
+  // of a flag byte, and a run byte, at least 2/130
+  const uint64_t denom = HUFF_RLE_MAX_LITERALS*HUFF_RLE_MAX_RUN,
+        parts = literal_ct*(HUFF_RLE_MAX_LITERALS+1)*HUFF_RLE_MAX_RUN 
+          + (byte_ct - literal_ct)*2*HUFF_RLE_MAX_LITERALS;
+  return (4 + (parts+denom-1)/denom + 3)&~3UL;
+}
+
+long Huff_Ctx_RLE_Decompress(HuffCtx_t *ctx, const void *src,
+    size_t src_byte_ct, void *dst) {
+  const byte *in = src, *const in_end = in + src_byte_ct;
+  byte *out = dst;
+  uint32_t size, pos = 0;
+  if (!src || !dst) {
+    ctx->err = HUFF_ERROR_DATA_GIVEN_IS_NULL;
+    return -1;
+  }
+  if (src_byte_ct < 4) {
+    ctx->err = HUFF_ERROR_DATA_TRUNCATED;
+    return -1;
+  }
+  if (in[0]>>4 != HUFF_RLE_GBA_COMPRESSION_TYPE_ID) {
+    ctx->err = HUFF_ERROR_BAD_HEADER;
+    return -1;
+  }
+  size = in[1] | in[2]<<8 | in[3]<<16;
+  in += 4;
+  while (pos < size) {
+    uint32_t len;
+    if (in_end - in < 2) {
+      ctx->err = HUFF_ERROR_DATA_TRUNCATED;
+      return -1;
+    }
+    const byte flag = *in++;
+    if (flag&0x80) {
+      len = (flag&0x7F) + HUFF_RLE_MIN_RUN;
+      // the BIOS stops as soon as it's written size bytes, even mid-block
+      if (len > size-pos)
+        len = size-pos;
+      memset(out+pos, *in++, len);
+    } else {
+      len = (flag&0x7F) + 1;
+      if (len > size-pos)
+        len = size-pos;
+      if ((size_t)(in_end - in) < len) {
+        ctx->err = HUFF_ERROR_DATA_TRUNCATED;
+        return -1;
+      }
+      memcpy(out+pos, in, len);
+      in += len;
+    }
+    pos += len;
+  }
+  return size;
+}
+
+long Huff_RLE_Decompress(const void *src, size_t src_byte_ct, void *dst) {
+  return Huff_Ctx_RLE_Decompress(Huff_Ctx_Default(), src, src_byte_ct, dst);
+}
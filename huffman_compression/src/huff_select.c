@@ -0,0 +1,268 @@
+#include "huff_select.h"
+#include "huff_errno.h"
+#include "huff_histogram.h"
+#include "huff_lz77.h"
+#include "huff_rle.h"
+#include "huff_diff.h"
+#include "batch.h"
+#include <math.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char *const huff_codec_names[E_HUFF_CODEC_CT] = {
+  [E_HUFF_CODEC_HUFF4] = "huff4",
+  [E_HUFF_CODEC_HUFF8] = "huff8",
+  [E_HUFF_CODEC_LZ77] = "lz77",
+  [E_HUFF_CODEC_RLE] = "rle"
+};
+
+/// Indexed by filter bit, i.e.: HUFF_SELECT_FILTER_DIFF8 is 1<<1
+static const int huff_select_filter_bitlens[HUFF_SELECT_FILTER_CT] = {0, 8, 16};
+
+/// The best score so far, which every worker checks before compressing
+typedef struct s_huff_select_best {
+  pthread_mutex_t lock;
+  double score;
+} HuffSelectBest_t;
+
+typedef struct s_huff_select_job {
+  HuffSelectCandidate_t *cand;
+  const byte *data;  /// What cand's codec compresses: the input, or a filter stream of it
+  size_t byte_ct;
+  uint64_t unfilter_cycles;
+  const HuffSelectOpts_t *opts;
+  HuffSelectBest_t *best;
+} HuffSelectJob_t;
+
+static double Huff_Select_Score(const HuffSelectOpts_t *opts,
+    uint32_t byte_ct, uint64_t decode_cycles) {
+  return byte_ct + opts->frame_weight*decode_cycles/HUFF_GBA_FRAME_CYCLES;
+}
+
+static void Huff_Select_Measured(HuffSelectCandidate_t *cand,
+    const HuffSelectOpts_t *opts, uint32_t byte_ct, uint64_t decode_cycles) {
+  cand->status = E_HUFF_SELECT_MEASURED;
+  cand->byte_ct = byte_ct;
+  cand->decode_cycles = decode_cycles;
+  cand->score = Huff_Select_Score(opts, byte_ct, decode_cycles);
+}
+
+/**
+ * @summary Measure both Huffman candidates straight from the byte histogram
+ * of what they'd compress, building each tree but compressing nothing.
+ * @param cand The 4-bit candidate, followed by the 8-bit one.
+ * */
+static void Huff_Select_Huffman(HuffCtx_t *ctx, const uint32_t counts[256],
+    HuffSelectCandidate_t cand[2], const HuffSelectOpts_t *opts,
+    uint64_t unfilter_cycles) {
+  int byte_freq[256] = {0}, nibble_freq[16] = {0};
+  Huff_Histogram_Fold(byte_freq, counts, E_DATA_UNIT_8_BITS);
+  Huff_Histogram_Fold(nibble_freq, counts, E_DATA_UNIT_4_BITS);
+  for (int i = 0; i < 2; ++i) {
+    HuffGBADecodeCost_t cost;
+    HuffTree_t *tree = Huff_Ctx_Tree_Create_From_Histogram(ctx,
+        i ? byte_freq : nibble_freq, i ? E_DATA_UNIT_8_BITS : E_DATA_UNIT_4_BITS);
+    if (!tree) {
+      cand[i].status = E_HUFF_SELECT_FAILED;
+      continue;
+    }
+    Huff_GBA_Decode_Cost_Estimate(&cost, tree, opts->src_region);
+    cand[i].bound = Huff_Tree_GBA_Byte_Ct(tree);
+    Huff_Select_Measured(&cand[i], opts, cand[i].bound,
+        cost.cycles + unfilter_cycles);
+    Huff_Tree_Destroy(tree);
+  }
+}
+
+static int Huff_Select_Job_Cb(HuffCtx_t *ctx, void *job) {
+  HuffSelectJob_t *cur = job;
+  HuffSelectCandidate_t *cand = cur->cand;
+  HuffGBADecodeCost_t cost;
+  uint32_t *compdata;
+  int word_ct = 0;
+  double best;
+
+  pthread_mutex_lock(&cur->best->lock);
+  best = cur->best->score;
+  pthread_mutex_unlock(&cur->best->lock);
+  // decoding can't take less than the unfiltering after it. A bound that 
+  // only ties the best still gets measured, for the tie-break to weigh.
+  if (Huff_Select_Score(cur->opts, cand->bound, cur->unfilter_cycles) > best) {
+    cand->status = E_HUFF_SELECT_PRUNED;
+    return 0;
+  }
+
+  if (cand->codec == E_HUFF_CODEC_LZ77) {
+    HuffLZ77Stats_t stats;
+    compdata = Huff_Ctx_LZ77_Compress(ctx, cur->data, cur->byte_ct,
+        cur->opts->vram_safe, &word_ct, &stats);
+    if (compdata)
+      Huff_GBA_LZ77_Decode_Cost_Estimate(&cost, &stats, cur->opts->src_region);
+  } else {
+    HuffRLEStats_t stats;
+    compdata = Huff_Ctx_RLE_Compress(ctx, cur->data, cur->byte_ct, &word_ct,
+        &stats);
+    if (compdata)
+      Huff_GBA_RLE_Decode_Cost_Estimate(&cost, &stats, cur->opts->src_region);
+  }
+  if (!compdata) {
+    cand->status = E_HUFF_SELECT_FAILED;
+    return -1;
+  }
+  Huff_Ctx_Free(ctx, compdata);
+  Huff_Select_Measured(cand, cur->opts, word_ct*4,
+      cost.cycles + cur->unfilter_cycles);
+
+  pthread_mutex_lock(&cur->best->lock);
+  if (cand->score < cur->best->score)
+    cur->best->score = cand->score;
+  pthread_mutex_unlock(&cur->best->lock);
+  return 0;
+}
+
+/// Smallest bound first, so the likeliest winners set the bar early
+static int Huff_Select_Job_Cmp(const void *a, const void *b) {
+  const HuffSelectCandidate_t *lhs = ((const HuffSelectJob_t*)a)->cand,
+        *rhs = ((const HuffSelectJob_t*)b)->cand;
+  if (lhs->bound != rhs->bound)
+    return lhs->bound < rhs->bound ? -1 : 1;
+  return lhs < rhs ? -1 : lhs > rhs;
+}
+
+int Huff_Ctx_Select_Codec(HuffCtx_t *ctx, const void *data, size_t byte_ct,
+    const HuffSelectOpts_t *opts, HuffSelectResult_t *dst) {
+  const HuffSelectOpts_t defaults = { .src_region = E_HUFF_GBA_REGION_ROM };
+  byte *streams[HUFF_SELECT_FILTER_CT] = {0};
+  HuffSelectJob_t jobs[HUFF_SELECT_CANDIDATE_CT];
+  HuffSelectBest_t best = { .lock = PTHREAD_MUTEX_INITIALIZER, .score = HUGE_VAL };
+  int job_ct = 0, filter_mask, ret = -1;
+  if (!data || !dst) {
+    ctx->err = HUFF_ERROR_DATA_GIVEN_IS_NULL;
+    return -1;
+  }
+  if (!byte_ct) {
+    ctx->err = HUFF_ERROR_INPUT_TOO_SHORT;
+    return -1;
+  }
+  // the filter header counts against the BIOS's 24-bit size field too
+  if (byte_ct + HUFF_DIFF_HEADER_SIZE > HUFF_GBA_MAX_DECOMP_SIZE) {
+    ctx->err = HUFF_ERROR_DATA_TOO_LARGE;
+    return -1;
+  }
+  if (!opts)
+    opts = &defaults;
+  filter_mask = opts->filter_mask ? opts->filter_mask : HUFF_SELECT_FILTER_ALL;
+  memset(dst, 0, sizeof(*dst));
+  dst->frame_weight = opts->frame_weight;
+  dst->winner = -1;
+
+  for (int filter = 0; filter < HUFF_SELECT_FILTER_CT; ++filter) {
+    const int unit_bitlen = huff_select_filter_bitlens[filter];
+    HuffSelectCandidate_t *cand = &dst->candidates[dst->candidate_ct];
+    const byte *stream = data;
+    size_t stream_byte_ct = byte_ct;
+    uint64_t unfilter_cycles = 0;
+    uint32_t counts[256] = {0};
+    long lz77_bound;
+    if (!(filter_mask & (1<<filter)))
+      continue;
+    dst->candidate_ct += E_HUFF_CODEC_CT;
+    for (int codec = 0; codec < E_HUFF_CODEC_CT; ++codec) {
+      cand[codec] = (HuffSelectCandidate_t) {
+        .codec = codec,
+        .diff_unit_bitlen = unit_bitlen
+      };
+    }
+
+    if (unit_bitlen) {
+      HuffGBADecodeCost_t cost;
+      if (NULL == (streams[filter] = malloc(byte_ct + HUFF_DIFF_HEADER_SIZE))) {
+        ctx->err = HUFF_ERROR_ALLOCATION_FAILED;
+        goto CLEANUP;
+      }
+      // e.g.: an odd byte count has no 16-bit filter stream
+      if (0 > Huff_Ctx_Diff_Filter(ctx, data, byte_ct, unit_bitlen,
+            streams[filter])) {
+        for (int codec = 0; codec < E_HUFF_CODEC_CT; ++codec)
+          cand[codec].status = E_HUFF_SELECT_FAILED;
+        continue;
+      }
+      stream = streams[filter];
+      stream_byte_ct += HUFF_DIFF_HEADER_SIZE;
+      // the codec ahead of it decompresses to a buffer, most likely in EWRAM
+      Huff_GBA_Diff_Decode_Cost_Estimate(&cost, byte_ct, unit_bitlen,
+          E_HUFF_GBA_REGION_EWRAM);
+      unfilter_cycles = cost.cycles;
+    }
+
+    Huff_Histogram_Add_Bytes(counts, stream, stream_byte_ct);
+    Huff_Select_Huffman(ctx, counts, &cand[E_HUFF_CODEC_HUFF4], opts,
+        unfilter_cycles);
+    for (int codec = E_HUFF_CODEC_HUFF4; codec <= E_HUFF_CODEC_HUFF8; ++codec)
+      if (cand[codec].status == E_HUFF_SELECT_MEASURED
+          && cand[codec].score < best.score)
+        best.score = cand[codec].score;
+
+    if (0 > (lz77_bound = Huff_Ctx_LZ77_Size_Bound(ctx, stream, stream_byte_ct)))
+      goto CLEANUP;
+    cand[E_HUFF_CODEC_LZ77].bound = lz77_bound;
+    cand[E_HUFF_CODEC_RLE].bound = Huff_RLE_Size_Bound(stream, stream_byte_ct);
+    for (int codec = E_HUFF_CODEC_LZ77; codec <= E_HUFF_CODEC_RLE; ++codec) {
+      jobs[job_ct++] = (HuffSelectJob_t) {
+        .cand = &cand[codec],
+        .data = stream,
+        .byte_ct = stream_byte_ct,
+        .unfilter_cycles = unfilter_cycles,
+        .opts = opts,
+        .best = &best
+      };
+    }
+  }
+
+  qsort(jobs, job_ct, sizeof(*jobs), Huff_Select_Job_Cmp);
+  Batch_Run(jobs, sizeof(*jobs), job_ct, opts->thread_ct, Huff_Select_Job_Cb);
+
+  for (int i = 0; i < dst->candidate_ct; ++i) {
+    const HuffSelectCandidate_t *cur = &dst->candidates[i];
+    if (cur->status != E_HUFF_SELECT_MEASURED)
+      continue;
+    // ties go to whichever decodes faster
+    if (dst->winner < 0 || cur->score < dst->candidates[dst->winner].score
+        || (cur->score == dst->candidates[dst->winner].score
+          && cur->decode_cycles < dst->candidates[dst->winner].decode_cycles))
+      dst->winner = i;
+  }
+  if (dst->winner < 0) {
+    // RLE takes any data in range, so only a failed allocation gets here
+    ctx->err = HUFF_ERROR_ALLOCATION_FAILED;
+    goto CLEANUP;
+  }
+  ret = 0;
+
+CLEANUP:
+  for (int filter = 0; filter < HUFF_SELECT_FILTER_CT; ++filter)
+    free(streams[filter]);
+  return ret;
+}
+
+int Huff_Select_Codec(const void *data, size_t byte_ct,
+    const HuffSelectOpts_t *opts, HuffSelectResult_t *dst) {
+  return Huff_Ctx_Select_Codec(Huff_Ctx_Default(), data, byte_ct, opts, dst);
+}
+
+const char *Huff_Codec_Name(HuffCodec_e codec) {
+  if ((unsigned)codec >= E_HUFF_CODEC_CT)
+    return "[N/A]";
+  return huff_codec_names[codec];
+}
+
+void Huff_Select_Candidate_Name(char *dst, size_t dst_size,
+    const HuffSelectCandidate_t *cand) {
+  if (cand->diff_unit_bitlen)
+    snprintf(dst, dst_size, "diff%d -> %s", cand->diff_unit_bitlen,
+        Huff_Codec_Name(cand->codec));
+  else
+    snprintf(dst, dst_size, "%s", Huff_Codec_Name(cand->codec));
+}
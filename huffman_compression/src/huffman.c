@@ -1,29 +1,65 @@
 #include "huffman.h"
-#include "binary_tree.h"
 #include "huff_codebase.h"
+#include "huff_ctx.h"
+#include "huff_bitwriter.h"
+#include "huff_arena.h"
+#include "batch.h"
+#include "huff_histogram.h"
+#include "huff_gba_layout.h"
+#include "huff_errno.h"
 #include <limits.h>
 #include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 #include <stdbool.h>
 
-enum e_huffman_errno {
-  HUFF_ERROR_NONE=0,
-  HUFF_ERROR_UNSUPPORTED_FEATURE,
-  HUFF_ERROR_INPUT_TOO_UNIFORM,
-  HUFF_ERROR_INPUT_TOO_SHORT,
-  HUFF_ERROR_SUBROOT_MISSING_DESCENDANT,
-  HUFF_ERROR_FREQ_TREE_MISSING_NODES,
-  HUFF_ERROR_UNEXPECTED_TREE_NODE_CT,
-  HUFF_ERROR_DATA_GIVEN_IS_NULL,
-  HUFF_ERROR_NO_TREE_SUPPLIED,
-  HUFF_ERROR_CODEBASE_ERR,
-  HUFF_ERROR_CODEBASE_MISSING_ENTRY,
-  HUFF_ERROR_NO_HEADER_SUPPLIED,
-  HUFF_ERROR_DATA_NOT_WORD_ALIGNABLE,
-  HUFF_ERROR_GBA_TABLE_ENTRY_OFS_OVERFLOW,
-}; 
-static enum e_huffman_errno huff_errno=HUFF_ERROR_NONE;
+// Backs every context-less function. Thread-local, so those stay safe to
+// call from multiple threads too, just with per-thread Huff_Strerror state.
+static __thread HuffCtx_t huff_default_ctx;
+
+HuffCtx_t *Huff_Ctx_Default(void) {
+  return &huff_default_ctx;
+}
+
+HuffCtx_t *Huff_Ctx_Create(const HuffAllocator_t *allocator) {
+  HuffCtx_t *ret;
+  if (allocator && allocator->alloc)
+    ret = allocator->alloc(allocator->pool, sizeof(*ret));
+  else
+    ret = malloc(sizeof(*ret));
+  if (!ret)
+    return NULL;
+  *ret = HUFF_CTX_INITIALIZER;
+  if (allocator)
+    ret->allocator = *allocator;
+  return ret;
+}
+
+void Huff_Ctx_Destroy(HuffCtx_t *ctx) {
+  if (!ctx || ctx == &huff_default_ctx)
+    return;
+  // copy out the allocator, since ctx is about to go away with it
+  HuffAllocator_t allocator = ctx->allocator;
+  if (allocator.alloc)
+    allocator.dealloc(allocator.pool, ctx);
+  else
+    free(ctx);
+}
+
+void *Huff_Ctx_Alloc(HuffCtx_t *ctx, size_t size) {
+  if (ctx->allocator.alloc)
+    return ctx->allocator.alloc(ctx->allocator.pool, size);
+  return malloc(size);
+}
+
+void Huff_Ctx_Free(HuffCtx_t *ctx, void *ptr) {
+  if (!ptr)
+    return;
+  if (ctx->allocator.alloc)
+    ctx->allocator.dealloc(ctx->allocator.pool, ptr);
+  else
+    free(ptr);
+}
 
 
 #define WARN_PREFIX "\x1b[1;33m[Warning]:\x1b[0m "
@@ -32,8 +68,8 @@ static enum e_huffman_errno huff_errno=HUFF_ERROR_NONE;
 
 #define HUFF_ERR_CASE(enumval) case enumval: return #enumval
 
-const char *Huff_Strerror(void) {
-  switch (huff_errno) {
+const char *Huff_Ctx_Strerror(const HuffCtx_t *ctx) {
+  switch (ctx->err) {
     case HUFF_ERROR_NONE: return "No error to report.";
     HUFF_ERR_CASE(HUFF_ERROR_UNSUPPORTED_FEATURE);
     HUFF_ERR_CASE(HUFF_ERROR_INPUT_TOO_UNIFORM);
@@ -47,42 +83,41 @@ const char *Huff_Strerror(void) {
     HUFF_ERR_CASE(HUFF_ERROR_NO_HEADER_SUPPLIED);
     HUFF_ERR_CASE(HUFF_ERROR_DATA_NOT_WORD_ALIGNABLE);
     HUFF_ERR_CASE(HUFF_ERROR_GBA_TABLE_ENTRY_OFS_OVERFLOW);
-    case HUFF_ERROR_CODEBASE_ERR: return Huff_Codebase_Strerror();
+    HUFF_ERR_CASE(HUFF_ERROR_ALLOCATION_FAILED);
+    HUFF_ERR_CASE(HUFF_ERROR_DATA_TOO_LARGE);
+    HUFF_ERR_CASE(HUFF_ERROR_GBA_TABLE_MALFORMED);
+    HUFF_ERR_CASE(HUFF_ERROR_BAD_HEADER);
+    HUFF_ERR_CASE(HUFF_ERROR_DATA_TRUNCATED);
+    HUFF_ERR_CASE(HUFF_ERROR_BAD_BACKREF);
+    case HUFF_ERROR_CODEBASE_ERR: return Huff_Ctx_Codebase_Strerror(ctx);
     default: return "Undefined error case.";
   }
 }
 
-static int Huff_Node_Cmp_Callback(const void *a, const void *b) {
-  const HuffNode_t *t1 = a, *t2 = b;
-  int diff=t1->freq-t2->freq;
-  if (diff)
-    return diff;
-  // 0 > diff ? t1->dlen is minimum : t2->dlen is minimum
-  diff = t1->dlen - t2->dlen;
-  // given the way these huff trees nest, there should never be any erroneous,
-  // cmp:=0 collisions from comparing data subroots, 
-  // so just defaulting to returning a memcmp of nodes' data
-  // streams won't be a problem
-  return memcmp(t1->data, t2->data, 
-      (0 > diff ? t1->dlen : t2->dlen)*sizeof(*(t1->data)));
+const char *Huff_Strerror(void) {
+  return Huff_Ctx_Strerror(&huff_default_ctx);
 }
 
-
 #define MINIMUM(a,b) ((a < b) ? a : b)
 #define MAXIMUM(a,b) ((a > b) ? a : b)
+// Longest code Huff_Ctx_Codebase_Init accepts
+#define HUFF_CODELEN_MAX 63
 
-static HuffNode_t *Huff_Node_Create_Subroot(HuffNode_t *l, HuffNode_t *r) {
-  // node checklist: [X] data ; [X] data len ; [X] height
+static HuffNode_t *Huff_Node_Create_Subroot(HuffCtx_t *ctx, HuffArena_t *arena, HuffNode_t *l, 
+    HuffNode_t *r, int id) {
+  // node checklist: [X] data ; [X] id ; [X] height
   // [X] freq ; [X] descendants
   HuffNode_t *ret;
-  byte *buf;
   if (!l || !r) {
-    huff_errno = HUFF_ERROR_SUBROOT_MISSING_DESCENDANT;
+    ctx->err = HUFF_ERROR_SUBROOT_MISSING_DESCENDANT;
     return NULL;
   }
   
   // allocate
-  ret = malloc(sizeof(*ret));
+  if (!(ret = Huff_Arena_Alloc(arena, sizeof(*ret)))) {
+    ctx->err = HUFF_ERROR_ALLOCATION_FAILED;
+    return NULL;
+  }
   
   // set descendant nodes
   int lh, rh;
@@ -92,18 +127,10 @@ static HuffNode_t *Huff_Node_Create_Subroot(HuffNode_t *l, HuffNode_t *r) {
   // set height
   lh = HUFF_NODE_HEIGHT(l), rh = HUFF_NODE_HEIGHT(r);
   ret->height = MAXIMUM(lh,rh) + 1;
-  
-  // set data len
-  lh = l->dlen, rh = r->dlen;
-  ret->dlen = lh+rh;
-  
-  // set data to concat(l->data, r->data)
-  buf = ret->data = malloc(sizeof(*(ret->data))*((ret->dlen) + 1));
-  memcpy(buf, l->data, lh);
-  memcpy(&buf[lh], r->data, rh);
-  
-  // null-terminate data
-  buf[ret->dlen] = '\0';
+
+  // subroots don't encode anything
+  ret->data = -1;
+  ret->id = id;
 
   // set freq combined freq of child nodes
   ret->freq = l->freq + r->freq;
@@ -111,52 +138,29 @@ static HuffNode_t *Huff_Node_Create_Subroot(HuffNode_t *l, HuffNode_t *r) {
 
 }
 
-static HuffNode_t *Huff_Node_Create_Leaf(int data, int freq) {
-  // node checklist: [X] data ; [X] data len ; [X (set to 0 by calloc)] height
+static HuffNode_t *Huff_Node_Create_Leaf(HuffCtx_t *ctx, HuffArena_t *arena, int data, 
+    int freq, int id) {
+  // node checklist: [X] data ; [X] id ; [X (set to 0 by calloc)] height
   // [X] freq ; [X (set to NULL by calloc)] descendants
-  HuffNode_t *ret = calloc(1, sizeof(*ret));
-  // calloc with 2 for arg0 because HuffNode_t.data should always be
-  // null-terminated
-  ret->data = calloc(2, sizeof(*(ret->data)));
-  ret->data[0] = data;
-  ret->dlen = 1;
+  HuffNode_t *ret = Huff_Arena_Calloc(arena, 1, sizeof(*ret));
+  if (!ret) {
+    ctx->err = HUFF_ERROR_ALLOCATION_FAILED;
+    return NULL;
+  }
+  ret->data = data;
+  ret->id = id;
   ret->freq = freq;
   return ret;
 
 }
 
-void Huff_Node_Dealloc(HuffNode_t *root) {
-  if (!root)
-    return;
-  HuffNode_t *stack[1<<(root->height+1)];
-  int top = -1;
-  stack[++top] = root;
-  do {
-    root = stack[top--];
-    if (!root) {
-      continue;
-    } else if (HUFF_NODE_IS_LEAF(root)) {
-      free(root->data);
-      free(root);
-      continue;
-    }
-    free(root->data);
-    stack[++top] = root->l;
-    stack[++top] = root->r;
-    free(root);
-  } while (top > -1);
-}
-
-static void Huff_Node_BST_Dealloc_Callback(void *vp) {
-  if (!vp)
-    return;
-  Huff_Node_Dealloc(vp);
-}
-
 static int Huff_Node_Get_Subroot_Node_Ct(HuffNode_t *root) {
   if (!root)
     return 0;
-  HuffNode_t *stack[1<<(root->height+1)];
+  // Popping a node pushes both its children, so the stack never holds more 
+  // than one pending sibling per level, plus the two children of the deepest
+  // node.
+  HuffNode_t *stack[root->height+2];
   int top = -1, ret=0;
   stack[++top] = root;
   do {
@@ -174,396 +178,693 @@ static int Huff_Node_Get_Subroot_Node_Ct(HuffNode_t *root) {
 }
 
 
-static int Huff_Tree_Fill_4b(HuffTree_t *dst, const byte *data, int byte_ct) {
-  int freq[16] = {0}, unique_vals[16] = {0};
-  int unique_ct=0;
-  byte currval, currpair;
-  do {
-    currpair = *data++;
-    currval = currpair&15;
-    if (!(freq[currval]++)) {
-      unique_vals[unique_ct++] = currval;
-    }
-    currval = (currpair>>4)&15;
-    if (!(freq[currval]++)) {
-      unique_vals[unique_ct++] = currval;
-    }
+typedef struct s_huff_leaf_ent {
+  int data;
+  int freq;
+} HuffLeafEnt_t;
 
-  } while (--byte_ct);
+static int Huff_Leaf_Ent_Cmp(const void *a, const void *b) {
+  const HuffLeafEnt_t *e0 = a, *e1 = b;
+  if (e0->freq != e1->freq)
+    return (e0->freq < e1->freq) ? -1 : 1;
+  return e0->data - e1->data;
+}
 
-  if (unique_ct < 2) {
-    huff_errno = HUFF_ERROR_INPUT_TOO_UNIFORM;
-    return -1;
-  }
+/// Sum of freq*depth over every leaf under node, i.e.: its encoded bit length
+static uint64_t Huff_Node_Bit_Ct(const HuffNode_t *node, int depth) {
+  if (HUFF_NODE_IS_LEAF(node))
+    return ((uint64_t)node->freq)*depth;
+  return Huff_Node_Bit_Ct(node->l, depth+1) + Huff_Node_Bit_Ct(node->r, depth+1);
+}
 
-  // NULL for alloc arg makes BST just insert data ptr passed to BST_Add calls
-  // directly. Pass deallocator for proper deallocations when BST_Close is 
-  // called during failure cases. Otherwise, if function is to return 
-  // successfully, BST_Close will be called on empty tree.
-  BST_t *valfreq_tree = BST_Init(Huff_Node_Cmp_Callback, NULL, 
-      Huff_Node_BST_Dealloc_Callback, 0ULL);
-  HuffNode_t *insert;
-  for (int i = 0; i < unique_ct; ++i) {
-    currval = unique_vals[i];
-    insert = Huff_Node_Create_Leaf(currval, freq[currval]);
-    if (!insert) {
-      // no need to set errno. already set by create_leaf
-      BST_Close(valfreq_tree);
-      return -1;
-    }
-    BST_Add(valfreq_tree, insert);
-  }
-  if (BST_Element_Count(valfreq_tree) != unique_ct) {
-    huff_errno = HUFF_ERROR_FREQ_TREE_MISSING_NODES;
-    BST_Close(valfreq_tree);
-    return -1;
+/**
+ * @summary Package-merge. Finds the code lengths that encode leaves in the 
+ * fewest bits, given that no code can be longer than max_len bits.
+ * Level j's list holds every leaf plus the pairs packaged up from level j-1,
+ * cheapest first; the 2*leaf_ct-2 cheapest items of the last level decide 
+ * how many leaves get a bit at every level on the way back down.
+ * @param leaves Sorted by (freq, data), as Huff_Tree_Build sorts them.
+ * @param max_len MUST satisfy leaf_ct <= (1<<max_len).
+ * @param lens Filled with the code length of leaves[i] at lens[i].
+ * */
+static void Huff_Codelens_Limited(const HuffLeafEnt_t *leaves, int leaf_ct, 
+    int max_len, int *lens) {
+  const int cap = 2*leaf_ct;
+  uint64_t weights[2][cap];
+  uint8_t is_leaf[max_len][cap];
+  int item_ct[max_len];
+
+  for (int i = 0; i < leaf_ct; ++i) {
+    weights[0][i] = leaves[i].freq;
+    is_leaf[0][i] = 1;
+    lens[i] = 0;
   }
-  HuffNode_t *node_1st_least, *node_2nd_least;
-  int node_ct = unique_ct;  // node ct so far = count of huff tree's leaf nodes
-  do {
-    node_1st_least = BST_Remove_Minimum(valfreq_tree);
-    node_2nd_least = BST_Remove_Minimum(valfreq_tree);
-    // Given previous checks, we definitely know subroot created won't be NULL
-    // so no need to check; can just pass it to BST_Add directly
-    BST_Add(valfreq_tree, 
-        Huff_Node_Create_Subroot(node_1st_least, node_2nd_least));
-    // every time we nest existing nodes, we add 1 node to final resulting
-    // hufftree, so increment node_ct with each loop.
-    ++node_ct;
-  } while (BST_Element_Count(valfreq_tree) > 1);
-  
-  if (!BST_Element_Count(valfreq_tree)) {
-    huff_errno = HUFF_ERROR_FREQ_TREE_MISSING_NODES;
-    BST_Close(valfreq_tree);
-    return -1;
+  item_ct[0] = leaf_ct;
+  for (int j = 1; j < max_len; ++j) {
+    const uint64_t *prev = weights[(j-1)&1];
+    uint64_t *cur = weights[j&1];
+    int package_ct = item_ct[j-1]/2, l = 0, p = 0, ct = 0;
+    while (l < leaf_ct || p < package_ct) {
+      uint64_t package = (p < package_ct) ? prev[2*p] + prev[2*p+1] : 0;
+      if (p == package_ct || (l < leaf_ct && (uint64_t)leaves[l].freq <= package)) {
+        cur[ct] = leaves[l++].freq;
+        is_leaf[j][ct++] = 1;
+      } else {
+        cur[ct] = package;
+        is_leaf[j][ct++] = 0;
+        ++p;
+      }
+    }
+    item_ct[j] = ct;
   }
 
-  dst->root = BST_Remove_Minimum(valfreq_tree);
-  
-  BST_Close(valfreq_tree);
-
-  if (node_ct != Huff_Node_Get_Subroot_Node_Ct(dst->root)) {
-    huff_errno = HUFF_ERROR_UNEXPECTED_TREE_NODE_CT;
-    Huff_Node_Dealloc(dst->root);
-    dst->root = NULL;
-    return -1;
+  // Leaves get merged in in sorted order, so the leaves among a level's 
+  // first k items are always the cheapest ones.
+  for (int j = max_len-1, k = 2*leaf_ct-2; j >= 0; --j) {
+    int taken = 0;
+    for (int i = 0; i < k; ++i)
+      taken += is_leaf[j][i];
+    for (int i = 0; i < taken; ++i)
+      ++lens[i];
+    k = 2*(k - taken);
   }
-
-  dst->node_ct = node_ct;
-  dst->data_unit_bitlen = E_DATA_UNIT_4_BITS;
-  dst->leaf_ct = unique_ct;
-  return 0;
 }
 
-
-
-
-static int Huff_Tree_Fill_8b(HuffTree_t *dst, const byte *data, int byte_ct) {
-  int freq[256] = {0}, unique_vals[256] = {0};
-  int unique_ct=0;
-  byte currval;
-  do {
-    currval = *data++;
-    if (!(freq[currval]++)) {
-      unique_vals[unique_ct++] = currval;
+/**
+ * @summary Build the canonical tree for a set of code lengths out of pool, 
+ * bottom up: every level's subroots, then its leaves, get paired off in 
+ * order into the level above's subroots. Ids follow the same scheme as 
+ * Huff_Tree_Build's.
+ * @param pool Room for 2*leaf_ct-1 nodes.
+ * @return The root.
+ * */
+static HuffNode_t *Huff_Tree_Build_From_Codelens(HuffNode_t *pool, 
+    const HuffLeafEnt_t *leaves, const int *lens, int leaf_ct) {
+  HuffNode_t *row[leaf_ct], *next_row[leaf_ct];
+  int row_ct = 0, next_ct, node_ct = leaf_ct, leaf = 0;
+  for (int depth = lens[0]; depth > 0; --depth) {
+    // lens is nonincreasing, so this level's leaves sit right after the
+    // last level's
+    for (; leaf < leaf_ct && lens[leaf] == depth; ++leaf) {
+      pool[leaf] = (HuffNode_t) {
+        .data = leaves[leaf].data, .id = leaf, .height = 0, 
+        .freq = leaves[leaf].freq, .l = NULL, .r = NULL
+      };
+      row[row_ct++] = &pool[leaf];
     }
-  } while (--byte_ct);
-
-  if (unique_ct < 2) {
-    huff_errno = HUFF_ERROR_INPUT_TOO_UNIFORM;
-    return -1;
+    next_ct = 0;
+    for (int i = 0; i+1 < row_ct; i += 2) {
+      HuffNode_t *sub = &pool[node_ct];
+      *sub = (HuffNode_t) {
+        .data = -1, .id = node_ct++, 
+        .height = MAXIMUM(row[i]->height, row[i+1]->height) + 1,
+        .freq = row[i]->freq + row[i+1]->freq, .l = row[i], .r = row[i+1]
+      };
+      next_row[next_ct++] = sub;
+    }
+    memcpy(row, next_row, sizeof(*row)*next_ct);
+    row_ct = next_ct;
   }
+  return row[0];
+}
 
-  // NULL for alloc arg makes BST just insert data ptr passed to BST_Add calls
-  // directly. Pass deallocator for proper deallocations when BST_Close is 
-  // called during failure cases. Otherwise, if function is to return 
-  // successfully, BST_Close will be called on empty tree.
-  BST_t *valfreq_tree = BST_Init(Huff_Node_Cmp_Callback, NULL, 
-      Huff_Node_BST_Dealloc_Callback, 0ULL);
-  HuffNode_t *insert;
-  for (int i = 0; i < unique_ct; ++i) {
-    currval = unique_vals[i];
-    insert = Huff_Node_Create_Leaf(currval, freq[currval]);
-    if (!insert) {
-      // no need to set errno. already set by create_leaf
-      BST_Close(valfreq_tree);
+/**
+ * @summary Swap dst's tree out for the cheapest length-limited one that the
+ * GBA tree table can hold. The first try, limited to the tree's own height,
+ * costs nothing, and just reshapes the tree canonically; each one after 
+ * that is limited to one bit shorter, down to ceil(log2(leaf_ct)), i.e.: a
+ * complete tree.
+ * */
+static int Huff_Tree_Fit_GBA_Table(HuffCtx_t *ctx, HuffTree_t *dst, 
+    const HuffLeafEnt_t *leaves, int leaf_ct) {
+  HuffGBALayout_t layout;
+  HuffNode_t pool[2*leaf_ct-1], *nodes;
+  int lens[leaf_ct], min_len = 0;
+  while ((1<<min_len) < leaf_ct)
+    ++min_len;
+  for (int max_len = MINIMUM(dst->root->height, HUFF_CODELEN_MAX); 
+      max_len >= min_len; --max_len) {
+    Huff_Codelens_Limited(leaves, leaf_ct, max_len, lens);
+    if (0 > Huff_GBA_Layout_Plan(&layout, 
+          Huff_Tree_Build_From_Codelens(pool, leaves, lens, leaf_ct), 
+          2*leaf_ct-1))
+      continue;
+    // it fits, so build it again where it'll stay
+    if (!(nodes = Huff_Arena_Alloc(dst->arena, sizeof(*nodes)*(2*leaf_ct-1)))) {
+      ctx->err = HUFF_ERROR_ALLOCATION_FAILED;
       return -1;
     }
-    BST_Add(valfreq_tree, insert);
+    dst->root = Huff_Tree_Build_From_Codelens(nodes, leaves, lens, leaf_ct);
+    dst->bit_ct = Huff_Node_Bit_Ct(dst->root, 0);
+    return 0;
+  }
+  ctx->err = HUFF_ERROR_GBA_TABLE_ENTRY_OFS_OVERFLOW;
+  return -1;
+}
+
+/**
+ * @summary Two-queue Huffman construction. Leaves are sorted once by 
+ * (freq, data) and fed through one queue; merged subroots come out in 
+ * nondecreasing freq order, so they can just be appended to a second FIFO 
+ * queue. The next least-frequent node is always at the front of one of the
+ * two. Frequency ties are broken by node id: leaves get their rank in sorted 
+ * order and subroots get leaf_ct + merge order, so leaves win ties against 
+ * subroots and the resulting tree is fully deterministic.
+ * @param freq Frequency of each data unit, indexed by data unit value.
+ * @param unit_ct Length of freq (16 for 4-bit units, 256 for 8-bit units).
+ * */
+static int Huff_Tree_Build(HuffCtx_t *ctx, HuffTree_t *dst, const int *freq, int unit_ct, 
+    DataSize_e data_unit_bitlen) {
+  HuffLeafEnt_t leaves[unit_ct];
+  int leaf_ct = 0;
+  for (int i = 0; i < unit_ct; ++i) {
+    if (!freq[i])
+      continue;
+    leaves[leaf_ct++] = (HuffLeafEnt_t) { .data = i, .freq = freq[i] };
   }
-  if (BST_Element_Count(valfreq_tree) != unique_ct) {
-    huff_errno = HUFF_ERROR_FREQ_TREE_MISSING_NODES;
-    BST_Close(valfreq_tree);
+
+  if (leaf_ct < 2) {
+    ctx->err = HUFF_ERROR_INPUT_TOO_UNIFORM;
     return -1;
   }
-  HuffNode_t *node_1st_least, *node_2nd_least;
-  int node_ct = unique_ct;  // node ct so far = count of huff tree's leaf nodes
+  qsort(leaves, leaf_ct, sizeof(*leaves), Huff_Leaf_Ent_Cmp);
+
+  HuffNode_t *leafq[leaf_ct], *mergeq[leaf_ct-1], *least[2];
+  int leaf_front = 0, merge_front = 0, merge_back = 0, node_ct = leaf_ct;
+  for (int i = 0; i < leaf_ct; ++i)
+    if (!(leafq[i] = Huff_Node_Create_Leaf(ctx, dst->arena, leaves[i].data, 
+            leaves[i].freq, i)))
+      return -1;
+
   do {
-    node_1st_least = BST_Remove_Minimum(valfreq_tree);
-    node_2nd_least = BST_Remove_Minimum(valfreq_tree);
-    // Given previous checks, we definitely know subroot created won't be NULL
-    // so no need to check; can just pass it to BST_Add directly
-    BST_Add(valfreq_tree, 
-        Huff_Node_Create_Subroot(node_1st_least, node_2nd_least));
+    for (int i = 0; i < 2; ++i) {
+      if (merge_front == merge_back) {
+        least[i] = leafq[leaf_front++];
+      } else if (leaf_front == leaf_ct) {
+        least[i] = mergeq[merge_front++];
+      } else if (leafq[leaf_front]->freq <= mergeq[merge_front]->freq) {
+        // on freq tie, leaf's id is always the lesser of the two
+        least[i] = leafq[leaf_front++];
+      } else {
+        least[i] = mergeq[merge_front++];
+      }
+    }
     // every time we nest existing nodes, we add 1 node to final resulting
-    // hufftree, so increment node_ct with each loop.
-    ++node_ct;
-  } while (BST_Element_Count(valfreq_tree) > 1);
-  
-  if (!BST_Element_Count(valfreq_tree)) {
-    huff_errno = HUFF_ERROR_FREQ_TREE_MISSING_NODES;
-    BST_Close(valfreq_tree);
-    return -1;
-  }
+    // hufftree, so node_ct doubles as the new subroot's id.
+    if (!(mergeq[merge_back++] = Huff_Node_Create_Subroot(ctx, dst->arena, 
+            least[0], least[1], node_ct++)))
+      return -1;
+  } while (merge_back < leaf_ct-1);
 
-  dst->root = BST_Remove_Minimum(valfreq_tree);
-  
-  BST_Close(valfreq_tree);
+  dst->root = mergeq[merge_back-1];
 
   if (node_ct != Huff_Node_Get_Subroot_Node_Ct(dst->root)) {
-    huff_errno = HUFF_ERROR_UNEXPECTED_TREE_NODE_CT;
-    Huff_Node_Dealloc(dst->root);
+    ctx->err = HUFF_ERROR_UNEXPECTED_TREE_NODE_CT;
     dst->root = NULL;
     return -1;
   }
 
   dst->node_ct = node_ct;
-  dst->data_unit_bitlen = E_DATA_UNIT_8_BITS;
-  dst->leaf_ct = unique_ct;
+  dst->data_unit_bitlen = data_unit_bitlen;
+  dst->leaf_ct = leaf_ct;
+  dst->bit_ct = dst->unconstrained_bit_ct = Huff_Node_Bit_Ct(dst->root, 0);
+  {
+    HuffGBALayout_t layout;
+    if (0 <= Huff_GBA_Layout_Plan(&layout, dst->root, node_ct))
+      return 0;
+  }
+  if (0 > Huff_Tree_Fit_GBA_Table(ctx, dst, leaves, leaf_ct)) {
+    dst->root = NULL;
+    return -1;
+  }
   return 0;
 }
 
 // Even 8 is kind of ridiculously small tho tbh. We'll be generous here.
 #define DATA_LEN_MINIMUM 8
 
-
-HuffTree_t *Huff_Tree_Create(const void *data, int word_ct, DataSize_e edata_unit_bit_len) {
+HuffTree_t *Huff_Ctx_Tree_Create_From_Histogram(HuffCtx_t *ctx, 
+    const int *freq, DataSize_e edata_unit_bit_len) {
   HuffTree_t *ret=NULL;
-  if (!data) {
-    huff_errno = HUFF_ERROR_DATA_GIVEN_IS_NULL;
-    return NULL;
-  }
-  int outcome;
-  if (word_ct < DATA_LEN_MINIMUM) {
-    huff_errno = HUFF_ERROR_INPUT_TOO_SHORT;
+  long unit_total = 0;
+  int unit_ct;
+  if (!freq) {
+    ctx->err = HUFF_ERROR_DATA_GIVEN_IS_NULL;
     return NULL;
-
   }
 
   switch (edata_unit_bit_len) {
   case E_DATA_UNIT_4_BITS:
-    outcome = Huff_Tree_Fill_4b(ret=calloc(1,sizeof(*ret)), data, word_ct*4);
-    break;
   case E_DATA_UNIT_8_BITS:
-    outcome = Huff_Tree_Fill_8b(ret=calloc(1,sizeof(*ret)), data, word_ct*4);
     break;
   default:
-    huff_errno = HUFF_ERROR_UNSUPPORTED_FEATURE;
+    ctx->err = HUFF_ERROR_UNSUPPORTED_FEATURE;
     return NULL;
   }
-  if (0 > outcome) {
-    // if we're here, huff_errno will have already been set by Huff_Tree_Fill_8b
-    free(ret);
+  unit_ct = 1<<edata_unit_bit_len;
+  for (int i = 0; i < unit_ct; ++i)
+    unit_total += freq[i];
+  if (unit_total < (DATA_LEN_MINIMUM*32/edata_unit_bit_len)) {
+    ctx->err = HUFF_ERROR_INPUT_TOO_SHORT;
+    return NULL;
+  }
+
+  // The tree handle, every one of its nodes, and anything else tree 
+  // construction needs to keep around all live in one arena, so tearing the 
+  // tree down is just dropping the arena.
+  HuffArena_t *arena = Huff_Arena_Create(0);
+  if (!arena || !(ret = Huff_Arena_Calloc(arena, 1, sizeof(*ret)))) {
+    ctx->err = HUFF_ERROR_ALLOCATION_FAILED;
+    Huff_Arena_Destroy(arena);
+    return NULL;
+  }
+  ret->arena = arena;
+  if (0 > Huff_Tree_Build(ctx, ret, freq, unit_ct, edata_unit_bit_len)) {
+    // if we're here, ctx->err will have already been set by Huff_Tree_Build
+    Huff_Arena_Destroy(arena);
     return NULL;
   }
   return ret;
 }
 
-void Huff_Tree_Destroy(HuffTree_t *tree) {
-  if (!tree)
-    return;
-  Huff_Node_Dealloc(tree->root);
-  free(tree);
+HuffTree_t *Huff_Tree_Create_From_Histogram(const int *freq, 
+    DataSize_e edata_unit_bit_len) {
+  return Huff_Ctx_Tree_Create_From_Histogram(&huff_default_ctx, freq, 
+      edata_unit_bit_len);
 }
 
-static uint32_t *Huff_Compress_4B(const byte *data, HuffTree_t *tree, 
-    int byte_ct, int *return_word_ct) {
-  CodeBase_t *codebase = Huff_Codebase_Create(tree);
-  if (!codebase) {
-    huff_errno = HUFF_ERROR_CODEBASE_ERR;
-    *return_word_ct = 0;
+HuffTree_t *Huff_Ctx_Tree_Create(HuffCtx_t *ctx, const void *data, 
+    int word_ct, DataSize_e edata_unit_bit_len) {
+  int *freq = ctx->freq;
+  if (!data) {
+    ctx->err = HUFF_ERROR_DATA_GIVEN_IS_NULL;
     return NULL;
   }
-  int max_words = (tree->root->height+1)*(byte_ct*2);
-  if (31&max_words) {
-    max_words/=32;
-    ++max_words;
-  } else {
-    max_words/=32;
-  }
-  uint64_t code;
-  uint32_t *ret, sbuf[max_words], *bufcursor = sbuf, curr_word=0, word_ct=0, 
-           tmp, tmpcode;
-  int curr_b=31, codelen=0;
-  CodeEntry_t *codent = NULL;
-  byte currpair, currval, sides_done;
-  memset(sbuf, 0, sizeof(sbuf));
-  do {
-    currpair = *data++;
-    for (currval = 15&currpair, sides_done = 0; 
-        sides_done^3;
-        currval = (currpair>>4)&15, sides_done |= (sides_done&1) ? 2 : 1) {
-      
-      codent = Huff_Codebase_Get_Code(codebase, currval);
-      if (!codent) {
-        Huff_Codebase_Destroy(codebase);
-        huff_errno = HUFF_ERROR_CODEBASE_MISSING_ENTRY;
-        *return_word_ct = 0;
-        return NULL;
-      }
-      code = codent->code;
-      codelen = codent->codelen;
-      while ((curr_b - codelen) < -1) {
-        tmp = codelen;
-        codelen -= curr_b;
-        tmp -= --codelen;
-        tmpcode = code>>codelen;  // shift out all code bits that won't be in 
-                                  // this byte, but the next byte.
-        for (int i = tmp - 1; i > -1; --i)
-          if (tmpcode&(1<<i))
-            curr_word |= (1<<curr_b--);
-          else
-            curr_word &= ~(1<<curr_b--);
- 
-        curr_b = 31;
-        *bufcursor++ = curr_word;
-        curr_word = 0;
-        ++word_ct;
-      }
- 
-      for (int i = codelen - 1; i > -1; --i)
-        if (code&(1<<i))
-          curr_word |= (1<<curr_b--);
-        else
-         curr_word &= ~(1<<curr_b--);
-    }
-  } while (--byte_ct);
+  if (word_ct < DATA_LEN_MINIMUM) {
+    ctx->err = HUFF_ERROR_INPUT_TOO_SHORT;
+    return NULL;
 
-  if (bufcursor < (&sbuf[max_words]) && curr_b != 31) {
-    *bufcursor++ = curr_word;
-    ++word_ct;
   }
-  ret = malloc(sizeof(*ret)*word_ct);
-  memcpy(ret, sbuf, sizeof(*ret)*word_ct);
-  *return_word_ct = word_ct;
-  Huff_Codebase_Destroy(codebase);
-  return ret;
 
+  memset(freq, 0, sizeof(ctx->freq));
+  Huff_Histogram_Add(freq, data, word_ct*4, edata_unit_bit_len);
+  return Huff_Ctx_Tree_Create_From_Histogram(ctx, freq, edata_unit_bit_len);
+}
+
+HuffTree_t *Huff_Tree_Create(const void *data, int word_ct, 
+    DataSize_e edata_unit_bit_len) {
+  return Huff_Ctx_Tree_Create(&huff_default_ctx, data, word_ct, 
+      edata_unit_bit_len);
 }
 
+void Huff_Tree_Destroy(HuffTree_t *tree) {
+  if (!tree)
+    return;
+  Huff_Arena_Destroy(tree->arena);
+}
+
+uint32_t Huff_Tree_Encoded_Word_Ct(const HuffTree_t *tree) {
+  if (!tree || !tree->root) 
+    return 0;
+  return (tree->bit_ct+31)/32;
+}
+
+/// Byte size of a tree's GBA table, size byte and padding to a word boundary included
+static int Huff_GBA_Table_Size(int node_ct) {
+  return (node_ct + 1 + 3)&~3;
+}
+
+uint32_t Huff_Tree_GBA_Byte_Ct(const HuffTree_t *tree) {
+  if (!tree || !tree->root) 
+    return 0;
+  return sizeof(HuffHeader_GBA_t) + Huff_GBA_Table_Size(tree->node_ct) 
+    + 4*Huff_Tree_Encoded_Word_Ct(tree);
+}
 
-static uint32_t *Huff_Compress_8B(const byte *data, HuffTree_t *tree, 
-    int byte_ct, int *return_word_ct) {
-  CodeBase_t *codebase = Huff_Codebase_Create(tree);
-  if (!codebase) {
-    huff_errno = HUFF_ERROR_CODEBASE_ERR;
-    *return_word_ct = 0;
+HuffTree_t *Huff_Ctx_Tree_Create_Smallest(HuffCtx_t *ctx, const int *byte_freq,
+    uint32_t return_byte_cts[2]) {
+  HuffTree_t *tree4, *tree8;
+  int nibble_freq[16] = {0};
+  if (!byte_freq) {
+    ctx->err = HUFF_ERROR_DATA_GIVEN_IS_NULL;
     return NULL;
   }
-  int max_words = (tree->root->height+1)*(byte_ct);
-  if (31&max_words) {
-    max_words/=32;
-    ++max_words;
-  } else {
-    max_words/=32;
-  }
-  uint64_t code;
-  uint32_t *ret, sbuf[max_words], *bufcursor = sbuf, curr_word=0, word_ct=0, 
-           tmp, tmpcode;
-  int curr_b=31, codelen=0;
-  CodeEntry_t *codent = NULL;
-  memset(sbuf, 0, sizeof(sbuf));
-  do {
-    codent = Huff_Codebase_Get_Code(codebase, *data++);
-    if (!codent) {
-      Huff_Codebase_Destroy(codebase);
-      huff_errno = HUFF_ERROR_CODEBASE_MISSING_ENTRY;
-      *return_word_ct = 0;
-      return NULL;
-    }
-    code = codent->code;
-    codelen = codent->codelen;
-    while ((curr_b - codelen) < -1) {
-      tmp = codelen;
-      codelen -= curr_b;
-      tmp -= --codelen;
-      tmpcode = code>>codelen;  // shift out all code bits that won't be in 
-                                // this byte, but the next byte.
-      for (int i = tmp - 1; i > -1; --i)
-        if (tmpcode&(1<<i))
-          curr_word |= (1<<curr_b--);
-        else
-          curr_word &= ~(1<<curr_b--);
-
-      curr_b = 31;
-      *bufcursor++ = curr_word;
-      curr_word = 0;
-      ++word_ct;
-    }
+  // every byte holds one of each nibble
+  for (int i = 0; i < 256; ++i) {
+    nibble_freq[i&15] += byte_freq[i];
+    nibble_freq[i>>4] += byte_freq[i];
+  }
+  // Either one can fail where the other doesn't, e.g.: a single repeated 
+  // byte value is too uniform for 8 bits, but not for 4 if its nibbles differ
+  tree4 = Huff_Ctx_Tree_Create_From_Histogram(ctx, nibble_freq, 
+      E_DATA_UNIT_4_BITS);
+  tree8 = Huff_Ctx_Tree_Create_From_Histogram(ctx, byte_freq, 
+      E_DATA_UNIT_8_BITS);
+  if (return_byte_cts) {
+    return_byte_cts[0] = Huff_Tree_GBA_Byte_Ct(tree4);
+    return_byte_cts[1] = Huff_Tree_GBA_Byte_Ct(tree8);
+  }
+  if (!tree4 || !tree8) 
+    return tree4 ? tree4 : tree8;
+  // ties go to 8 bits, which the BIOS decodes in half the units
+  if (Huff_Tree_GBA_Byte_Ct(tree4) < Huff_Tree_GBA_Byte_Ct(tree8)) {
+    Huff_Tree_Destroy(tree8);
+    return tree4;
+  }
+  Huff_Tree_Destroy(tree4);
+  return tree8;
+}
 
-    for (int i = codelen - 1; i > -1; --i)
-      if (code&(1<<i))
-        curr_word |= (1<<curr_b--);
-      else
-       curr_word &= ~(1<<curr_b--);
-  } while (--byte_ct);
+HuffTree_t *Huff_Tree_Create_Smallest(const int *byte_freq, 
+    uint32_t return_byte_cts[2]) {
+  return Huff_Ctx_Tree_Create_Smallest(&huff_default_ctx, byte_freq, 
+      return_byte_cts);
+}
 
-  if (bufcursor < (&sbuf[max_words]) && curr_b != 31) {
-    *bufcursor++ = curr_word;
-    ++word_ct;
+/* Encode loops shared by Huff_Compress and the streaming encoder. Both 
+ * return the count of bytes fully encoded, which only falls short of 
+ * byte_ct when data has a unit the codebase has no code for. */
+static int Huff_Encode_4B(const CodeBase_t *codebase, HuffBitWriter_t *bw,
+    const byte *data, int byte_ct) {
+  const CodeEntry_t *lo, *hi;
+  byte currpair;
+  for (int i = 0; i < byte_ct; ++i) {
+    currpair = data[i];
+    // low nibble goes first, as the BIOS fills each output unit LSB-first
+    lo = &codebase->entries[currpair&15];
+    hi = &codebase->entries[(currpair>>4)&15];
+    if (!lo->codelen || !hi->codelen)
+      return i;
+    Huff_BitWriter_Put(bw, lo->code, lo->codelen);
+    Huff_BitWriter_Put(bw, hi->code, hi->codelen);
   }
-  ret = malloc(sizeof(*ret)*word_ct);
-  memcpy(ret, sbuf, sizeof(*ret)*word_ct);
-  *return_word_ct = word_ct;
-  Huff_Codebase_Destroy(codebase);
-  return ret;
+  return byte_ct;
+}
 
+static int Huff_Encode_8B(const CodeBase_t *codebase, HuffBitWriter_t *bw,
+    const byte *data, int byte_ct) {
+  const CodeEntry_t *codent;
+  for (int i = 0; i < byte_ct; ++i) {
+    codent = &codebase->entries[data[i]];
+    if (!codent->codelen)
+      return i;
+    Huff_BitWriter_Put(bw, codent->code, codent->codelen);
+  }
+  return byte_ct;
 }
 
-uint32_t *Huff_Compress(const void *data, HuffTree_t *hufftree, int word_ct, 
-    int *return_word_ct) {
+#define HUFF_ENCODE(codebase, bw, data, byte_ct) \
+  (((codebase)->data_unit_bitlen == E_DATA_UNIT_4_BITS) \
+    ? Huff_Encode_4B(codebase, bw, data, byte_ct) \
+    : Huff_Encode_8B(codebase, bw, data, byte_ct))
+
+/// Validate compression args and fill ctx's codebase from hufftree.
+static int Huff_Compress_Prepare(HuffCtx_t *ctx, const void *data, 
+    const HuffTree_t *hufftree, int word_ct) {
   if (!data) {
-    huff_errno = HUFF_ERROR_DATA_GIVEN_IS_NULL;
-    *return_word_ct = 0;
-    return NULL;
+    ctx->err = HUFF_ERROR_DATA_GIVEN_IS_NULL;
+    return -1;
   }
 
   if (word_ct < DATA_LEN_MINIMUM) {
-    huff_errno = HUFF_ERROR_INPUT_TOO_SHORT;
-    *return_word_ct = 0;
-    return NULL;
+    ctx->err = HUFF_ERROR_INPUT_TOO_SHORT;
+    return -1;
   }
   
   if (!hufftree) {
-    huff_errno = HUFF_ERROR_NO_TREE_SUPPLIED;
-    *return_word_ct = 0;
-    return NULL;
+    ctx->err = HUFF_ERROR_NO_TREE_SUPPLIED;
+    return -1;
   }
-  uint32_t *ret = NULL;
   switch (hufftree->data_unit_bitlen) {
   case E_DATA_UNIT_4_BITS:
-    ret = Huff_Compress_4B(data, hufftree, word_ct*4, return_word_ct);
-    break;
   case E_DATA_UNIT_8_BITS:
-    ret = Huff_Compress_8B(data, hufftree, word_ct*4, return_word_ct);
     break;
   default:
-    huff_errno = HUFF_ERROR_UNSUPPORTED_FEATURE;
-    break;
+    ctx->err = HUFF_ERROR_UNSUPPORTED_FEATURE;
+    return -1;
+  }
+  if (0 > Huff_Ctx_Codebase_Init(ctx, &ctx->codebase, hufftree)) {
+    ctx->err = HUFF_ERROR_CODEBASE_ERR;
+    return -1;
+  }
+  return 0;
+}
+
+/**
+ * @summary Exact bit count data encodes to, from a histogram of it.
+ * @param freq Scratch for the histogram. Needs 1<<data_unit_bitlen entries.
+ * @return 0 on success, -1 iff data has a unit the codebase has no code for.
+ * */
+static int Huff_Encoded_Bit_Ct(const CodeBase_t *codebase, int *freq, 
+    const byte *data, int byte_ct, uint64_t *bit_ct) {
+  int unit_ct = 1<<codebase->data_unit_bitlen;
+  uint64_t ret = 0;
+  memset(freq, 0, sizeof(*freq)*unit_ct);
+  Huff_Histogram_Add(freq, data, byte_ct, codebase->data_unit_bitlen);
+  for (int i = 0; i < unit_ct; ++i) {
+    if (!freq[i])
+      continue;
+    if (!codebase->entries[i].codelen)
+      return -1;
+    ret += ((uint64_t)freq[i])*codebase->entries[i].codelen;
+  }
+  *bit_ct = ret;
+  return 0;
+}
+
+uint32_t *Huff_Ctx_Compress(HuffCtx_t *ctx, const void *data, 
+    HuffTree_t *hufftree, int word_ct, int *return_word_ct) {
+  *return_word_ct = 0;
+  if (0 > Huff_Compress_Prepare(ctx, data, hufftree, word_ct))
+    return NULL;
+  CodeBase_t *codebase = &ctx->codebase;
+
+  // Size the output exactly from a histogram of the data instead of
+  // guessing an upper bound from the tree height.
+  uint64_t bit_ct;
+  if (0 > Huff_Encoded_Bit_Ct(codebase, ctx->freq, data, word_ct*4, &bit_ct)) {
+    ctx->err = HUFF_ERROR_CODEBASE_MISSING_ENTRY;
+    return NULL;
   }
-  if (ret==NULL) {
-    // if here, then huff_errno must have been set by a called function in
-    // switch statement
-    *return_word_ct = 0;
+
+  uint32_t *ret = Huff_Ctx_Alloc(ctx, sizeof(*ret)*((bit_ct+31)/32));
+  HuffBitWriter_t bw;
+  if (!ret) {
+    ctx->err = HUFF_ERROR_ALLOCATION_FAILED;
     return NULL;
   }
+  Huff_BitWriter_Init(&bw, ret);
+  HUFF_ENCODE(codebase, &bw, data, word_ct*4);
+  *return_word_ct = Huff_BitWriter_Flush(&bw) - ret;
+  return ret;
+}
+
+// Chunks any smaller aren't worth a thread's time.
+#define HUFF_PARALLEL_MIN_CHUNK (64*1024)
+// More chunks than threads, so one slow chunk doesn't hold everyone up.
+#define HUFF_PARALLEL_CHUNKS_PER_THREAD 4
+
+typedef struct s_huff_chunk {
+  const CodeBase_t *codebase;
+  const byte *data;
+  int byte_ct;
+  uint64_t bit_ofs;  /// Where the chunk starts in the bitstream
+  uint64_t bit_ct;
+  uint32_t *out;  /// Start of the whole bitstream, not just this chunk
+  uint32_t tail;  /// Trailing partial word, ORed into out after the join
+} HuffChunk_t;
+
+static int Huff_Chunk_Measure_Cb(HuffCtx_t *ctx, void *job) {
+  HuffChunk_t *chunk = job;
+  if (0 > Huff_Encoded_Bit_Ct(chunk->codebase, ctx->freq, chunk->data, 
+        chunk->byte_ct, &chunk->bit_ct)) {
+    ctx->err = HUFF_ERROR_CODEBASE_MISSING_ENTRY;
+    return -1;
+  }
+  return 0;
+}
+
+/* A chunk starting mid-word writes its first word with the bits before its 
+ * offset left zero, and keeps its last partial word to itself instead of 
+ * flushing it, since both of those words are shared with its neighbours.
+ * Every other word is the chunk's alone, so no two threads ever store to the 
+ * same word. Chunks are big enough that each one fills at least one word. */
+static int Huff_Chunk_Encode_Cb(HuffCtx_t *ctx, void *job) {
+  HuffChunk_t *chunk = job;
+  HuffBitWriter_t bw;
+  (void)ctx;
+  Huff_BitWriter_Init_At(&bw, chunk->out + chunk->bit_ofs/32, 
+      chunk->bit_ofs%32);
+  HUFF_ENCODE(chunk->codebase, &bw, chunk->data, chunk->byte_ct);
+  chunk->tail = bw.acc_len ? (uint32_t)(bw.acc>>32) : 0;
+  return 0;
+}
+
+uint32_t *Huff_Ctx_Compress_Parallel(HuffCtx_t *ctx, const void *data, 
+    HuffTree_t *hufftree, int word_ct, int *return_word_ct, int thread_ct) {
+  const int byte_ct = word_ct*4;
+  int chunk_ct, chunk_len;
+  if (thread_ct <= 0)
+    thread_ct = Batch_Default_Thread_Ct();
+  chunk_ct = MINIMUM(thread_ct*HUFF_PARALLEL_CHUNKS_PER_THREAD, 
+      byte_ct/HUFF_PARALLEL_MIN_CHUNK);
+  if (thread_ct == 1 || chunk_ct < 2)
+    return Huff_Ctx_Compress(ctx, data, hufftree, word_ct, return_word_ct);
+
+  *return_word_ct = 0;
+  if (0 > Huff_Compress_Prepare(ctx, data, hufftree, word_ct))
+    return NULL;
+  HuffChunk_t *chunks = malloc(sizeof(*chunks)*chunk_ct);
+  uint32_t *ret = NULL;
+  uint64_t bit_ct = 0;
+  if (!chunks) {
+    ctx->err = HUFF_ERROR_ALLOCATION_FAILED;
+    return NULL;
+  }
+  chunk_len = byte_ct/chunk_ct;
+  for (int i = 0; i < chunk_ct; ++i) {
+    chunks[i] = (HuffChunk_t) {
+      .codebase = &ctx->codebase,
+      .data = (const byte*)data + i*chunk_len,
+      .byte_ct = (i == chunk_ct-1) ? byte_ct - i*chunk_len : chunk_len
+    };
+  }
+
+  // Pass 1: every chunk's exact bit length. Prefix sum gives their offsets.
+  if (Batch_Run(chunks, sizeof(*chunks), chunk_ct, thread_ct, 
+        Huff_Chunk_Measure_Cb)) {
+    ctx->err = HUFF_ERROR_CODEBASE_MISSING_ENTRY;
+    free(chunks);
+    return NULL;
+  }
+  for (int i = 0; i < chunk_ct; ++i) {
+    chunks[i].bit_ofs = bit_ct;
+    bit_ct += chunks[i].bit_ct;
+  }
+  if (!(ret = Huff_Ctx_Alloc(ctx, sizeof(*ret)*((bit_ct+31)/32)))) {
+    ctx->err = HUFF_ERROR_ALLOCATION_FAILED;
+    free(chunks);
+    return NULL;
+  }
+
+  // Pass 2: encode every chunk in place, then stitch the boundary words.
+  for (int i = 0; i < chunk_ct; ++i)
+    chunks[i].out = ret;
+  Batch_Run(chunks, sizeof(*chunks), chunk_ct, thread_ct, 
+      Huff_Chunk_Encode_Cb);
+  for (int i = 0; i < chunk_ct; ++i) {
+    uint64_t end = chunks[i].bit_ofs + chunks[i].bit_ct;
+    if (!(end&31))
+      continue;
+    // last chunk's tail word has no next chunk's head to merge into
+    if (i == chunk_ct-1)
+      ret[end/32] = chunks[i].tail;
+    else
+      ret[end/32] |= chunks[i].tail;
+  }
+  free(chunks);
+  *return_word_ct = (bit_ct+31)/32;
+  return ret;
+}
+
+uint32_t *Huff_Compress_Parallel(const void *data, HuffTree_t *hufftree, 
+    int word_ct, int *return_word_ct, int thread_ct) {
+  return Huff_Ctx_Compress_Parallel(&huff_default_ctx, data, hufftree, 
+      word_ct, return_word_ct, thread_ct);
+}
 
+uint32_t *Huff_Compress(const void *data, HuffTree_t *hufftree, int word_ct, 
+    int *return_word_ct) {
+  return Huff_Ctx_Compress(&huff_default_ctx, data, hufftree, word_ct, 
+      return_word_ct);
+}
+
+// Bytes encoded per sink call. Bounds the encoder's word buffer to 
+// HUFF_ENCODER_CHUNK*(max codelen)/32 words, whatever the input size.
+#define HUFF_ENCODER_CHUNK 4096
+
+struct s_huff_encoder {
+  HuffCtx_t *ctx;  /// Where errors and the encoder's own memory go
+  CodeBase_t codebase;
+  HuffBitWriter_t bw;
+  Huff_Word_Sink_Cb_t sink;
+  void *sink_ctx;
+  uint32_t words_emitted;
+  int buf_len;
+  uint32_t buf[];
+};
+
+HuffEncoder_t *Huff_Ctx_Encoder_Create(HuffCtx_t *ctx, const HuffTree_t *tree, 
+    Huff_Word_Sink_Cb_t sink, void *sink_ctx) {
+  HuffEncoder_t *ret;
+  int buf_len;
+  if (!tree || !tree->root) {
+    ctx->err = HUFF_ERROR_NO_TREE_SUPPLIED;
+    return NULL;
+  }
+  // worst case chunk: every unit gets the longest code (which is the
+  // tree's height), plus one word for whatever is pending from last chunk
+  buf_len = (HUFF_ENCODER_CHUNK*(8/tree->data_unit_bitlen)*
+      tree->root->height + 31)/32 + 1;
+  if (!(ret = Huff_Ctx_Alloc(ctx, sizeof(*ret) + sizeof(uint32_t)*buf_len))) {
+    ctx->err = HUFF_ERROR_ALLOCATION_FAILED;
+    return NULL;
+  }
+  if (0 > Huff_Ctx_Codebase_Init(ctx, &ret->codebase, tree)) {
+    ctx->err = HUFF_ERROR_CODEBASE_ERR;
+    Huff_Ctx_Free(ctx, ret);
+    return NULL;
+  }
+  ret->ctx = ctx;
+  ret->sink = sink;
+  ret->sink_ctx = sink_ctx;
+  ret->words_emitted = 0;
+  ret->buf_len = buf_len;
+  Huff_BitWriter_Init(&ret->bw, ret->buf);
   return ret;
 }
 
+HuffEncoder_t *Huff_Encoder_Create(const HuffTree_t *tree, 
+    Huff_Word_Sink_Cb_t sink, void *sink_ctx) {
+  return Huff_Ctx_Encoder_Create(&huff_default_ctx, tree, sink, sink_ctx);
+}
+
+int Huff_Encoder_Feed(HuffEncoder_t *enc, const void *data, int byte_ct) {
+  const byte *cursor = data;
+  int chunk, word_ct;
+  while (byte_ct > 0) {
+    chunk = byte_ct < HUFF_ENCODER_CHUNK ? byte_ct : HUFF_ENCODER_CHUNK;
+    if (chunk != HUFF_ENCODE(&enc->codebase, &enc->bw, cursor, chunk)) {
+      enc->ctx->err = HUFF_ERROR_CODEBASE_MISSING_ENTRY;
+      return -1;
+    }
+    // hand off every complete word; partial word stays in the accumulator
+    if ((word_ct = enc->bw.cursor - enc->buf)) {
+      enc->sink(enc->buf, word_ct, enc->sink_ctx);
+      enc->words_emitted += word_ct;
+      enc->bw.cursor = enc->buf;
+    }
+    cursor += chunk;
+    byte_ct -= chunk;
+  }
+  return 0;
+}
+
+int Huff_Encoder_Finish(HuffEncoder_t *enc) {
+  if (Huff_BitWriter_Flush(&enc->bw) != enc->buf) {
+    enc->sink(enc->buf, 1, enc->sink_ctx);
+    ++enc->words_emitted;
+    enc->bw.cursor = enc->buf;
+  }
+  return enc->words_emitted;
+}
+
+void Huff_Encoder_Destroy(HuffEncoder_t *enc) {
+  if (!enc)
+    return;
+  Huff_Ctx_Free(enc->ctx, enc);
+}
 
-#define HUFF_GBA_NODE_OFS(cur, next) \
-  ((((uintptr_t)next) - 2 - (((uintptr_t)cur) & (~1ULL))) / 2) 
 
 #define soft_assert(expr) do if (!(expr)) {\
     fputs("\x1b[1;32m[Warning]:\x1b[2;34m Soft assertion, \x1b[1;33m\"" #expr "\",\x1b[2;31m failed.\x1b[0m\n", stderr); \
@@ -573,36 +874,42 @@ uint32_t *Huff_Compress(const void *data, HuffTree_t *hufftree, int word_ct,
 
 
 
-HuffNode_GBA_t *Huff_GBA_Huff_Table_Create(const HuffTree_t *tree, 
-    int *return_table_size) {
-  const HuffNode_t *root = tree->root;
-  HuffNode_GBA_t *ret, *cur, *next_free;
-  const int datamask = UNITS_MASK(tree->data_unit_bitlen);
-  int size;
+HuffNode_GBA_t *Huff_Ctx_GBA_Huff_Table_Create(HuffCtx_t *ctx, 
+    const HuffTree_t *tree, int *return_table_size) {
+  const HuffNode_t *root;
+  HuffNode_GBA_t *ret;
+  HuffGBALayout_t layout;
+  int size, datamask;
   *return_table_size = 0;
 
+  if (!tree || !tree->root) {
+    ctx->err = HUFF_ERROR_NO_TREE_SUPPLIED;
+    return NULL;
+  }
+  root = tree->root;
+  datamask = UNITS_MASK(tree->data_unit_bitlen);
   if (datamask > 255) {
     // TODO: Add support for data units larger than byte
-    huff_errno = HUFF_ERROR_UNSUPPORTED_FEATURE;
+    ctx->err = HUFF_ERROR_UNSUPPORTED_FEATURE;
     return NULL;
   }
-  if (!tree) {
-    huff_errno = HUFF_ERROR_NO_TREE_SUPPLIED;
+    
+  if (tree->node_ct + 1 < 4) {
+    ctx->err = HUFF_ERROR_UNEXPECTED_TREE_NODE_CT;
     return NULL;
   }
-    
-  size = tree->node_ct + 1;
-  if (size < 4) {
-    huff_errno = HUFF_ERROR_UNEXPECTED_TREE_NODE_CT;
+  // padded so the compressed data after it stays word-aligned
+  size = Huff_GBA_Table_Size(tree->node_ct);
+  // Never fails for trees made by Huff_Tree_Create, since it already made
+  // sure they'd fit.
+  if (0 > Huff_GBA_Layout_Plan(&layout, root, tree->node_ct)) {
+    ctx->err = HUFF_ERROR_GBA_TABLE_ENTRY_OFS_OVERFLOW;
     return NULL;
   }
-  if (size&3) {
-    // aka if size will cause compressed data portion to dealign from word 
-    // boundary, then pad it so that size is word-alignable
-    size &= ~3;  // round down to nearest multiple of four.
-    size += 4;  // then add 4, essentially doing a base 4 ceil on size.
+  if (!(ret = Huff_Ctx_Alloc(ctx, sizeof(*ret)*size))) {
+    ctx->err = HUFF_ERROR_ALLOCATION_FAILED;
+    return NULL;
   }
-  ret = malloc(sizeof(*ret)*size);
   ret[0].leaf = size/2-1;  // first entry in table is, in reality, is not really 
                            // a hufftree leaf, but, in fact, just another 
                            // header field, which is equal to a mathematical 
@@ -610,59 +917,123 @@ HuffNode_GBA_t *Huff_GBA_Huff_Table_Create(const HuffTree_t *tree,
                            // ofs := the offset of the compressed bitstream from
                            // just after huffman header, which is exactly equal
                            // to size of data region malloc'd for ret.
-  cur = &ret[1], next_free = &ret[2];
-  cur->subroot = (HuffSubroot_GBA_t) { 
-    .descendants_ofs = HUFF_GBA_NODE_OFS(cur, next_free),
-    .r_is_leaf = HUFF_NODE_IS_LEAF(tree->root->r),
-    .l_is_leaf = HUFF_NODE_IS_LEAF(tree->root->l)
-  };
+  // zero the padding, so the table's tail is deterministic
+  memset(&ret[tree->node_ct+1], 0, sizeof(*ret)*(size - tree->node_ct - 1));
   {
-    const HuffNode_t *in_stack[tree->node_ct+1];
-    HuffNode_GBA_t *out_stack[tree->node_ct+1];
-    int top = -1;
-
-    in_stack[++top] = root->l;
-    out_stack[top] = next_free++;
-    in_stack[++top] = root->r;
-    out_stack[top] = next_free++;
-    do {
-      root = in_stack[top];
-      cur = out_stack[top--];
-      if (HUFF_NODE_IS_LEAF(root)) {
-        cur->leaf = root->data[0]&datamask;
-        continue;
-      }
-      cur->subroot = (HuffSubroot_GBA_t) {
-        .descendants_ofs = HUFF_GBA_NODE_OFS(cur, next_free),
-        .r_is_leaf = HUFF_NODE_IS_LEAF(root->r),
-        .l_is_leaf = HUFF_NODE_IS_LEAF(root->l),
+    int idx_of[tree->node_ct], at, ofs;
+    const HuffNode_t *owner;
+    idx_of[root->id] = 1;
+    for (int slot = 1; slot < layout.slot_ct; ++slot) {
+      owner = layout.owners[slot];
+      at = idx_of[owner->id];
+      ofs = slot - at/2 - 1;
+      ret[at].subroot = (HuffSubroot_GBA_t) {
+        .descendants_ofs = ofs,
+        .r_is_leaf = HUFF_NODE_IS_LEAF(owner->r),
+        .l_is_leaf = HUFF_NODE_IS_LEAF(owner->l),
       };
-      if (cur->subroot.descendants_ofs != HUFF_GBA_NODE_OFS(cur, next_free)) {
-        huff_errno = HUFF_ERROR_GBA_TABLE_ENTRY_OFS_OVERFLOW;
-        free(ret);
+      if (ret[at].subroot.descendants_ofs != ofs) {
+        ctx->err = HUFF_ERROR_GBA_TABLE_ENTRY_OFS_OVERFLOW;
+        Huff_Ctx_Free(ctx, ret);
         return NULL;
       }
-      in_stack[++top] = root->l;
-      out_stack[top] = next_free++;
-      in_stack[++top] = root->r;
-      out_stack[top] = next_free++;
-    } while (top > -1);
+      if (HUFF_NODE_IS_LEAF(owner->l))
+        ret[2*slot].leaf = owner->l->data&datamask;
+      else
+        idx_of[owner->l->id] = 2*slot;
+      if (HUFF_NODE_IS_LEAF(owner->r))
+        ret[2*slot+1].leaf = owner->r->data&datamask;
+      else
+        idx_of[owner->r->id] = 2*slot+1;
+    }
+  }
+  if (0 > Huff_Ctx_GBA_Huff_Table_Verify(ctx, ret, size, 
+        tree->data_unit_bitlen)) {
+    Huff_Ctx_Free(ctx, ret);
+    return NULL;
   }
   
   *return_table_size = size;
   return ret;
 }
 
-#define HUFF_HEADER_GBA_COMPRESSION_TYPE_ID 0x02
-int Huff_GBA_Header_Init(HuffHeader_GBA_t *dst, int decompressed_data_bytelen,
+HuffNode_GBA_t *Huff_GBA_Huff_Table_Create(const HuffTree_t *tree, 
+    int *return_table_size) {
+  return Huff_Ctx_GBA_Huff_Table_Create(&huff_default_ctx, tree, 
+      return_table_size);
+}
+
+int Huff_Ctx_GBA_Huff_Table_Verify(HuffCtx_t *ctx, 
+    const HuffNode_GBA_t *table, int table_size, DataSize_e data_unit_bitlen) {
+  if (!table) {
+    ctx->err = HUFF_ERROR_NO_TREE_SUPPLIED;
+    return -1;
+  }
+  if (table_size < 4 || (table_size&3) || table[0].leaf != table_size/2-1) {
+    ctx->err = HUFF_ERROR_GBA_TABLE_MALFORMED;
+    return -1;
+  }
+  bool seen[table_size];
+  int stack[table_size], top = -1, used = 2, at, child;
+  memset(seen, 0, sizeof(seen));
+  seen[0] = seen[1] = true;
+  stack[++top] = 1;
+  do {
+    at = stack[top--];
+    HuffSubroot_GBA_t subroot = table[at].subroot;
+    // same address math as the BIOS, on table indices instead of addresses
+    child = (at&~1) + 2*subroot.descendants_ofs + 2;
+    if (child+1 >= table_size) {
+      ctx->err = HUFF_ERROR_GBA_TABLE_ENTRY_OFS_OVERFLOW;
+      return -1;
+    }
+    // every entry has exactly one parent, or the walk isn't a tree
+    if (seen[child] || seen[child+1]) {
+      ctx->err = HUFF_ERROR_GBA_TABLE_MALFORMED;
+      return -1;
+    }
+    seen[child] = seen[child+1] = true;
+    used = MAXIMUM(used, child+2);
+    for (int side = 0; side < 2; ++side) {
+      if (!(side ? subroot.r_is_leaf : subroot.l_is_leaf)) {
+        stack[++top] = child+side;
+      } else if (table[child+side].leaf >> data_unit_bitlen) {
+        ctx->err = HUFF_ERROR_GBA_TABLE_MALFORMED;
+        return -1;
+      }
+    }
+  } while (top > -1);
+
+  // nothing before the padding may be left unreachable
+  for (int i = 0; i < used; ++i) {
+    if (!seen[i]) {
+      ctx->err = HUFF_ERROR_GBA_TABLE_MALFORMED;
+      return -1;
+    }
+  }
+  return 0;
+}
+
+int Huff_GBA_Huff_Table_Verify(const HuffNode_GBA_t *table, int table_size, 
     DataSize_e data_unit_bitlen) {
+  return Huff_Ctx_GBA_Huff_Table_Verify(&huff_default_ctx, table, table_size,
+      data_unit_bitlen);
+}
+
+int Huff_Ctx_GBA_Header_Init(HuffCtx_t *ctx, HuffHeader_GBA_t *dst, 
+    int decompressed_data_bytelen, DataSize_e data_unit_bitlen) {
   if (!dst) {
-    huff_errno = HUFF_ERROR_NO_HEADER_SUPPLIED;
+    ctx->err = HUFF_ERROR_NO_HEADER_SUPPLIED;
     return -1;
   }
 
   if (decompressed_data_bytelen&3) {
-    huff_errno = HUFF_ERROR_DATA_NOT_WORD_ALIGNABLE;
+    ctx->err = HUFF_ERROR_DATA_NOT_WORD_ALIGNABLE;
+    return -1;
+  }
+
+  if (decompressed_data_bytelen > HUFF_GBA_MAX_DECOMP_SIZE) {
+    ctx->err = HUFF_ERROR_DATA_TOO_LARGE;
     return -1;
   }
 
@@ -671,7 +1042,7 @@ int Huff_GBA_Header_Init(HuffHeader_GBA_t *dst, int decompressed_data_bytelen,
   case E_DATA_UNIT_8_BITS:
     break;
   default:
-    huff_errno = HUFF_ERROR_UNSUPPORTED_FEATURE;
+    ctx->err = HUFF_ERROR_UNSUPPORTED_FEATURE;
     return -1;
   }
 
@@ -680,3 +1051,9 @@ int Huff_GBA_Header_Init(HuffHeader_GBA_t *dst, int decompressed_data_bytelen,
   dst->decomp_data_size = decompressed_data_bytelen;
   return 0;
 }
+
+int Huff_GBA_Header_Init(HuffHeader_GBA_t *dst, int decompressed_data_bytelen,
+    DataSize_e data_unit_bitlen) {
+  return Huff_Ctx_GBA_Header_Init(&huff_default_ctx, dst, 
+      decompressed_data_bytelen, data_unit_bitlen);
+}
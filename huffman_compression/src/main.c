@@ -1,13 +1,32 @@
 #include "huffman.h"
 #include "int_ll.h"
 #include "filewriter.h"
+#include "huff_input.h"
+#include "huff_ctx.h"
+#include "huff_histogram.h"
+#include "huff_decode.h"
+#include "huff_gba_cost.h"
+#include "huff_fast_lut.h"
+#include "huff_lz77.h"
+#include "huff_rle.h"
+#include "huff_diff.h"
+#include "huff_select.h"
+#include "huff_pipeline.h"
+#include "batch.h"
+#include "huff_pool.h"
+#include "asset_cache.h"
+#include "asset_watch.h"
 #include <assert.h>
 #include <errno.h>
+#include <limits.h>
+#include <signal.h>
 #include <stdarg.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <ctype.h>
 #include <string.h>
+#include <strings.h>
+#include <sys/stat.h>
 
 #define ERR_PREFIX "\x1b[1;31m[Error]:\x1b[0m "
 #define perrf(fmt, ...) fprintf(stderr, ERR_PREFIX fmt, __VA_ARGS__)
@@ -32,25 +51,19 @@ int main(void) {
     perrf("Codebase came back NULL.\nDetails: %s\n", Huff_Codebase_Strerror());
     return -1;
   }
-  int cbent_ct;
-  const BST_Node_t *cbroot = BST_Get_Root(codebase, &cbent_ct);
-  if (cbent_ct != tree->leaf_ct) {
+  if (codebase->entry_ct != tree->leaf_ct) {
     perrf("Codebase has less entries than expected.\n"
         "Expected \x1b[1;34m%d\x1b[0m, got \x1b[1;34m%d.\x1b[0m\n", tree->leaf_ct,
-        cbent_ct);
+        codebase->entry_ct);
     return -1;
   }
-  const BST_Node_t *stack[1<<(cbroot->height+1)], *cur;
   const CodeEntry_t *codent;
   uint64_t code;
   uint32_t len;
-  int top = -1;
-  stack[++top] = cbroot;
-  do {
-    cur = stack[top--];
-    if (!cur)
+  for (int entry = 0; entry < (1<<codebase->data_unit_bitlen); ++entry) {
+    codent = Huff_Codebase_Get_Code(codebase, entry);
+    if (!codent)
       continue;
-    codent = cur->data;
     printf("\x1b[1;34mCode Entry For '%c' (ASCII %d):\x1b[33m\n\t", codent->data, codent->data);
     code = codent->code;
     len = codent->codelen;
@@ -61,9 +74,7 @@ int main(void) {
         putchar('0');
     }
     puts("\x1b[0m");
-    stack[++top] = cur->l;
-    stack[++top] = cur->r;
-  } while (top > -1);
+  }
   Huff_Codebase_Destroy(codebase);
 
   uint32_t *compdata;
@@ -110,6 +121,8 @@ int main(void) {
 #define warn(s) fputs(WARN_PREFIX s, stderr)
 
 #define OUTFILE_EXTENSION_SUBSTRLEN 2
+/// What --incbin's raw side file gets named, after the output file's base name
+#define INCBIN_SUFFIX "_data.bin"
 
 
 char *strdupe(const char *str) {
@@ -179,17 +192,40 @@ char *strcatdupe_variadic_def(const char *first, ...) {
 void print_usage(const char *exename, FILE *ostream) {
   fprintf(ostream,
       "\t\x1b[1;33m[Usage]: \x1b[32m%s "
-      "\x1b[34m<input data file path> \x1b[36m[OPTIONS]\n\t"
+      "\x1b[34m<input data file path | - (stdin)> \x1b[36m[OPTIONS]\n\t"
+      "\x1b[1;33m[Batch]: \x1b[32m%s --batch \x1b[36m[-j <threads>] \x1b[34m(<input data file path> \x1b[36m[OPTIONS] \x1b[34m| @<response file>) \x1b[39m[-- ...]\n\t\t"
+      "\x1b[0;2mEach job takes the same args as a single-file run. Response files list one job per line.\n\t\t"
+      "Jobs run on a pool of <threads> workers (Defaults to core count).\n\t"
+      "\x1b[1;33m[Watch]: \x1b[32m%s --watch \x1b[34m<input directory> \x1b[36m[OPTIONS]\n\t\t"
+      "\x1b[0;2mStays running, and recompresses every file in the directory that gets written to, with the same OPTIONS for each\n\t\t"
+      "(except -o and -n, as outputs are named after their input). Stop with Ctrl+C.\n\t"
       "\x1b[1;33m[For help menu]: \x1b[32m%s (-h|--help)\n\t\t"
       "\x1b[33m[Options]:\n\t\t\t"
-      "\x1b[1;39m-o \x1b[36m<output file base name> \x1b[0m(Defaults to input file base name)\n\t\t\t"
-      "\x1b[1;39m-b \x1b[36m<bits per huffcode (4|8)> \x1b[0m(Defaults to 8)\n\t\t\t"
+      "\x1b[1;39m-o \x1b[36m<output file base name | - (stdout)> \x1b[0m(Defaults to input file base name)\n\t\t\t"
+      "\x1b[1;39m-b \x1b[36m<bits per huffcode (4|8|auto)> \x1b[0m(Defaults to 8; auto picks whichever compresses smaller)\n\t\t\t"
+      "\x1b[1;39m-c \x1b[36m<codec (huff|lz77|rle|auto), or a chain of up to %d joined by +, e.g.: lz77+huff> \x1b[0m(Defaults to huff. -b and -l only apply to huff. auto tries every codec, bitdepth and filter, and keeps the smallest. A chain runs each codec on the one before's output, and the header gets the staging buffer sizes for chaining the SVCs back)\n\t\t\t"
+      "\x1b[1;39m-f \x1b[36m<filter ahead of the codec (none|diff8|diff16)> \x1b[0m(Defaults to none, or with -c auto, trying each. The codec then compresses the BIOS difference filter stream, for SVC 0x16-0x18 to unfilter)\n\t\t\t"
+      "\x1b[1;39m-w \x1b[36m<output bytes one frame of decode time is worth> \x1b[0m(Defaults to 0. Only for -c auto, to weigh smaller output against how long the BIOS takes to decode it)\n\t\t\t"
       "\x1b[1;39m-n \x1b[36m<output src object base name> \x1b[0m(Defaults to output file base name)\n\t\t\t"
-      "\x1b[1;39m-t \x1b[36m<output src type (c|C|asm|ASM)> \x1b[0m (Defaults to C source file as output src type)\n\t\t\t"
+      "\x1b[1;39m-t \x1b[36m<output src type (c|C|asm|ASM|obj|OBJ)> \x1b[0m (Defaults to C source file as output src type. obj writes an ARM ELF .o to link in directly, with the same symbols as asm)\n\t\t\t"
       "\x1b[1;39m-d \x1b[36m<output directory> \x1b[0m (Defaults to ./)\n\t\t\t"
-      "\x1b[1;39m--no-include\x1b[22m \x1b[2mTells program not to generate accompanying C header file if and only if output src type is Assembly\x1b[0m (Generates accompanying C header file by default)\n", 
+      "\x1b[1;39m-j \x1b[36m<encode threads> \x1b[0m (Defaults to core count, or 1 per job in batch mode)\n\t\t\t"
+      "\x1b[1;39m-l \x1b[36m<fast decoder lookup bits (1-12)> \x1b[0m (Also emits <output file base name>_fastdec.c, a C decoder probing that many bits at a time. Off by default)\n\t\t\t"
+      "\x1b[1;39m-s \x1b[36m<fast decoder lookup table section> \x1b[0m (Defaults to .iwram)\n\t\t\t"
+      "\x1b[1;39m-r \x1b[36m<region the GBA reads compressed data from (rom|ewram|iwram)> \x1b[0m (Defaults to rom; only affects the decode cost estimate)\n\t\t\t"
+      "\x1b[1;39m-k \x1b[36m<output cache directory> \x1b[0m (Look the input and every option affecting output up there first, and on a hit, hard-link the cached outputs in instead of compressing. Off by default)\n\t\t\t"
+      "\x1b[1;39m--no-include\x1b[22m \x1b[2mTells program not to generate accompanying C header file if and only if output src type is Assembly or an object file\x1b[0m (Generates accompanying C header file by default)\n\t\t\t"
+      "\x1b[1;39m--stream\x1b[22m \x1b[2mCompress in two passes over fixed-size chunks of the input, so memory use doesn't grow with input size\x1b[0m (Implied when input is stdin)\n\t\t\t"
+      "\x1b[1;39m--no-mmap\x1b[22m \x1b[2mRead the input file into a buffer instead of memory-mapping it\x1b[0m (Input gets mapped by default when it's a regular file)\n\t\t\t"
+      "\x1b[1;39m--verify\x1b[22m \x1b[2mDecode the compressed output the way the GBA BIOS would, and fail if it doesn't match the input\x1b[0m (Off by default)\n\t\t\t"
+      "\x1b[1;39m--vram-safe\x1b[22m \x1b[2mWith \x1b[22;1m-c lz77\x1b[22;2m, never back-reference the byte 1 back, so the output can be decompressed straight to VRAM with SVC 0x12\x1b[0m (Off by default)\n\t\t\t"
+      "\x1b[1;39m--incbin\x1b[22m \x1b[2mWith \x1b[22;1m-t asm\x1b[22;2m, write the compressed data raw to <output file base name>_data.bin (refusing to if that's the input file), and have the ASM src pull it in with .incbin instead of parsing it as text. Assemble with -I <output directory>\x1b[0m (Off by default)\n\t\t\t"
+      "\x1b[1;39m--depfile\x1b[22m \x1b[2mAlso write <output file base name>.d, a Make dependency file making every output written depend on the input\x1b[0m (Off by default)\n", 
+      exename,
+      exename,
+      exename,
       exename,
-      exename);
+      HUFF_PIPELINE_MAX_STAGES);
 }
 
 enum e_cli_opt {
@@ -198,6 +234,14 @@ enum e_cli_opt {
   SYMBOL_NAME='n',
   OUTFILE_TYPE='t',
   OUTPUT_DIRECTORY='d',
+  ENCODE_THREAD_CT='j',
+  SRC_REGION='r',
+  FAST_LUT_BITS='l',
+  FAST_LUT_SECTION='s',
+  CODEC='c',
+  FILTER='f',
+  FRAME_WEIGHT='w',
+  CACHE_DIRECTORY='k',
   HELP_MENU='h'
 };
 
@@ -239,11 +283,60 @@ char *make_valid_symbolname(char *symname, int len) {
 }
 
 #define OPT_TO_CHECKLIST_IDX(opt) (opt-'a')
+/* -b auto: the bitdepth isn't known until the histogram is, so it's counted 
+ * a byte at a time, and the tree that compresses smaller decides. */
+#define HUFFCODE_BITDEPTH_AUTO ((DataSize_e)0)
+
+typedef enum e_cli_codec {
+  E_CLI_CODEC_HUFFMAN=0,
+  E_CLI_CODEC_LZ77,
+  E_CLI_CODEC_RLE,
+  E_CLI_CODEC_AUTO,  /// Whichever of the above compresses smallest, picked per input
+  E_CLI_CODEC_CT
+} CliCodec_e;
+
+/// Names -c takes, indexed by CliCodec_e
+static const char *const cli_codec_names[E_CLI_CODEC_CT] = {
+  [E_CLI_CODEC_HUFFMAN] = "huff",
+  [E_CLI_CODEC_LZ77] = "lz77",
+  [E_CLI_CODEC_RLE] = "rle",
+  [E_CLI_CODEC_AUTO] = "auto"
+};
+
+/* Everything one compression needs, as parsed from one input's arg list. 
+ * In batch mode, there's one per input. */
+typedef struct s_cli_job {
+  const char *exename;
+  char *infile, *outfile, *output_objname, *output_dir;
+  char type;
+  DataSize_e huffcode_bitdepth;
+  _Bool generate_include, stream_mode, use_mmap, to_stdout, verify;
+  HuffGBARegion_e src_region;  /// Where the GBA reads the output from, for the decode cost estimate
+  int fast_lut_bits;  /// 0 unless a fast decoder is to be emitted too
+  char *fast_lut_section;
+  int encode_thread_ct;  /// 0 until set, which means use every core
+  CliCodec_e codec;
+  CliCodec_e pre_codecs[HUFF_PIPELINE_MAX_STAGES-1];  /// -c chain links ahead of codec, first applied first
+  int pre_codec_ct;
+  _Bool vram_safe;  /// LZ77 only: keep the output decodable by SVC 0x12
+  _Bool incbin;  /// ASM only: the compressed data goes in a raw .bin side file, for .incbin
+  int diff_unit_bitlen;  /// 8 or 16 to difference filter the input ahead of the codec, 0 not to, -1 for -c auto to try each
+  double frame_weight;  /// -c auto only: output bytes one frame of decode time is worth
+  HuffInput_t *input;  /// If not NULL, already loaded, and taken over by job_run instead of loading infile
+  const HuffSelectResult_t *selection;  /// If not NULL, how -c auto picked codec, for the header to record
+  char *cache_dir;  /// NULL unless outputs are to be looked up in and added to an output cache
+  _Bool depfile;  /// Write a Make dependency file next to the outputs
+  AssetCacheFiles_t *outputs;  /// If not NULL, gets the name of every output file job_run (or job_run_cached) writes
+} CliJob_t;
 
-int parse_opts(const int argc, const char *argv[], char **outfile, 
-    char **outobjname, char **output_dir, char *type, DataSize_e *data_size,_Bool *generate_include) {
-  int *lens = malloc(sizeof(int)*argc), i;
-  _Bool opts_parsed['t'-'a'+1];
+/**
+ * @brief Fill in job's options from argv, leaving those argv doesn't set as 
+ * they were.
+ * @return 0 on success, -1 on failure (already reported).
+ * */
+int parse_opts(const int argc, const char *argv[], CliJob_t *job) {
+  int *lens = malloc(sizeof(int)*argc), i, bare_flag_ct = 0;
+  _Bool opts_parsed['z'-'a'+1];
   memset(opts_parsed, 0, sizeof(opts_parsed));
   lens[0] = -1;  // dont care about len of argv[0]
   {
@@ -260,7 +353,32 @@ int parse_opts(const int argc, const char *argv[], char **outfile,
           free(lens);
           return -1;
         } else if (!strcmp("no-include", tmp)) {
-          *generate_include = false;
+          job->generate_include = false;
+          ++bare_flag_ct;
+          continue;
+        } else if (!strcmp("stream", tmp)) {
+          job->stream_mode = true;
+          ++bare_flag_ct;
+          continue;
+        } else if (!strcmp("no-mmap", tmp)) {
+          job->use_mmap = false;
+          ++bare_flag_ct;
+          continue;
+        } else if (!strcmp("verify", tmp)) {
+          job->verify = true;
+          ++bare_flag_ct;
+          continue;
+        } else if (!strcmp("vram-safe", tmp)) {
+          job->vram_safe = true;
+          ++bare_flag_ct;
+          continue;
+        } else if (!strcmp("incbin", tmp)) {
+          job->incbin = true;
+          ++bare_flag_ct;
+          continue;
+        } else if (!strcmp("depfile", tmp)) {
+          job->depfile = true;
+          ++bare_flag_ct;
           continue;
         }
         if (i==1) {
@@ -304,6 +422,7 @@ int parse_opts(const int argc, const char *argv[], char **outfile,
           "fitting your compressed data when compiling and linking your GBA Project,\n"
           "Try rerunning this with the option args, " COLOR_BOLD(33, "-t ASM") ", as this has happened to me:\n" 
           BOLD("linker complains about same array declared in C, but links no problem with same array declared in ASM...\n")
+          "Or skip the compiler and assembler altogether with " COLOR_BOLD(33, "-t OBJ") ", which writes the object file itself.\n"
           "Good luck and happy coding!");
       free(lens);
       exit(0);
@@ -311,7 +430,12 @@ int parse_opts(const int argc, const char *argv[], char **outfile,
   }
   char *in_basename = NULL;
   uintptr_t in_basename_len = 0;
-  {
+  if (!strcmp("-", argv[1])) {
+    // reading from stdin, so there's no file name to take a basename from
+    job->stream_mode = true;
+    in_basename = strdupe("stdin");
+    in_basename_len = strlen(in_basename);
+  } else {
     const char *ifname = argv[1], *ifname_start = ifname+lens[1], *ifname_end = NULL;
     char c;
     for (c = *--ifname_start; ifname_start!=ifname && c!='/'; c = *--ifname_start) {
@@ -333,20 +457,21 @@ int parse_opts(const int argc, const char *argv[], char **outfile,
   if (argc==2) {
     char *tmp;
     int tmplen = in_basename_len+OUTFILE_EXTENSION_SUBSTRLEN;
-    tmp = *outfile = calloc(tmplen+1, sizeof(char));
+    tmp = job->outfile = calloc(tmplen+1, sizeof(char));
     snprintf(tmp, tmplen+1, "%s.c", in_basename);
     tmp[tmplen] = '\0';
-    *outobjname = in_basename;
-    *data_size = E_DATA_UNIT_8_BITS;
-    *type = 'c';
+    job->output_objname = in_basename;
+    job->huffcode_bitdepth = E_DATA_UNIT_8_BITS;
+    job->type = 'c';
     free(lens);
     return 0;
   }
 
-  if (argc&1 && *generate_include) {
+  if ((argc - bare_flag_ct)&1) {
     perrf("Invalid argument count (%d). Expect even arg count unless:\n\t"
         "\x1b[1;34m - \x1b[0mSpecifying not to generate a companion C-style header file with \x1b[1m--no-include\x1b[0m.\n\t\t"
         "(Program generates a header by default)\n\t"
+        "\x1b[1;34m - \x1b[0mSpecifying streaming mode with \x1b[1m--stream\x1b[0m.\n\t"
         "\x1b[1;34m - \x1b[0mRunning program with help arg, as shown below\n\t\t"
         "\x1b[1m$ %s -h\x1b[22m or \x1b[1m $ %s --help\x1b[22m to see usage.\n", argc,
         *argv, *argv);
@@ -357,20 +482,20 @@ int parse_opts(const int argc, const char *argv[], char **outfile,
 
   {
     const char *cur;
-    *type = 'c';
-    *data_size = E_DATA_UNIT_8_BITS;
+    job->type = 'c';
+    job->huffcode_bitdepth = E_DATA_UNIT_8_BITS;
     char *ofname = NULL, *symname = NULL;
     i = 2;
     while (i+1 < argc) {
       cur = argv[i];
       if (cur[0] != '-' || lens[i] != 2) {
-        if (!strcmp("--no-include", cur)) {
-          if (++i + 1 == argc) {
-            perrf("Invalid opt args. Final arg, " BOLD("%s") ", is an opt flag"
-                "without an accompanying opt parameter.\n", argv[i]);
-          } else {
-            continue;
-          }
+        if (!strcmp("--no-include", cur) || !strcmp("--stream", cur) 
+            || !strcmp("--no-mmap", cur) || !strcmp("--verify", cur)
+            || !strcmp("--vram-safe", cur) || !strcmp("--incbin", cur)
+            || !strcmp("--depfile", cur)) {
+          // already handled in the first pass over the args
+          ++i;
+          continue;
         } else {
           perrf("Invalid opt args. Expected flag argument, received %s\n", cur);
         }
@@ -379,7 +504,8 @@ int parse_opts(const int argc, const char *argv[], char **outfile,
         return -1;
       }
 
-      if (argv[i+1][0]=='-') {
+      // a lone "-" is a valid param (stdout, for -o)
+      if (argv[i+1][0]=='-' && argv[i+1][1]) {
         if (argv[i+1][1] == 'h' || cur[1] == 'h') {
           perrf("Invalid opt args. Cannot just hamfist help opt flag in middle of opts.\n"
               "To access help menu, simply run:\n\t"
@@ -414,21 +540,22 @@ int parse_opts(const int argc, const char *argv[], char **outfile,
           opts_parsed[OPT_TO_CHECKLIST_IDX(cur[1])] = true;
 
           cur = argv[++i];
+          if (!strcmp("auto", cur)) {
+            job->huffcode_bitdepth = HUFFCODE_BITDEPTH_AUTO;
+            ++i;
+            continue;
+          }
           if (lens[i] != 1) {
             perrf("Invalid opt args. \x1b[1m%s\x1b[22m is not a param for opt flag, \x1b[1m%c\x1b[22m\n", cur, HUFFCODE_BITDEPTH);
-            free(lens);
-            free(in_basename);
             break;
           }
           {
             DataSize_e tmp = cur[0] - '0';
             if (((tmp & E_DATA_UNIT_VALIDITY_MASK) != tmp) || (tmp == E_DATA_UNIT_VALIDITY_MASK)) {
               perrf("Invalid opt args. \x1b[1m%s\x1b[22m is not a param for opt flag, \x1b[1m%c\x1b[22m\n", cur, HUFFCODE_BITDEPTH);
-              free(lens);
-              free(in_basename);
               break;
             }
-            *data_size = tmp;
+            job->huffcode_bitdepth = tmp;
           }
           ++i;
           continue;
@@ -465,12 +592,11 @@ int parse_opts(const int argc, const char *argv[], char **outfile,
               perrf("Invalid opt args. \x1b[1m%s\x1b[22m is an invalid param "
                   "for opt flag, \x1b[1m-%c\n"
                   "Valid params for output src type flag, \x1b[34m-%c\x1b[22m:\n\t"
-                  "\x1b[32mc\x1b[39m, \x1b[32mC\x1b[39m, \x1b[32masm\x1b[39m, \x1b[32mASM\x1b[0m\n",
+                  "\x1b[32mc\x1b[39m, \x1b[32mC\x1b[39m, \x1b[32masm\x1b[39m, \x1b[32mASM\x1b[39m, \x1b[32mobj\x1b[39m, \x1b[32mOBJ\x1b[0m\n",
                   argv[i], OUTFILE_TYPE, OUTFILE_TYPE);
-              free((void*)cur);
               break;
             }
-            *type = 'c';
+            job->type = 'c';
             ++i;
             continue;
           }
@@ -480,23 +606,231 @@ int parse_opts(const int argc, const char *argv[], char **outfile,
               perrf("Invalid opt args. \x1b[1m%s\x1b[22m is an invalid param "
                   "for opt flag, \x1b[1m-%c\n"
                   "Valid params for output src type flag, \x1b[34m-%c\x1b[22m:\n\t"
-                  "\x1b[32mc\x1b[39m, \x1b[32mC\x1b[39m, \x1b[32masm\x1b[39m, \x1b[32mASM\x1b[0m\n",
+                  "\x1b[32mc\x1b[39m, \x1b[32mC\x1b[39m, \x1b[32masm\x1b[39m, \x1b[32mASM\x1b[39m, \x1b[32mobj\x1b[39m, \x1b[32mOBJ\x1b[0m\n",
                   argv[i], OUTFILE_TYPE, OUTFILE_TYPE);
         goto ERR_HANDLE;
             }
             *csr = tolower(c);
           }
+          if (!strcmp(cur, "obj")) {
+            free((void*)cur);
+            job->type = 'o';
+            ++i;
+            continue;
+          }
           if (strcmp(cur, "asm")) {
               perrf("Invalid opt args. \x1b[1m%s\x1b[22m is an invalid param "
                   "for opt flag, \x1b[1m-%c\n"
                   "Valid params for output src type flag, \x1b[34m-%c\x1b[22m:\n\t"
-                  "\x1b[32mc\x1b[39m, \x1b[32mC\x1b[39m, \x1b[32masm\x1b[39m, \x1b[32mASM\x1b[0m\n"
+                  "\x1b[32mc\x1b[39m, \x1b[32mC\x1b[39m, \x1b[32masm\x1b[39m, \x1b[32mASM\x1b[39m, \x1b[32mobj\x1b[39m, \x1b[32mOBJ\x1b[0m\n"
                   , argv[i], OUTFILE_TYPE, OUTFILE_TYPE);
               free((void*)cur);
               break;
           }
           free((void*)cur);
-          *type = 's';
+          job->type = 's';
+          ++i;
+          continue;
+        case ENCODE_THREAD_CT:
+          if (opts_parsed[OPT_TO_CHECKLIST_IDX(cur[1])]) {
+            warnf("Args for opt, " COLOR_BOLD(34, "-%c") ", have already been "
+                "Parsed. Ignoring duplicate args, " COLOR_BOLD(31, "-%c %s") "\n", 
+                cur[1], cur[1], argv[++i]);
+            ++i;
+            continue;
+          }
+          opts_parsed[OPT_TO_CHECKLIST_IDX(cur[1])] = true;
+
+          cur = argv[++i];
+          {
+            char *end;
+            long ct = strtol(cur, &end, 10);
+            if (*end || ct <= 0 || ct > 1024) {
+              perrf("Invalid opt args. \x1b[1m%s\x1b[22m is not a param for opt flag, \x1b[1m%c\x1b[22m\n", cur, ENCODE_THREAD_CT);
+              break;
+            }
+            job->encode_thread_ct = ct;
+          }
+          ++i;
+          continue;
+        case SRC_REGION:
+          if (opts_parsed[OPT_TO_CHECKLIST_IDX(cur[1])]) {
+            warnf("Args for opt, " COLOR_BOLD(34, "-%c") ", have already been "
+                "Parsed. Ignoring duplicate args, " COLOR_BOLD(31, "-%c %s") "\n", 
+                cur[1], cur[1], argv[++i]);
+            ++i;
+            continue;
+          }
+          opts_parsed[OPT_TO_CHECKLIST_IDX(cur[1])] = true;
+
+          cur = argv[++i];
+          {
+            int region = Huff_GBA_Region_From_Name(cur);
+            if (region < 0) {
+              perrf("Invalid opt args. \x1b[1m%s\x1b[22m is an invalid param "
+                  "for opt flag, \x1b[1m-%c\n"
+                  "Valid params for source region flag, \x1b[34m-%c\x1b[22m:\n\t"
+                  "\x1b[32mrom\x1b[39m, \x1b[32mewram\x1b[39m, \x1b[32miwram\x1b[0m\n",
+                  cur, SRC_REGION, SRC_REGION);
+              break;
+            }
+            job->src_region = region;
+          }
+          ++i;
+          continue;
+        case FAST_LUT_BITS:
+          if (opts_parsed[OPT_TO_CHECKLIST_IDX(cur[1])]) {
+            warnf("Args for opt, " COLOR_BOLD(34, "-%c") ", have already been "
+                "Parsed. Ignoring duplicate args, " COLOR_BOLD(31, "-%c %s") "\n", 
+                cur[1], cur[1], argv[++i]);
+            ++i;
+            continue;
+          }
+          opts_parsed[OPT_TO_CHECKLIST_IDX(cur[1])] = true;
+
+          cur = argv[++i];
+          {
+            char *end;
+            long bits = strtol(cur, &end, 10);
+            if (*end || bits < HUFF_FAST_LUT_MIN_BITS 
+                || bits > HUFF_FAST_LUT_MAX_BITS) {
+              perrf("Invalid opt args. \x1b[1m%s\x1b[22m is not a param for opt flag, \x1b[1m%c\x1b[22m\n", cur, FAST_LUT_BITS);
+              break;
+            }
+            job->fast_lut_bits = bits;
+          }
+          ++i;
+          continue;
+        case FAST_LUT_SECTION:
+          if (opts_parsed[OPT_TO_CHECKLIST_IDX(cur[1])]) {
+            warnf("Args for opt, " COLOR_BOLD(34, "-%c") ", have already been "
+                "Parsed. Ignoring duplicate args, " COLOR_BOLD(31, "-%c %s") "\n", 
+                cur[1], cur[1], argv[++i]);
+            ++i;
+            continue;
+          }
+          opts_parsed[OPT_TO_CHECKLIST_IDX(cur[1])] = true;
+
+          cur = argv[++i];
+          if (!*cur || strpbrk(cur, "\"\\ \t\n")) {
+            perrf("Invalid opt args. \x1b[1m%s\x1b[22m is not a valid section name for opt flag, \x1b[1m%c\x1b[22m\n", cur, FAST_LUT_SECTION);
+            break;
+          }
+          job->fast_lut_section = strdupe(cur);
+          ++i;
+          continue;
+        case CACHE_DIRECTORY:
+          if (opts_parsed[OPT_TO_CHECKLIST_IDX(cur[1])]) {
+            warnf("Args for opt, " COLOR_BOLD(34, "-%c") ", have already been "
+                "Parsed. Ignoring duplicate args, " COLOR_BOLD(31, "-%c %s") "\n", 
+                cur[1], cur[1], argv[++i]);
+            ++i;
+            continue;
+          }
+          opts_parsed[OPT_TO_CHECKLIST_IDX(cur[1])] = true;
+
+          cur = argv[++i];
+          if (!*cur) {
+            perrf("Invalid opt args. Empty directory name for opt flag, \x1b[1m%c\x1b[22m\n", CACHE_DIRECTORY);
+            break;
+          }
+          job->cache_dir = strdupe(cur);
+          ++i;
+          continue;
+        case CODEC:
+          if (opts_parsed[OPT_TO_CHECKLIST_IDX(cur[1])]) {
+            warnf("Args for opt, " COLOR_BOLD(34, "-%c") ", have already been "
+                "Parsed. Ignoring duplicate args, " COLOR_BOLD(31, "-%c %s") "\n", 
+                cur[1], cur[1], argv[++i]);
+            ++i;
+            continue;
+          }
+          opts_parsed[OPT_TO_CHECKLIST_IDX(cur[1])] = true;
+
+          cur = argv[++i];
+          {
+            // e.g.: lz77+huff, each codec compressing the one before's output
+            CliCodec_e links[HUFF_PIPELINE_MAX_STAGES];
+            int c = E_CLI_CODEC_CT, link_ct = 0;
+            const char *link = cur, *end;
+            do {
+              const size_t len = (end = strchr(link, '+')) 
+                ? (size_t)(end - link) : strlen(link);
+              for (c = 0; c < E_CLI_CODEC_CT; ++c)
+                if (strlen(cli_codec_names[c]) == len 
+                    && !strncasecmp(link, cli_codec_names[c], len))
+                  break;
+              // auto picks one codec, so it can't be chained
+              if (c == E_CLI_CODEC_CT || link_ct == HUFF_PIPELINE_MAX_STAGES
+                  || (c == E_CLI_CODEC_AUTO && (link_ct || end))) {
+                c = E_CLI_CODEC_CT;
+                break;
+              }
+              links[link_ct++] = c;
+              link = end + 1;
+            } while (end);
+            if (c == E_CLI_CODEC_CT) {
+              perrf("Invalid opt args. \x1b[1m%s\x1b[22m is an invalid param "
+                  "for opt flag, \x1b[1m-%c\n"
+                  "Valid params for codec flag, \x1b[34m-%c\x1b[22m:\n\t"
+                  "\x1b[32mhuff\x1b[39m, \x1b[32mlz77\x1b[39m, \x1b[32mrle\x1b[39m, \x1b[32mauto\x1b[39m, "
+                  "or up to %d of the first three joined by \x1b[32m+\x1b[39m, e.g.: \x1b[32mlz77+huff\x1b[0m\n",
+                  cur, CODEC, CODEC, HUFF_PIPELINE_MAX_STAGES);
+              break;
+            }
+            job->codec = links[link_ct-1];
+            job->pre_codec_ct = link_ct-1;
+            memcpy(job->pre_codecs, links, sizeof(*links)*(link_ct-1));
+          }
+          ++i;
+          continue;
+        case FILTER:
+          if (opts_parsed[OPT_TO_CHECKLIST_IDX(cur[1])]) {
+            warnf("Args for opt, " COLOR_BOLD(34, "-%c") ", have already been "
+                "Parsed. Ignoring duplicate args, " COLOR_BOLD(31, "-%c %s") "\n", 
+                cur[1], cur[1], argv[++i]);
+            ++i;
+            continue;
+          }
+          opts_parsed[OPT_TO_CHECKLIST_IDX(cur[1])] = true;
+
+          cur = argv[++i];
+          if (!strcasecmp("none", cur)) {
+            job->diff_unit_bitlen = 0;
+          } else if (!strcasecmp("diff8", cur)) {
+            job->diff_unit_bitlen = 8;
+          } else if (!strcasecmp("diff16", cur)) {
+            job->diff_unit_bitlen = 16;
+          } else {
+            perrf("Invalid opt args. \x1b[1m%s\x1b[22m is an invalid param "
+                "for opt flag, \x1b[1m-%c\n"
+                "Valid params for filter flag, \x1b[34m-%c\x1b[22m:\n\t"
+                "\x1b[32mnone\x1b[39m, \x1b[32mdiff8\x1b[39m, \x1b[32mdiff16\x1b[0m\n",
+                cur, FILTER, FILTER);
+            break;
+          }
+          ++i;
+          continue;
+        case FRAME_WEIGHT:
+          if (opts_parsed[OPT_TO_CHECKLIST_IDX(cur[1])]) {
+            warnf("Args for opt, " COLOR_BOLD(34, "-%c") ", have already been "
+                "Parsed. Ignoring duplicate args, " COLOR_BOLD(31, "-%c %s") "\n", 
+                cur[1], cur[1], argv[++i]);
+            ++i;
+            continue;
+          }
+          opts_parsed[OPT_TO_CHECKLIST_IDX(cur[1])] = true;
+
+          cur = argv[++i];
+          {
+            char *end;
+            double weight = strtod(cur, &end);
+            if (*end || end == cur || !(weight >= 0.0)) {
+              perrf("Invalid opt args. \x1b[1m%s\x1b[22m is not a param for opt flag, \x1b[1m%c\x1b[22m\n", cur, FRAME_WEIGHT);
+              break;
+            }
+            job->frame_weight = weight;
+          }
           ++i;
           continue;
         case HELP_MENU:
@@ -516,10 +850,10 @@ int parse_opts(const int argc, const char *argv[], char **outfile,
           opts_parsed[OPT_TO_CHECKLIST_IDX(cur[1])] = true;
           
           cur = argv[++i];
-          if (cur[lens[i-1]] != '/') {
-            *output_dir = strcatdupe(cur, "/");
+          if (cur[lens[i]-1] != '/') {
+            job->output_dir = strcatdupe(cur, "/");
           } else {
-            *output_dir = strdupe(cur);
+            job->output_dir = strdupe(cur);
           }
           ++i;
           continue;
@@ -539,12 +873,21 @@ ERR_HANDLE:
     if (ofname == NULL) {
       ofname = in_basename;
     }
+
+    if (!strcmp("-", ofname)) {
+      // writing to stdout; symbol names still come from the input's basename
+      job->outfile = strdupe("-");
+      if (symname == NULL)
+        symname = make_valid_symbolname(strdupe(in_basename), in_basename_len);
+    }
     if (symname == NULL) {
       symname = make_valid_symbolname(strdupe(ofname), strlen(ofname));
     }
 
-    char ext[3] = { '.', *type, '\0' };
-    *outfile = strcatdupe(ofname, ext);
+    if (job->outfile == NULL) {
+      char ext[3] = { '.', job->type, '\0' };
+      job->outfile = strcatdupe(ofname, ext);
+    }
     
     if (ofname == in_basename) {
       free(ofname);
@@ -554,7 +897,7 @@ ERR_HANDLE:
       free(ofname);
       ofname = NULL;
     }
-    *outobjname = symname;
+    job->output_objname = symname;
   }
   
   if (in_basename != NULL) {
@@ -567,210 +910,1038 @@ ERR_HANDLE:
 
 
 
-int main(int argc, char *argv[]) {
-  if (argc < 2) {
-    perr("Invalid argument count. See below for usage:\n");
-    print_usage(*argv, stderr);
-    return 1;
+/**
+ * @brief Create the hufftree for a histogram counted at huffcode_bitdepth, or
+ * with -b auto, counted a byte at a time, in which case auto_byte_cts gets 
+ * the predicted size at 4 and 8 bits.
+ * */
+static HuffTree_t *create_tree(HuffCtx_t *ctx, const int *freq, 
+    DataSize_e huffcode_bitdepth, uint32_t auto_byte_cts[2]) {
+  HuffTree_t *ret;
+  if (huffcode_bitdepth == HUFFCODE_BITDEPTH_AUTO) {
+    ret = Huff_Ctx_Tree_Create_Smallest(ctx, freq, auto_byte_cts);
+  } else {
+    ret = Huff_Ctx_Tree_Create_From_Histogram(ctx, freq, huffcode_bitdepth);
   }
-
-
-  char *outfile = NULL, *infile = argv[1], *output_objname = NULL, 
-       *output_dir = NULL, type = '\0';
-  int ofnamelen, oonamelen, odnamelen;
-  DataSize_e huffcode_bitdepth;
-  _Bool generate_include = true;
-
-  if (0 > parse_opts(argc, (const char**)argv, &outfile, &output_objname, &output_dir, &type, &huffcode_bitdepth, &generate_include)) {
-    perr("Failed to parse opts.\n");
-    
-    if (outfile!=NULL)
-      free(outfile);
-
-    if (output_objname!=NULL)
-      free(output_objname);
-
-    return -1;
+  if (!ret) {
+    perrf("Failed to create hufftree. \x1b[1;34mDetails:\x1b[39m %s\x1b[0m\n",
+        Huff_Ctx_Strerror(ctx));
   }
+  return ret;
+}
 
-  // I hate having to do this, but this is the easiest way to adapt the below
-  // code I've recycled for this GBA Huffman compressor CLI tool.
-  ofnamelen = strlen(outfile);
-  char of_static[ofnamelen+1];
-  strncpy(of_static, outfile, ofnamelen);
-  of_static[ofnamelen] = '\0';
-  free(outfile);
-  outfile = of_static;
-
-  oonamelen = strlen(output_objname);
-  char oo_static[oonamelen+1];
-  strncpy(oo_static, output_objname, oonamelen);
-  oo_static[oonamelen] = '\0';
-  free(output_objname);
-  output_objname = oo_static;
-
-  if (output_dir == NULL) {
-    output_dir = strdupe("./");
+// Input gets read this many bytes at a time in streaming mode.
+#define STREAM_CHUNK_SIZE 0x10000
+
+/* With --verify, the compressed words get decoded as they're written, and
+ * what comes out is checked against what went in by hash, so neither side
+ * ever has to be held in memory whole. */
+typedef struct s_stream_sink_ctx {
+  SrcWriter_t *writer;
+  HuffDecoder_t *dec;  /// NULL unless verifying
+  uint64_t decoded_hash;
+} StreamSinkCtx_t;
+
+#define FNV1A_64_OFFSET_BASIS 0xcbf29ce484222325ULL
+#define FNV1A_64_PRIME 0x100000001b3ULL
+
+static uint64_t fnv1a_64(uint64_t hash, const void *bytes, size_t byte_ct) {
+  const byte *cur = bytes;
+  while (byte_ct--) {
+    hash ^= *cur++;
+    hash *= FNV1A_64_PRIME;
   }
-  odnamelen = strlen(output_dir);
-  char od_static[odnamelen+1];
-  strncpy(od_static, output_dir, odnamelen);
-  od_static[odnamelen] = '\0';
-  free(output_dir);
-  output_dir = od_static;
+  return hash;
+}
+
+static void stream_verify_sink(const void *bytes, int byte_ct, void *sink_ctx) {
+  StreamSinkCtx_t *sctx = sink_ctx;
+  sctx->decoded_hash = fnv1a_64(sctx->decoded_hash, bytes, byte_ct);
+}
 
+static void stream_sink(const uint32_t *words, int word_ct, void *sink_ctx) {
+  StreamSinkCtx_t *sctx = sink_ctx;
+  write_src_file_words(sctx->writer, words, word_ct);
+  if (sctx->dec)
+    Huff_Decoder_Feed(sctx->dec, words, word_ct);
+}
 
-  if (!generate_include && type != 's') {
-    warn(COLOR_BOLD(34, "--no-include") " specified, but output source type is " BOLD("C\n")
-        COLOR_BOLD(34, "--no-include") " can only be specified if source type is " BOLD("Assembly\n"));
+/**
+ * @brief Compress infile to ofp in two passes without ever holding the whole 
+ * input or compressed output in memory: the first pass only builds the 
+ * histogram, the second encodes chunk by chunk straight into the src writer.
+ * With -b auto, *huffcode_bitdepth comes back as the one picked.
+ * Input that can't be rewound (e.g.: stdin, a pipe) is spooled to a tmpfile 
+ * during the first pass.
+ * With verify, the output is decoded as it's written and checked against the
+ * input, which fails the whole thing if they differ.
+ * With incbin_fp, an ASM src file's raw compressed data goes there instead 
+ * (see write_src_file_incbin).
+ * @return 0 on success, -1 on failure. On success, *tree is the caller's to 
+ * destroy.
+ * */
+int stream_compress(HuffCtx_t *ctx, FILE *ofp, const char *exename, const char *infile, 
+    const char *infile_truncated, const char *output_objname, char type, 
+    FILE *incbin_fp, const char *incbin_name, DataSize_e *huffcode_bitdepth, uint32_t auto_byte_cts[2], _Bool verify, 
+    HuffTree_t **tree, size_t *data_size, int *complen, int *tablelen) {
+  const DataSize_e hist_bitdepth = (*huffcode_bitdepth == HUFFCODE_BITDEPTH_AUTO)
+    ? E_DATA_UNIT_8_BITS : *huffcode_bitdepth;
+  FILE *ifp = NULL, *spool = NULL;
+  HuffEncoder_t *enc = NULL;
+  StreamSinkCtx_t sink_ctx = {
+    .writer = NULL, .dec = NULL, .decoded_hash = FNV1A_64_OFFSET_BASIS
+  };
+  uint64_t input_hash = FNV1A_64_OFFSET_BASIS;
+  HuffNode_GBA_t *gba_treetable = NULL;
+  HuffHeader_GBA_t gba_hdr = {0};
+  SrcWriter_t writer;
+  int freq[256] = {0}, ret = -1, pad, encoded_word_ct;
+  size_t total = 0, readlen;
+  byte *buf = malloc(STREAM_CHUNK_SIZE);
+
+  *tree = NULL;
+  if (!buf) {
+    perr("Failed to allocate streaming input buffer.\n");
+    return -1;
   }
-  printf("Compressing " BOLD("%s") " and formatting to GBA BIOS-provided Huffman Decompression SVC:\n"
-      COLOR_BOLD(34, "Output file:") "\t\t\t" BOLD("%s\n")
-      COLOR_BOLD(34, "Output Directory:") "\t\t" BOLD("%s\n")
-      COLOR_BOLD(34, "Output Symbol Prefix:") "\t\t" BOLD("%s\n")
-      COLOR_BOLD(34, "Output Source Code Type:") "\t" BOLD("%s\n")
-      COLOR_BOLD(34, "Huffcode Bitdepth:") "\t\t" BOLD("%d\n")
-      COLOR_BOLD(34, "Generate C Header File:") "\t\t" BOLD("%s\n"), infile,
-      outfile, output_dir, output_objname, 
-      type?(type=='c'?"C":(type=='s'?"ASM":"[N/A]")):"[ERROR]", huffcode_bitdepth, 
-      type == 'c'
-            ? (generate_include
-                ? COLOR(34, "True")
-                : COLOR(34, "True") 
-                    "\x1b[0m \x1b[2m(--no-include only valid option when \x1b[0m"
-                    "\x1b[1;34m-t asm\x1b[0m\x1b[2m or \x1b[0m\x1b[1;34m-t ASM\x1b[0m"
-                    "\x1b[2m is also specified)\x1b[0m")
-            : (generate_include?COLOR(34, "True"):COLOR(31, "False")));
-  if (!generate_include && type != 's') {
-    generate_include = true;
+  if (!strcmp("-", infile)) {
+    ifp = stdin;
+  } else if (NULL == (ifp = fopen(infile, "rb"))) {
+    int errno_save = errno;
+    perrf("Failed to open input file, " COLOR_BOLD(32, "%s") ", for reading.\n"
+        "\t" COLOR_BOLD(31, "[Details]: ") "%s\n", infile, strerror(errno_save));
+    free(buf);
+    return -1;
   }
-#ifdef _TESTING_ARG_PARSER_
-  return 0;
-#endif
-  void *data = NULL;
-  size_t data_size = 0UL;
-  {
-    FILE *fp = fopen(infile, "r");
-    size_t data_size_orig;
-    long len;
-    if (!fp) {
+  if (ifp == stdin || 0 != fseek(ifp, 0L, SEEK_CUR)) {
+    if (NULL == (spool = tmpfile())) {
       int errno_save = errno;
-      perrf("Failed to open input file, " COLOR_BOLD(32, "%s") ", for reading.",
-          infile);
-      if (errno_save != 0) {
-        fprintf(stderr, "\n\t" COLOR_BOLD(31, "[Details]: ") "%s\n", 
-            strerror(errno_save));
-      } else {
-        fputc('\n', stderr);
-      }
-      return -1;
-    }
-
-    fseek(fp, 0L, SEEK_END);
-    len = ftell(fp);
-    if (0UL > len) {
-      perrf("Failed to get size of input file, " COLOR_BOLD(32, "%s") ".\n"
-          COLOR_BOLD(31, "[Size received]:") " %ld", infile, ftell(fp));
-      fclose(fp);
-      return -1;
-    }
-    data_size_orig = data_size = (size_t)len;
-
-    // Make sure data is word-aligned size
-    if (data_size&3) {
-      data_size &= (~3ULL);
-      data_size+=4;
+      perrf("Failed to create tmpfile to spool unseekable input into.\n"
+          "\t" COLOR_BOLD(31, "[Details]: ") "%s\n", strerror(errno_save));
+      goto CLEANUP;
     }
-    assert(!(data_size&3));
+  }
 
-    data = malloc(data_size);
-    if (data==NULL) {
-      int errno_save = errno;
-      perrf("Failed to allocate buffer for input file, " COLOR_BOLD(32, "%s") 
-          ", data to compress.\n" COLOR_BOLD(31, "[Details]: ") "%s\n",
-          infile, strerror(errno_save));
-      fclose(fp);
-      return -1;
+  // Pass 1: histogram
+  while (0 < (readlen = fread(buf, 1, STREAM_CHUNK_SIZE, ifp))) {
+    total += readlen;
+    if (total > HUFF_GBA_MAX_DECOMP_SIZE) {
+      perrf("Input, " COLOR_BOLD(32, "%s") ", is larger than the max size the "
+          "GBA BIOS header can describe, " BOLD("%d bytes") ".\n", infile, 
+          HUFF_GBA_MAX_DECOMP_SIZE);
+      goto CLEANUP;
     }
-
-    fseek(fp, 0L, SEEK_SET);
-    {
-      size_t readlen = fread(data, 1, data_size, fp);
-      int errno_save = errno;
-      if (data_size_orig != readlen) {
-        perrf("Failed to read all " COLOR_BOLD(33, "%lu bytes") " from input "
-            "file, " COLOR_BOLD(32, "%s") ".\nOnly read " 
-            COLOR_BOLD(31, "%lu bytes\n"), data_size_orig, infile, readlen);
-        if (errno_save!=0) {
-          fprintf(stderr, COLOR_BOLD(31, "[Details]: ") "%s\n", 
-              strerror(errno_save));
-        }
-        fclose(fp);
-        free((void*)data);
-        return -1;
-      }
+    Huff_Histogram_Add(freq, buf, readlen, hist_bitdepth);
+    if (spool && readlen != fwrite(buf, 1, readlen, spool)) {
+      perr("Failed to spool input to tmpfile.\n");
+      goto CLEANUP;
     }
-    fclose(fp);
-  }
-  size_t data_word_ct = data_size/4;
-  HuffTree_t *tree = Huff_Tree_Create(data, data_word_ct, huffcode_bitdepth);
-  uint32_t *compdata = NULL;
-  HuffNode_GBA_t *gba_treetable = NULL;
-  HuffHeader_GBA_t gba_hdr = {0};
-  int complen = 0, tablelen=0;
-  FILE *ofp = NULL;
-  if (!tree) {
-    perrf("Failed to create hufftree. \x1b[1;34mDetails:\x1b[39m %s\x1b[0m\n",
-        Huff_Strerror());
-    return -1;
   }
-  compdata = Huff_Compress(data, tree, data_word_ct, &complen);
-  if (!compdata) {
-    perrf("Failed to compress.\n\t\x1b[1;33mDetails: \x1b[2;31m%s\x1b[0m\n",
-        Huff_Strerror());
-    Huff_Tree_Destroy(tree);
-    return -1;
+  if (ferror(ifp)) {
+    perrf("Failed to read input file, " COLOR_BOLD(32, "%s") ".\n", infile);
+    goto CLEANUP;
   }
-
-  if (0 > Huff_GBA_Header_Init(&gba_hdr, data_size, huffcode_bitdepth)) {
+  // Same word-alignment zero padding the non-streaming path uses
+  pad = (-total)&3;
+  memset(buf, 0, 4);
+  Huff_Histogram_Add(freq, buf, pad, hist_bitdepth);
+  *data_size = total + pad;
+
+  if (NULL == (*tree = create_tree(ctx, freq, *huffcode_bitdepth, 
+          auto_byte_cts)))
+    goto CLEANUP;
+  *huffcode_bitdepth = (*tree)->data_unit_bitlen;
+  *complen = Huff_Tree_Encoded_Word_Ct(*tree);
+  if (0 > Huff_Ctx_GBA_Header_Init(ctx, &gba_hdr, *data_size, 
+        *huffcode_bitdepth)) {
     perrf("Failed to create GBA Header.\n\t\x1b[1;34mDetails: \x1b[39m"
-        "%s\x1b[0m\n", Huff_Strerror());
-    Huff_Tree_Destroy(tree);
-    free(compdata);
-    return -1;
+        "%s\x1b[0m\n", Huff_Ctx_Strerror(ctx));
+    goto CLEANUP;
   }
-
-  gba_treetable = Huff_GBA_Huff_Table_Create(tree, &tablelen);
-  if (!gba_treetable) {
+  if (NULL == (gba_treetable = Huff_Ctx_GBA_Huff_Table_Create(ctx, *tree, 
+          tablelen))) {
     perrf("Failed to create GBA HuffTree table.\n\t\x1b[1;34mDetails: \x1b[39m"
-        "%s\x1b[0m\n", Huff_Strerror());
-    Huff_Tree_Destroy(tree);
-    free(compdata);
-    return -1;
+        "%s\x1b[0m\n", Huff_Ctx_Strerror(ctx));
+    goto CLEANUP;
   }
 
-  char full_out_path[ofnamelen+odnamelen+1];
-  snprintf(full_out_path, sizeof(full_out_path), "%s%s", output_dir, outfile);
-
-  assert(full_out_path[sizeof(full_out_path)-1] == '\0');
-
-  if (NULL == (ofp = fopen(full_out_path, "w"))) {
-    int errnosave = errno;
-    if (errnosave != 0) {
-      perrf("Failed to open output src file, " BOLD("%s\n\t")
-          COLOR_BOLD(31, "Details: ") "%s\n", full_out_path, strerror(errnosave));
-    } else {
-      perrf("Failed to open output src file, " BOLD("%s\n\t"), full_out_path);
+  // Pass 2: encode
+  if (type == 'o') {
+    write_obj_file_begin(&writer, ofp, output_objname, *complen, gba_hdr, 
+        gba_treetable, *tablelen);
+  } else if (type == 'c') {
+    write_c_src_file_begin(&writer, ofp, exename, infile_truncated, 
+        output_objname, *data_size, NULL, 0, *complen, gba_hdr, *tree, 
+        gba_treetable, *tablelen, *huffcode_bitdepth);
+  } else {
+    write_asm_src_file_begin(&writer, ofp, exename, infile_truncated, 
+        output_objname, *data_size, NULL, 0, *complen, gba_hdr, *tree, 
+        gba_treetable, *tablelen, *huffcode_bitdepth);
+    if (incbin_fp)
+      write_src_file_incbin(&writer, incbin_fp, incbin_name);
+  }
+  sink_ctx.writer = &writer;
+  if (verify && NULL == (sink_ctx.dec = Huff_Ctx_Decoder_Create(ctx, gba_hdr,
+          gba_treetable, *tablelen, stream_verify_sink, &sink_ctx))) {
+    perrf("Failed to create verifying decoder.\n\t\x1b[1;34mDetails: \x1b[39m"
+        "%s\x1b[0m\n", Huff_Ctx_Strerror(ctx));
+    goto CLEANUP;
+  }
+  if (NULL == (enc = Huff_Ctx_Encoder_Create(ctx, *tree, stream_sink, 
+          &sink_ctx))) {
+    perrf("Failed to create streaming encoder.\n\t\x1b[1;34mDetails: \x1b[39m"
+        "%s\x1b[0m\n", Huff_Ctx_Strerror(ctx));
+    goto CLEANUP;
+  }
+  if (spool)
+    ifp = (ifp == stdin) ? spool : (fclose(ifp), spool);
+  rewind(ifp);
+  for (size_t left = total; left; left -= readlen) {
+    readlen = fread(buf, 1, left < STREAM_CHUNK_SIZE ? left : STREAM_CHUNK_SIZE, 
+        ifp);
+    if (!readlen) {
+      perrf("Input, " COLOR_BOLD(32, "%s") ", came up short on second pass.\n",
+          infile);
+      goto CLEANUP;
     }
-    Huff_Tree_Destroy(tree);
-    free(compdata);
-    free(gba_treetable);
-    return -1;
+    if (0 > Huff_Encoder_Feed(enc, buf, readlen)) {
+      perrf("Failed to compress.\n\t\x1b[1;33mDetails: \x1b[2;31m%s\x1b[0m\n",
+          Huff_Ctx_Strerror(ctx));
+      goto CLEANUP;
+    }
+    input_hash = fnv1a_64(input_hash, buf, readlen);
   }
-  
-  const char *infile_truncated = argv[1] + strlen(argv[1]);
-  {
-    const char *begin = argv[1];
+  memset(buf, 0, 4);
+  input_hash = fnv1a_64(input_hash, buf, pad);
+  if (0 > Huff_Encoder_Feed(enc, buf, pad)) {
+    perrf("Failed to compress.\n\t\x1b[1;33mDetails: \x1b[2;31m%s\x1b[0m\n",
+        Huff_Ctx_Strerror(ctx));
+    goto CLEANUP;
+  }
+  // What the encoder sank, as writer.word_idx also counts whatever the 
+  // writer put ahead of the bitstream (the C array's header and table words)
+  if (*complen != (encoded_word_ct = Huff_Encoder_Finish(enc))) {
+    perrf("Compressed word count mismatch. Expected " BOLD("%d") ", got " 
+        BOLD("%d") ".\n", *complen, encoded_word_ct);
+    goto CLEANUP;
+  }
+  if (sink_ctx.dec) {
+    long decoded_ct = Huff_Decoder_Finish(sink_ctx.dec);
+    if (decoded_ct < 0) {
+      perrf("Verification of " COLOR_BOLD(32, "%s") " failed.\n\t"
+          "\x1b[1;34mDetails: \x1b[39m%s\x1b[0m\n", infile, 
+          Huff_Ctx_Strerror(ctx));
+      goto CLEANUP;
+    }
+    if ((size_t)decoded_ct != *data_size 
+        || sink_ctx.decoded_hash != input_hash) {
+      perrf("Verification of " COLOR_BOLD(32, "%s") " failed. Compressed "
+          "output doesn't decode back to the input.\n", infile);
+      goto CLEANUP;
+    }
+  }
+  write_src_file_end(&writer);
+  ret = 0;
+
+CLEANUP:
+  if (ret && sink_ctx.writer)
+    write_src_file_abort(&writer);
+  Huff_Encoder_Destroy(enc);
+  Huff_Decoder_Destroy(sink_ctx.dec);
+  Huff_Ctx_Free(ctx, gba_treetable);
+  free(buf);
+  if (ifp && ifp != stdin)
+    fclose(ifp);
+  if (spool && spool != ifp)
+    fclose(spool);
+  if (ret && *tree) {
+    Huff_Tree_Destroy(*tree);
+    *tree = NULL;
+  }
+  return ret;
+}
+
+FILE *open_output_file(const char *path, const char *what) {
+  FILE *ret;
+  struct stat st;
+  // A file hard-linked in from the output cache (-k) shares its inode with 
+  // the cache entry, so it gets replaced rather than written over
+  if (0 == stat(path, &st) && S_ISREG(st.st_mode) && st.st_nlink > 1)
+    remove(path);
+  if (NULL == (ret = fopen(path, "w"))) {
+    int errnosave = errno;
+    if (errnosave != 0) {
+      perrf("Failed to open output %s file, " BOLD("%s\n\t")
+          COLOR_BOLD(31, "Details: ") "%s\n", what, path, strerror(errnosave));
+    } else {
+      perrf("Failed to open output %s file, " BOLD("%s\n"), what, path);
+    }
+  }
+  return ret;
+}
+
+void job_release(CliJob_t *job) {
+  free(job->infile);
+  free(job->outfile);
+  free(job->output_objname);
+  free(job->output_dir);
+  free(job->fast_lut_section);
+  free(job->cache_dir);
+  memset(job, 0, sizeof(*job));
+}
+
+/**
+ * @brief open_output_file, for one of job's outputs, at path (which starts 
+ * with job->output_dir), noting it in job->outputs.
+ * */
+FILE *job_open_output(const CliJob_t *job, const char *path, const char *what) {
+  FILE *ret = open_output_file(path, what);
+  if (ret && job->outputs && 0 > Asset_Cache_Files_Add(job->outputs, 
+        path + strlen(job->output_dir))) {
+    warnf("Output file name, " BOLD("%s") ", is too long to be cached.\n", 
+        path);
+  }
+  return ret;
+}
+
+/// @return Whether codec is anywhere in job's -c chain.
+static _Bool job_chains(const CliJob_t *job, CliCodec_e codec) {
+  for (int i = 0; i < job->pre_codec_ct; ++i)
+    if (job->pre_codecs[i] == codec)
+      return true;
+  return job->codec == codec;
+}
+
+/**
+ * @brief Turn off whichever of job's options it can't use, with a warning 
+ * for each, so every job (single, batch or watch) runs, and gets its cache 
+ * key described, with the settings it'll actually use.
+ * */
+static void job_normalize(CliJob_t *job) {
+  // When the src goes to stdout, keep stdout clean for it. There's also 
+  // nowhere to put a companion header.
+  if (job->to_stdout && job->generate_include) {
+    warn("Output src is going to " BOLD("stdout") ", so no companion C header "
+        "file will be generated.\n");
+    job->generate_include = false;
+  }
+  if (!job->generate_include && job->type == 'c' && !job->to_stdout) {
+    warn(COLOR_BOLD(34, "--no-include") " specified, but output source type is " BOLD("C\n")
+        COLOR_BOLD(34, "--no-include") " can only be specified if source type is " BOLD("Assembly") " or " BOLD("an object file\n"));
+    job->generate_include = true;
+  }
+
+  if (job->to_stdout && job->fast_lut_bits) {
+    warn("Output src is going to " BOLD("stdout") ", so no fast decoder "
+        "source file will be generated.\n");
+    job->fast_lut_bits = 0;
+  }
+
+  if (job->incbin && (job->type != 's' || job->to_stdout)) {
+    warn(COLOR_BOLD(34, "--incbin") " only applies to " BOLD("-t asm") 
+        " output written to a file. Ignoring it.\n");
+    job->incbin = false;
+  }
+
+  if ((job->cache_dir || job->depfile) 
+      && (job->to_stdout || !strcmp("-", job->infile))) {
+    warn(COLOR_BOLD(34, "-k") " and " COLOR_BOLD(34, "--depfile") " need both "
+        "the input and output src to be files. Ignoring them.\n");
+    free(job->cache_dir);
+    job->cache_dir = NULL;
+    job->depfile = false;
+  }
+
+  if (job->codec != E_CLI_CODEC_HUFFMAN) {
+    // auto only keeps it if Huffman wins
+    if (job->fast_lut_bits && job->codec != E_CLI_CODEC_AUTO) {
+      warnf("Fast decoders are only for Huffman data, so none will be "
+          "generated for " BOLD("%s") ".\n", cli_codec_names[job->codec]);
+      job->fast_lut_bits = 0;
+    }
+    if (job->stream_mode) {
+      warnf(BOLD("%s") " compresses the input as a whole, so it gets read "
+          "into memory instead of streamed.\n", cli_codec_names[job->codec]);
+      job->stream_mode = false;
+    }
+  }
+  if ((job->diff_unit_bitlen || job->pre_codec_ct) && job->stream_mode) {
+    warn("Filtering and chaining codecs need the whole input, so it gets read "
+        "into memory instead of streamed.\n");
+    job->stream_mode = false;
+  }
+  if (job->vram_safe && !job_chains(job, E_CLI_CODEC_LZ77) 
+      && job->codec != E_CLI_CODEC_AUTO) {
+    warn(COLOR_BOLD(34, "--vram-safe") " only applies to " BOLD("-c lz77") 
+        ". Ignoring it.\n");
+    job->vram_safe = false;
+  }
+  if (job->frame_weight && job->codec != E_CLI_CODEC_AUTO) {
+    warn(COLOR_BOLD(34, "-w") " only applies to " BOLD("-c auto") 
+        ". Ignoring it.\n");
+    job->frame_weight = 0;
+  }
+}
+
+/**
+ * @param argv argv[0] is the exe name and argv[1] the input, same as the 
+ * program's own argv.
+ * @return 0 on success, -1 on failure (already reported).
+ * */
+int job_init(CliJob_t *job, int argc, const char *argv[]) {
+  *job = (CliJob_t) {
+    .exename = argv[0],
+    .generate_include = true,
+    .stream_mode = false,
+    .use_mmap = true,
+    .src_region = E_HUFF_GBA_REGION_ROM,
+    .diff_unit_bitlen = -1
+  };
+  if (0 > parse_opts(argc, argv, job)) {
+    job_release(job);
+    return -1;
+  }
+  // without -f, -c auto tries every filter, and everything else uses none
+  if (job->diff_unit_bitlen < 0 && job->codec != E_CLI_CODEC_AUTO)
+    job->diff_unit_bitlen = 0;
+  // the filter is a stage of its own, ahead of the whole chain
+  if (job->pre_codec_ct + 1 + (job->diff_unit_bitlen > 0) 
+      > HUFF_PIPELINE_MAX_STAGES) {
+    perrf("Invalid opt args. A filter and a chain of %d codecs is more than "
+        "the %d stages a pipeline can have.\n", job->pre_codec_ct + 1, 
+        HUFF_PIPELINE_MAX_STAGES);
+    job_release(job);
+    return -1;
+  }
+  job->infile = strdupe(argv[1]);
+  if (job->output_dir == NULL) {
+    job->output_dir = strdupe("./");
+  }
+  job->to_stdout = !strcmp("-", job->outfile);
+  if (job->fast_lut_section == NULL) {
+    job->fast_lut_section = strdupe(".iwram");
+  }
+  job_normalize(job);
+  return 0;
+}
+
+/// What job's output gets decompressed with on the GBA, for the banner.
+static const char *job_svc_desc(const CliJob_t *job) {
+  if (job->codec == E_CLI_CODEC_AUTO)
+    return "whichever GBA BIOS-provided Decompression SVC suits it best";
+  if (job->pre_codec_ct || job->diff_unit_bitlen > 0)
+    return "a chain of GBA BIOS-provided Decompression SVCs";
+  switch (job->codec) {
+    case E_CLI_CODEC_LZ77:
+      return job->vram_safe 
+        ? "GBA BIOS-provided LZ77 Decompression SVC (0x11 or 0x12)"
+        : "GBA BIOS-provided LZ77 Decompression SVC (0x11)";
+    case E_CLI_CODEC_RLE:
+      return "GBA BIOS-provided Run-Length Decompression SVC (0x14 or 0x15)";
+    default:
+      return "GBA BIOS-provided Huffman Decompression SVC (0x13)";
+  }
+}
+
+/// Print the settings job is about to run with.
+void job_print_banner(const CliJob_t *job) {
+  char bitdepth_desc[8], codec_desc[96], fast_lut_desc[64];
+  int desc_len = snprintf(codec_desc, sizeof(codec_desc), "%s%s", 
+      job->diff_unit_bitlen == 8 ? "diff8 -> " : "", 
+      job->diff_unit_bitlen == 16 ? "diff16 -> " : "");
+  for (int i = 0; i < job->pre_codec_ct; ++i)
+    desc_len += snprintf(codec_desc + desc_len, sizeof(codec_desc) - desc_len,
+        "%s -> ", cli_codec_names[job->pre_codecs[i]]);
+  snprintf(codec_desc + desc_len, sizeof(codec_desc) - desc_len, "%s%s", 
+      cli_codec_names[job->codec], job->vram_safe ? " (VRAM-safe)" : "");
+  if (job->codec == E_CLI_CODEC_AUTO)
+    strcpy(bitdepth_desc, "auto");
+  else if (!job_chains(job, E_CLI_CODEC_HUFFMAN))
+    strcpy(bitdepth_desc, "[N/A]");
+  else
+  if (job->huffcode_bitdepth == HUFFCODE_BITDEPTH_AUTO)
+    strcpy(bitdepth_desc, "auto");
+  else
+    snprintf(bitdepth_desc, sizeof(bitdepth_desc), "%d", job->huffcode_bitdepth);
+  snprintf(fast_lut_desc, sizeof(fast_lut_desc), "%d (table in %s)", 
+      job->fast_lut_bits, job->fast_lut_section);
+  fprintf(job->to_stdout ? stderr : stdout, 
+      "Compressing " BOLD("%s") " and formatting to %s:\n"
+      COLOR_BOLD(34, "Output file:") "\t\t\t" BOLD("%s\n")
+      COLOR_BOLD(34, "Output Directory:") "\t\t" BOLD("%s\n")
+      COLOR_BOLD(34, "Output Symbol Prefix:") "\t\t" BOLD("%s\n")
+      COLOR_BOLD(34, "Output Source Code Type:") "\t" BOLD("%s\n")
+      COLOR_BOLD(34, "Codec:") "\t\t\t\t" BOLD("%s\n")
+      COLOR_BOLD(34, "Huffcode Bitdepth:") "\t\t" BOLD("%s\n")
+      COLOR_BOLD(34, "Streaming Mode:") "\t\t\t" BOLD("%s\n")
+      COLOR_BOLD(34, "Verify Output:") "\t\t\t" BOLD("%s\n")
+      COLOR_BOLD(34, "GBA Source Region:") "\t\t" BOLD("%s\n")
+      COLOR_BOLD(34, "Fast Decoder Lookup Bits:") "\t" BOLD("%s\n")
+      COLOR_BOLD(34, "Generate C Header File:") "\t\t" BOLD("%s\n")
+      COLOR_BOLD(34, "Output Cache:") "\t\t\t" BOLD("%s%s\n"), job->infile,
+      job_svc_desc(job),
+      job->to_stdout ? "[stdout]" : job->outfile, job->output_dir, job->output_objname, 
+      job->type?(job->type=='c'?"C":(job->type=='s'?"ASM":(job->type=='o'?"OBJ":"[N/A]"))):"[ERROR]", codec_desc, bitdepth_desc, 
+      job->stream_mode ? COLOR(34, "True") : COLOR(31, "False"),
+      job->verify ? COLOR(34, "True") : COLOR(31, "False"),
+      Huff_GBA_Region_Name(job->src_region),
+      job->fast_lut_bits ? fast_lut_desc : COLOR(31, "None"),
+      job->generate_include ? COLOR(34, "True") : COLOR(31, "False"),
+      job->cache_dir ? job->cache_dir : COLOR(31, "None"), 
+      job->depfile ? " (+ Make dependency file)" : "");
+}
+
+/**
+ * @brief If the hufftree had to be length-limited to fit the GBA tree table,
+ * say how much compression ratio that cost.
+ * */
+void job_report_tree_cost(const CliJob_t *job, const HuffTree_t *tree) {
+  if (tree->bit_ct <= tree->unconstrained_bit_ct)
+    return;
+  uint64_t extra = tree->bit_ct - tree->unconstrained_bit_ct;
+  fprintf(job->to_stdout ? stderr : stdout, 
+      COLOR_BOLD(34, "GBA Table Constraint:") "		codes of " BOLD("%s") 
+      " capped at " BOLD("%d bits") " to keep every tree table offset in "
+      "range, costing " BOLD("%llu bytes") " (+%.3f%%)\n", job->infile, 
+      tree->root->height, (unsigned long long)(extra+7)/8, 
+      100.0*extra/tree->unconstrained_bit_ct);
+}
+
+/// Say which bitdepth -b auto picked, and what the other would've cost.
+void job_report_auto_bitdepth(const CliJob_t *job, const HuffTree_t *tree,
+    const uint32_t auto_byte_cts[2]) {
+  fprintf(job->to_stdout ? stderr : stdout, 
+      COLOR_BOLD(34, "Bitdepth Auto-Selection:") "\t" BOLD("%d-bit") 
+      " picked for " BOLD("%s") ", predicted " BOLD("%u bytes") " at 4-bit, " 
+      BOLD("%u bytes") " at 8-bit\n", tree->data_unit_bitlen, job->infile,
+      auto_byte_cts[0], auto_byte_cts[1]);
+}
+
+/// Say how long the GBA BIOS is expected to take to decompress the output.
+void job_report_decode_cost(const CliJob_t *job, 
+    const HuffGBADecodeCost_t *cost, size_t data_size) {
+  fprintf(job->to_stdout ? stderr : stdout, 
+      COLOR_BOLD(34, "Est. GBA Decode Cost:") "\t\t" BOLD("%llu cycles") 
+      " (%.2f ms, %.2f frames, %.1f cycles/byte) reading from " BOLD("%s") 
+      ", worst " BOLD("%d cycles") " per unit\n", 
+      (unsigned long long)cost->cycles, 1000.0*cost->cycles/HUFF_GBA_CPU_HZ,
+      (double)cost->cycles/HUFF_GBA_FRAME_CYCLES, 
+      data_size ? (double)cost->cycles/data_size : 0.0,
+      Huff_GBA_Region_Name(cost->src_region), cost->worst_unit_cycles);
+}
+
+/**
+ * @brief With --incbin, open the raw side file job's ASM src file pulls its 
+ * compressed data in from: the output file, with INCBIN_SUFFIX for its ".s".
+ * Raw GBA data tends to be named *.bin itself, so as not to write over the 
+ * input, the side file's refused if it turns out to be the input file.
+ * @param name Gets the side file's name as .incbin opens it, i.e.: without 
+ * the output directory. Needs room for strlen(job->outfile) + 
+ * sizeof(INCBIN_SUFFIX) chars.
+ * @param dst Gets the side file, or NULL without --incbin.
+ * @return 0 on success, -1 on failure (already reported).
+ * */
+int job_open_incbin(const CliJob_t *job, char *name, FILE **dst) {
+  const int base_len = strlen(job->outfile) - 2;
+  char path[strlen(job->output_dir) + base_len + sizeof(INCBIN_SUFFIX)];
+  struct stat in_st, side_st;
+  *dst = NULL;
+  if (!job->incbin)
+    return 0;
+  sprintf(name, "%.*s" INCBIN_SUFFIX, base_len, job->outfile);
+  snprintf(path, sizeof(path), "%s%s", job->output_dir, name);
+  if (strcmp("-", job->infile) && 0 == stat(job->infile, &in_st) 
+      && 0 == stat(path, &side_st) && in_st.st_dev == side_st.st_dev 
+      && in_st.st_ino == side_st.st_ino) {
+    perrf(COLOR_BOLD(34, "--incbin") " side file, " BOLD("%s") ", is the "
+        "input file itself. Pick another output file name with " 
+        COLOR_BOLD(34, "-o") ".\n", path);
+    return -1;
+  }
+  return NULL == (*dst = job_open_output(job, path, "raw data")) ? -1 : 0;
+}
+
+/**
+ * @brief Write job's fast decoder source file next to its output src file,
+ * from the same table the output src was made with.
+ * @return 0 on success, -1 on failure (already reported).
+ * */
+int job_write_fast_decoder(HuffCtx_t *ctx, const CliJob_t *job, 
+    const HuffTree_t *tree, const char *infile_truncated, int complen) {
+  // the output file name minus its ".c"/".s"
+  const int base_len = strlen(job->outfile) - 2;
+  char path[strlen(job->output_dir) + base_len + sizeof("_fastdec.c")];
+  HuffNode_GBA_t *gba_treetable;
+  uint16_t *lut;
+  int tablelen;
+  FILE *ofp;
+  snprintf(path, sizeof(path), "%s%.*s_fastdec.c", job->output_dir, base_len, 
+      job->outfile);
+
+  if (NULL == (gba_treetable = Huff_Ctx_GBA_Huff_Table_Create(ctx, tree, 
+          &tablelen))) {
+    perrf("Failed to create GBA HuffTree table.\n\t\x1b[1;34mDetails: \x1b[39m"
+        "%s\x1b[0m\n", Huff_Ctx_Strerror(ctx));
+    return -1;
+  }
+  if (NULL == (lut = Huff_Ctx_Fast_Lut_Create(ctx, gba_treetable, tablelen, 
+          tree->data_unit_bitlen, job->fast_lut_bits))) {
+    perrf("Failed to create fast decoder lookup table.\n\t"
+        "\x1b[1;34mDetails: \x1b[39m%s\x1b[0m\n", Huff_Ctx_Strerror(ctx));
+    Huff_Ctx_Free(ctx, gba_treetable);
+    return -1;
+  }
+  if (NULL == (ofp = job_open_output(job, path, "fast decoder"))) {
+    Huff_Ctx_Free(ctx, lut);
+    Huff_Ctx_Free(ctx, gba_treetable);
+    return -1;
+  }
+  write_fast_decoder_file(ofp, job->exename, infile_truncated, 
+      job->output_objname, tree, lut, job->fast_lut_bits, 
+      job->fast_lut_section, (sizeof(HuffHeader_GBA_t) + tablelen)/4 + complen);
+  fclose(ofp);
+  Huff_Ctx_Free(ctx, lut);
+  Huff_Ctx_Free(ctx, gba_treetable);
+
+  fprintf(stdout, COLOR_BOLD(34, "Fast Decoder:") "\t\t\t" BOLD("%s") 
+      ", " BOLD("%zu byte") " lookup table, " BOLD("%.3f") " table reads per "
+      "unit (BIOS: %.3f)\n", path, sizeof(*lut)<<job->fast_lut_bits, 
+      Huff_Fast_Lut_Reads_Per_Unit(tree, job->fast_lut_bits), 
+      Huff_Fast_Lut_Reads_Per_Unit(tree, 0));
+  return 0;
+}
+
+/// @return 0 if what got decoded is the input, -1 (reported) if not.
+static int check_decoded(const char *infile, const byte *decoded, 
+    const void *data, size_t data_size) {
+  size_t at = 0;
+  if (!memcmp(decoded, data, data_size))
+    return 0;
+  while (decoded[at] == ((const byte*)data)[at])
+    ++at;
+  perrf("Verification of " COLOR_BOLD(32, "%s") " failed. Compressed output "
+      "first decodes differently at byte " BOLD("%zu") ".\n", infile, at);
+  return -1;
+}
+
+/**
+ * @brief Decode compdata back out, exactly as the GBA BIOS would see it, and 
+ * check it against the data it was compressed from.
+ * @return 0 if it round-trips, -1 if not (already reported).
+ * */
+int verify_output(HuffCtx_t *ctx, const char *infile, HuffHeader_GBA_t gba_hdr,
+    const HuffNode_GBA_t *gba_treetable, int tablelen, const uint32_t *compdata, 
+    int complen, const void *data, size_t data_size) {
+  byte *decoded;
+  int ret = -1;
+  if (NULL == (decoded = malloc(data_size))) {
+    perr("Failed to allocate buffer to verify output in.\n");
+    return -1;
+  }
+  if (0 > Huff_Ctx_Decode(ctx, gba_hdr, gba_treetable, tablelen, compdata, 
+        complen, decoded)) {
+    perrf("Verification of " COLOR_BOLD(32, "%s") " failed.\n\t"
+        "\x1b[1;34mDetails: \x1b[39m%s\x1b[0m\n", infile, 
+        Huff_Ctx_Strerror(ctx));
+  } else {
+    ret = check_decoded(infile, decoded, data, data_size);
+  }
+  free(decoded);
+  return ret;
+}
+
+/**
+ * @brief Load job's input, or take over the one already loaded for it.
+ * @return 0 on success, -1 on failure (already reported).
+ * */
+static int job_load_input(const CliJob_t *job, HuffInput_t *input) {
+  if (job->input) {
+    *input = *job->input;
+    *job->input = (HuffInput_t) {0};
+    return 0;
+  }
+  if (0 > Huff_Input_Load(input, 
+        strcmp("-", job->infile) ? job->infile : "/dev/stdin", job->use_mmap)) {
+    int errno_save = errno;
+    perrf("Failed to load input file, " COLOR_BOLD(32, "%s") ".", job->infile);
+    if (errno_save != 0) {
+      fprintf(stderr, "\n\t" COLOR_BOLD(31, "[Details]: ") "%s\n", 
+          strerror(errno_save));
+    } else {
+      fputc('\n', stderr);
+    }
+    return -1;
+  }
+  return 0;
+}
+
+/**
+ * @brief The pipeline stages (see huff_pipeline.h) job's codec comes after, 
+ * first applied first: its -f filter, then every -c chain link ahead of it.
+ * @return The stage count, 0 if it has none.
+ * */
+static int job_pre_stages(const CliJob_t *job, HuffStage_e *dst) {
+  int stage_ct = 0;
+  if (job->diff_unit_bitlen > 0)
+    dst[stage_ct++] = job->diff_unit_bitlen == 8 
+      ? E_HUFF_STAGE_DIFF8 : E_HUFF_STAGE_DIFF16;
+  for (int i = 0; i < job->pre_codec_ct; ++i) {
+    switch (job->pre_codecs[i]) {
+      case E_CLI_CODEC_LZ77:
+        dst[stage_ct++] = job->vram_safe 
+          ? E_HUFF_STAGE_LZ77_VRAM : E_HUFF_STAGE_LZ77;
+        break;
+      case E_CLI_CODEC_RLE:
+        dst[stage_ct++] = E_HUFF_STAGE_RLE;
+        break;
+      default:
+        // no histogram to pick by yet, so -b auto means 8 here
+        dst[stage_ct++] = job->huffcode_bitdepth == E_DATA_UNIT_4_BITS 
+          ? E_HUFF_STAGE_HUFF4 : E_HUFF_STAGE_HUFF8;
+        break;
+    }
+  }
+  return stage_ct;
+}
+
+/**
+ * @brief Run input through every stage job's codec comes after (see 
+ * job_pre_stages), each one on the one before's output, and swap input's 
+ * data for the last one's, which is what the codec compresses instead. 
+ * Reports what every stage did, and how much they lowered the entropy. With 
+ * --verify, the staged data has to decode back to the input first.
+ * @param stages Gets what each stage did, first applied first.
+ * @return The stage count, 0 if there are none, or -1 on failure (already 
+ * reported), in which case input is left as it was.
+ * */
+int job_apply_stages(HuffCtx_t *ctx, const CliJob_t *job, HuffInput_t *input,
+    HuffPipelineStageInfo_t *stages) {
+  FILE *ostream = job->to_stdout ? stderr : stdout;
+  const size_t byte_ct = input->padded_byte_ct;
+  HuffStage_e chain[HUFF_PIPELINE_MAX_STAGES];
+  uint32_t before[256] = {0}, after[256] = {0}, *staged;
+  const int stage_ct = job_pre_stages(job, chain);
+  int word_ct = 0;
+  byte *copy;
+  if (!stage_ct)
+    return 0;
+  // every stage but the last one the codec adds gets decoded from EWRAM
+  if (NULL == (staged = Huff_Ctx_Pipeline_Compress(ctx, input->data, byte_ct,
+          chain, stage_ct, E_HUFF_GBA_REGION_EWRAM, &word_ct, stages))) {
+    perrf("Failed to run %s through stage%s ahead of the codec.\n\t"
+        "\x1b[1;33mDetails: \x1b[2;31m%s\x1b[0m\n", job->infile, 
+        stage_ct == 1 ? "" : "s", Huff_Ctx_Strerror(ctx));
+    return -1;
+  }
+  if (job->verify) {
+    byte *decoded = malloc(byte_ct);
+    int verified = -1;
+    if (!decoded) {
+      perr("Failed to allocate buffer to verify stages in.\n");
+    } else if (0 > Huff_Ctx_Pipeline_Decompress(ctx, staged, word_ct*4, 
+          chain, stage_ct, decoded)) {
+      perrf("Verification of " COLOR_BOLD(32, "%s") "'s stages failed.\n\t"
+          "\x1b[1;34mDetails: \x1b[39m%s\x1b[0m\n", job->infile, 
+          Huff_Ctx_Strerror(ctx));
+    } else {
+      verified = check_decoded(job->infile, decoded, input->data, byte_ct);
+    }
+    free(decoded);
+    if (verified < 0) {
+      Huff_Ctx_Free(ctx, staged);
+      return -1;
+    }
+  }
+  // input gets released with free(), whatever ctx allocates with
+  if (NULL == (copy = malloc(word_ct*4))) {
+    perr("Failed to allocate buffer to stage input into.\n");
+    Huff_Ctx_Free(ctx, staged);
+    return -1;
+  }
+  memcpy(copy, staged, word_ct*4);
+  Huff_Ctx_Free(ctx, staged);
+
+  for (int i = 0; i < stage_ct; ++i) {
+    fprintf(ostream, COLOR_BOLD(34, "Stage %d (%s):") "\t\t" BOLD("%u bytes") 
+        " -> " BOLD("%u bytes") ", est. %.2f frames to decode with %s\n", i+1,
+        Huff_Stage_Name(stages[i].stage), stages[i].in_byte_ct, 
+        stages[i].out_byte_ct, 
+        (double)stages[i].decode_cycles/HUFF_GBA_FRAME_CYCLES, 
+        Huff_Stage_SVC_Name(stages[i].stage));
+  }
+  Huff_Histogram_Add_Bytes(before, input->data, byte_ct);
+  Huff_Histogram_Add_Bytes(after, copy, word_ct*4);
+  const double before_bits = Huff_Histogram_Entropy(before),
+        after_bits = Huff_Histogram_Entropy(after);
+  fprintf(ostream, COLOR_BOLD(34, "Staged Entropy:") "\t\t\t" BOLD("%.3f") 
+      " bits/byte before, " BOLD("%.3f") " after (order-0 bound of " 
+      BOLD("%.0f bytes") " -> " BOLD("%.0f bytes") ")\n", before_bits, 
+      after_bits, before_bits*byte_ct/8, after_bits*word_ct*4/8);
+
+  Huff_Input_Release(input);
+  *input = (HuffInput_t) {
+    .data = copy,
+    .byte_ct = word_ct*4,
+    .padded_byte_ct = word_ct*4,
+    .map_len = 0
+  };
+  return stage_ct;
+}
+
+/**
+ * @brief job_run for every codec but Huffman (-c lz77, -c rle), whose BIOS 
+ * formats go out as one array, through the same src and header writers.
+ * @param full_out_path Path of the output src file, whose last char gets 
+ * swapped for the header's.
+ * @return 0 on success, -1 on failure (already reported).
+ * */
+int job_run_codec(HuffCtx_t *ctx, const CliJob_t *job, 
+    const char *infile_truncated, char *full_out_path) {
+  const char *codec_name, *decode_with;
+  int compression_type;
+  HuffInput_t input = {0};
+  HuffGBADecodeCost_t decode_cost;
+  HuffLZ77Stats_t lz77_stats;
+  HuffRLEStats_t rle_stats;
+  HuffPipelineStageInfo_t stages[HUFF_PIPELINE_MAX_STAGES];
+  uint32_t *compdata;
+  int complen = 0, stage_ct;
+  size_t data_size, original_data_size;
+  char incbin_name[strlen(job->outfile)+sizeof(INCBIN_SUFFIX)];
+  FILE *ofp, *incbin_fp;
+
+  if (0 > job_load_input(job, &input))
+    return -1;
+  original_data_size = input.padded_byte_ct;
+  if (0 > (stage_ct = job_apply_stages(ctx, job, &input, stages))) {
+    Huff_Input_Release(&input);
+    return -1;
+  }
+  data_size = input.padded_byte_ct;
+  if (job->codec == E_CLI_CODEC_LZ77) {
+    codec_name = "LZ77";
+    decode_with = job->vram_safe 
+      ? "SVC 0x11 (LZ77UnCompWram) or SVC 0x12 (LZ77UnCompVram)"
+      : "SVC 0x11 (LZ77UnCompWram) only, as it isn't VRAM-safe";
+    compression_type = HUFF_LZ77_GBA_COMPRESSION_TYPE_ID;
+    compdata = Huff_Ctx_LZ77_Compress(ctx, input.data, data_size, 
+        job->vram_safe, &complen, &lz77_stats);
+    if (compdata)
+      Huff_GBA_LZ77_Decode_Cost_Estimate(&decode_cost, &lz77_stats, 
+          job->src_region);
+  } else {
+    codec_name = "RLE";
+    decode_with = "SVC 0x14 (RLUnCompWram) or SVC 0x15 (RLUnCompVram)";
+    compression_type = HUFF_RLE_GBA_COMPRESSION_TYPE_ID;
+    compdata = Huff_Ctx_RLE_Compress(ctx, input.data, data_size, &complen, 
+        &rle_stats);
+    if (compdata)
+      Huff_GBA_RLE_Decode_Cost_Estimate(&decode_cost, &rle_stats, 
+          job->src_region);
+  }
+  if (!compdata) {
+    perrf("Failed to compress.\n\t\x1b[1;33mDetails: \x1b[2;31m%s\x1b[0m\n",
+        Huff_Ctx_Strerror(ctx));
+    Huff_Input_Release(&input);
+    return -1;
+  }
+  // Nothing gets written unless it round-trips, on the SVC it's meant for
+  if (job->verify) {
+    byte *decoded = malloc(data_size);
+    int verified = -1;
+    if (!decoded) {
+      perr("Failed to allocate buffer to verify output in.\n");
+    } else if (0 > (job->codec == E_CLI_CODEC_LZ77
+          ? Huff_Ctx_LZ77_Decompress(ctx, compdata, complen*4, decoded, 
+            job->vram_safe)
+          : Huff_Ctx_RLE_Decompress(ctx, compdata, complen*4, decoded))) {
+      perrf("Verification of " COLOR_BOLD(32, "%s") " failed.\n\t"
+          "\x1b[1;34mDetails: \x1b[39m%s\x1b[0m\n", job->infile, 
+          Huff_Ctx_Strerror(ctx));
+    } else {
+      verified = check_decoded(job->infile, decoded, input.data, data_size);
+    }
+    free(decoded);
+    if (verified < 0) {
+      Huff_Input_Release(&input);
+      Huff_Ctx_Free(ctx, compdata);
+      return -1;
+    }
+  }
+  Huff_Input_Release(&input);
+
+  if (job->to_stdout) {
+    ofp = stdout;
+  } else if (NULL == (ofp = job_open_output(job, full_out_path, "src"))) {
+    Huff_Ctx_Free(ctx, compdata);
+    return -1;
+  }
+  if (0 > job_open_incbin(job, incbin_name, &incbin_fp)) {
+    fclose(ofp);
+    Huff_Ctx_Free(ctx, compdata);
+    return -1;
+  }
+  if (job->type == 'o') {
+    write_obj_codec_file(ofp, job->output_objname, codec_name, compdata, 
+        complen);
+  } else if (job->type == 'c') {
+    write_c_codec_src_file(ofp, job->exename, infile_truncated, 
+        job->output_objname, codec_name, decode_with, original_data_size, 
+        stages, stage_ct, compdata, complen);
+  } else {
+    write_asm_codec_src_file(ofp, job->exename, infile_truncated, 
+        job->output_objname, codec_name, decode_with, original_data_size, 
+        stages, stage_ct, compdata, complen, incbin_fp, incbin_name);
+  }
+  Huff_Ctx_Free(ctx, compdata);
+  if (ofp == stdout) {
+    fflush(ofp);
+  } else {
+    fclose(ofp);
+  }
+  if (incbin_fp)
+    fclose(incbin_fp);
+
+  if (!job->to_stdout && (job->type == 'c' || job->generate_include)) {
+    full_out_path[strlen(full_out_path)-1] = 'h';
+    if (NULL == (ofp = job_open_output(job, full_out_path, "header")))
+      return -1;
+    write_codec_header_file(ofp, job->exename, infile_truncated, job->outfile,
+        job->output_objname, codec_name, decode_with, data_size, 
+        original_data_size, complen, compression_type, stages, stage_ct, 
+        job->selection);
+    fclose(ofp);
+  }
+
+  if (job->codec == E_CLI_CODEC_LZ77) {
+    fprintf(job->to_stdout ? stderr : stdout, 
+        COLOR_BOLD(34, "LZ77 Compression:") "\t\t" BOLD("%zu bytes") " down to " 
+        BOLD("%d bytes") " (%.2f%%): %u literals, %u back-references of %.2f "
+        "bytes on average\n", data_size, complen*4, 100.0*complen*4/data_size,
+        lz77_stats.literal_ct, lz77_stats.match_ct, lz77_stats.match_ct 
+          ? (double)lz77_stats.matched_byte_ct/lz77_stats.match_ct : 0.0);
+  } else {
+    fprintf(job->to_stdout ? stderr : stdout, 
+        COLOR_BOLD(34, "RLE Compression:") "\t\t" BOLD("%zu bytes") " down to " 
+        BOLD("%d bytes") " (%.2f%%): %u runs covering %u bytes, %u literal "
+        "blocks covering %u bytes\n", data_size, complen*4, 
+        100.0*complen*4/data_size, rle_stats.run_ct, rle_stats.run_byte_ct, 
+        rle_stats.literal_block_ct, rle_stats.literal_byte_ct);
+  }
+  job_report_decode_cost(job, &decode_cost, data_size);
+  return 0;
+}
+
+/// Say how every -c auto candidate did, and which one won.
+void job_report_selection(const CliJob_t *job, 
+    const HuffSelectResult_t *selection) {
+  FILE *ostream = job->to_stdout ? stderr : stdout;
+  char name[32];
+  Huff_Select_Candidate_Name(name, sizeof(name), 
+      &selection->candidates[selection->winner]);
+  fprintf(ostream, COLOR_BOLD(34, "Codec Auto-Selection:") "\t\t" BOLD("%s") 
+      " picked for " BOLD("%s") " out of %d candidates\n", name, job->infile, 
+      selection->candidate_ct);
+  for (int i = 0; i < selection->candidate_ct; ++i) {
+    const HuffSelectCandidate_t *cand = &selection->candidates[i];
+    Huff_Select_Candidate_Name(name, sizeof(name), cand);
+    if (cand->status == E_HUFF_SELECT_MEASURED) {
+      fprintf(ostream, "\t%s%-16s%9u bytes, %.2f frames to decode%s\n", 
+          i == selection->winner ? "\x1b[1;32m" : "", name, cand->byte_ct, 
+          (double)cand->decode_cycles/HUFF_GBA_FRAME_CYCLES, 
+          i == selection->winner ? "\x1b[0m" : "");
+    } else if (cand->status == E_HUFF_SELECT_PRUNED) {
+      fprintf(ostream, "\t\x1b[2m%-16s%9u bytes at least, so not tried\x1b[0m\n",
+          name, cand->bound);
+    } else {
+      fprintf(ostream, "\t\x1b[2m%-16scan't compress this data\x1b[0m\n", name);
+    }
+  }
+}
+
+int job_run(HuffCtx_t *ctx, CliJob_t *job);
+
+/**
+ * @brief job_run for -c auto: find the codec, bitdepth and filter that 
+ * compress job's input best, then run job as if they'd been given.
+ * @return 0 on success, -1 on failure (already reported).
+ * */
+int job_run_auto(HuffCtx_t *ctx, CliJob_t *job) {
+  HuffSelectResult_t selection;
+  HuffInput_t input = {0};
+  const HuffSelectOpts_t opts = {
+    .src_region = job->src_region,
+    .frame_weight = job->frame_weight,
+    .filter_mask = job->diff_unit_bitlen < 0 ? HUFF_SELECT_FILTER_ALL
+      : job->diff_unit_bitlen == 8 ? HUFF_SELECT_FILTER_DIFF8
+      : job->diff_unit_bitlen == 16 ? HUFF_SELECT_FILTER_DIFF16
+      : HUFF_SELECT_FILTER_NONE,
+    .thread_ct = job->encode_thread_ct,
+    .vram_safe = job->vram_safe
+  };
+  int ret;
+  if (0 > job_load_input(job, &input))
+    return -1;
+  if (0 > Huff_Ctx_Select_Codec(ctx, input.data, input.padded_byte_ct, &opts,
+        &selection)) {
+    perrf("Failed to pick a codec.\n\t\x1b[1;33mDetails: \x1b[2;31m%s\x1b[0m\n",
+        Huff_Ctx_Strerror(ctx));
+    Huff_Input_Release(&input);
+    return -1;
+  }
+  job_report_selection(job, &selection);
+
+  const HuffSelectCandidate_t *winner = &selection.candidates[selection.winner];
+  CliJob_t picked = *job;
+  switch (winner->codec) {
+    case E_HUFF_CODEC_LZ77:
+      picked.codec = E_CLI_CODEC_LZ77;
+      break;
+    case E_HUFF_CODEC_RLE:
+      picked.codec = E_CLI_CODEC_RLE;
+      break;
+    default:
+      picked.codec = E_CLI_CODEC_HUFFMAN;
+      picked.huffcode_bitdepth = winner->codec == E_HUFF_CODEC_HUFF4 
+        ? E_DATA_UNIT_4_BITS : E_DATA_UNIT_8_BITS;
+      break;
+  }
+  picked.diff_unit_bitlen = winner->diff_unit_bitlen;
+  picked.pre_codec_ct = 0;
+  // job_normalize left these on for whichever codec won
+  if (picked.codec != E_CLI_CODEC_LZ77)
+    picked.vram_safe = false;
+  if (picked.codec != E_CLI_CODEC_HUFFMAN)
+    picked.fast_lut_bits = 0;
+  picked.input = &input;
+  picked.selection = &selection;
+  ret = job_run(ctx, &picked);
+  // still there if job_run failed before taking it over
+  Huff_Input_Release(&input);
+  return ret;
+}
+
+/**
+ * @brief Compress job's input and write its output src (and header) file(s).
+ * Everything goes through ctx, so jobs on different contexts can run 
+ * concurrently.
+ * @return 0 on success, -1 on failure (already reported).
+ * */
+int job_run(HuffCtx_t *ctx, CliJob_t *job) {
+  if (job->codec == E_CLI_CODEC_AUTO)
+    return job_run_auto(ctx, job);
+  const char *infile = job->infile, *outfile = job->outfile,
+        *output_objname = job->output_objname, *output_dir = job->output_dir,
+        *exename = job->exename;
+  const char type = job->type;
+  DataSize_e huffcode_bitdepth = job->huffcode_bitdepth;
+  const _Bool auto_bitdepth = huffcode_bitdepth == HUFFCODE_BITDEPTH_AUTO;
+  uint32_t auto_byte_cts[2] = {0};
+  const char *infile_truncated = infile + strlen(infile);
+  if (!strcmp("-", infile)) {
+    infile_truncated = "stdin";
+  } else {
+    const char *begin = infile;
     do if (*--infile_truncated == '/') {
       ++infile_truncated;
       break;
@@ -778,76 +1949,668 @@ int main(int argc, char *argv[]) {
 
   }
 
-  if (type == 'c') {
-    write_c_src_file(ofp, argv[0], infile_truncated, output_objname, data_size, compdata, complen, gba_hdr, tree, gba_treetable, tablelen, huffcode_bitdepth);
+  HuffInput_t input = {0};
+  const void *data = NULL;
+  size_t data_size = 0UL, original_data_size;
+  HuffTree_t *tree = NULL;
+  uint32_t *compdata = NULL;
+  HuffNode_GBA_t *gba_treetable = NULL;
+  HuffHeader_GBA_t gba_hdr = {0};
+  HuffGBADecodeCost_t decode_cost;
+  HuffPipelineStageInfo_t stages[HUFF_PIPELINE_MAX_STAGES];
+  int complen = 0, tablelen=0, stage_ct = 0;
+  FILE *ofp = NULL, *incbin_fp = NULL;
+  char full_out_path[strlen(outfile)+strlen(output_dir)+1], 
+       incbin_name[strlen(outfile)+sizeof(INCBIN_SUFFIX)];
+  snprintf(full_out_path, sizeof(full_out_path), "%s%s", output_dir, outfile);
+
+  assert(full_out_path[sizeof(full_out_path)-1] == '\0');
+
+  if (job->codec != E_CLI_CODEC_HUFFMAN)
+    return job_run_codec(ctx, job, infile_truncated, full_out_path);
+
+  // filtering and chaining read the whole input in, even from stdin
+  if (job->stream_mode && !job->diff_unit_bitlen && !job->pre_codec_ct) {
+    if (job->to_stdout) {
+      ofp = stdout;
+    } else if (NULL == (ofp = job_open_output(job, full_out_path, "src"))) {
+      return -1;
+    }
+    if (0 > job_open_incbin(job, incbin_name, &incbin_fp)) {
+      if (ofp != stdout)
+        fclose(ofp);
+      return -1;
+    }
+    if (0 > stream_compress(ctx, ofp, exename, infile, infile_truncated, 
+          output_objname, type, incbin_fp, incbin_name, &huffcode_bitdepth, 
+          auto_byte_cts, job->verify, &tree, &data_size, &complen, 
+          &tablelen)) {
+      if (incbin_fp)
+        fclose(incbin_fp);
+      if (ofp != stdout) {
+        fclose(ofp);
+        // What's been written of output that didn't verify can't be trusted
+        if (job->verify)
+          remove(full_out_path);
+      }
+      return -1;
+    }
+    original_data_size = data_size;
+  } else {
+    if (0 > job_load_input(job, &input))
+      return -1;
+    original_data_size = input.padded_byte_ct;
+    if (0 > (stage_ct = job_apply_stages(ctx, job, &input, stages))) {
+      Huff_Input_Release(&input);
+      return -1;
+    }
+    data = input.data;
+    data_size = input.padded_byte_ct;
+    assert(!(data_size&3));
+
+    size_t data_word_ct = data_size/4;
+    int freq[256] = {0};
+    Huff_Histogram_Add_Parallel(freq, data, data_size, 
+        auto_bitdepth ? E_DATA_UNIT_8_BITS : huffcode_bitdepth, 
+        job->encode_thread_ct);
+    if (NULL == (tree = create_tree(ctx, freq, huffcode_bitdepth, 
+            auto_byte_cts))) {
+      Huff_Input_Release(&input);
+      return -1;
+    }
+    huffcode_bitdepth = tree->data_unit_bitlen;
+    compdata = Huff_Ctx_Compress_Parallel(ctx, data, tree, data_word_ct, 
+        &complen, job->encode_thread_ct);
+    if (!compdata) {
+      perrf("Failed to compress.\n\t\x1b[1;33mDetails: \x1b[2;31m%s\x1b[0m\n",
+          Huff_Ctx_Strerror(ctx));
+      Huff_Input_Release(&input);
+      Huff_Tree_Destroy(tree);
+      return -1;
+    }
+
+    if (0 > Huff_Ctx_GBA_Header_Init(ctx, &gba_hdr, data_size, huffcode_bitdepth)) {
+      perrf("Failed to create GBA Header.\n\t\x1b[1;34mDetails: \x1b[39m"
+          "%s\x1b[0m\n", Huff_Ctx_Strerror(ctx));
+      Huff_Input_Release(&input);
+      Huff_Tree_Destroy(tree);
+      Huff_Ctx_Free(ctx, compdata);
+      return -1;
+    }
+
+    gba_treetable = Huff_Ctx_GBA_Huff_Table_Create(ctx, tree, &tablelen);
+    if (!gba_treetable) {
+      perrf("Failed to create GBA HuffTree table.\n\t\x1b[1;34mDetails: \x1b[39m"
+          "%s\x1b[0m\n", Huff_Ctx_Strerror(ctx));
+      Huff_Input_Release(&input);
+      Huff_Tree_Destroy(tree);
+      Huff_Ctx_Free(ctx, compdata);
+      return -1;
+    }
+
+    // Nothing gets written unless it round-trips
+    if (job->verify && 0 > verify_output(ctx, infile, gba_hdr, gba_treetable, 
+          tablelen, compdata, complen, data, data_size)) {
+      Huff_Input_Release(&input);
+      Huff_Tree_Destroy(tree);
+      Huff_Ctx_Free(ctx, compdata);
+      Huff_Ctx_Free(ctx, gba_treetable);
+      return -1;
+    }
+    Huff_Input_Release(&input);
+
+    if (job->to_stdout) {
+      ofp = stdout;
+    } else if (NULL == (ofp = job_open_output(job, full_out_path, "src"))) {
+      Huff_Tree_Destroy(tree);
+      Huff_Ctx_Free(ctx, compdata);
+      Huff_Ctx_Free(ctx, gba_treetable);
+      return -1;
+    }
+    if (0 > job_open_incbin(job, incbin_name, &incbin_fp)) {
+      if (ofp != stdout)
+        fclose(ofp);
+      Huff_Tree_Destroy(tree);
+      Huff_Ctx_Free(ctx, compdata);
+      Huff_Ctx_Free(ctx, gba_treetable);
+      return -1;
+    }
+  
+    if (type == 'o') {
+      write_obj_file(ofp, output_objname, compdata, complen, gba_hdr, 
+          gba_treetable, tablelen);
+    } else if (type == 'c') {
+      write_c_src_file(ofp, exename, infile_truncated, output_objname, original_data_size, stages, stage_ct, compdata, complen, gba_hdr, tree, gba_treetable, tablelen, huffcode_bitdepth);
+    } else {
+      write_asm_src_file(ofp, exename, infile_truncated, output_objname, original_data_size, stages, stage_ct, compdata, complen, gba_hdr, tree, gba_treetable, tablelen, huffcode_bitdepth, incbin_fp, incbin_name);
+    }
+    Huff_Ctx_Free(ctx, compdata);
+    Huff_Ctx_Free(ctx, gba_treetable);
+  }
+
+  if (ofp == stdout) {
+    fflush(ofp);
+  } else {
     fclose(ofp);
+  }
+  if (incbin_fp)
+    fclose(incbin_fp);
+  Huff_GBA_Decode_Cost_Estimate(&decode_cost, tree, job->src_region);
+
+  if (!job->to_stdout && (type == 'c' || job->generate_include)) {
     full_out_path[sizeof(full_out_path)-2] = 'h';
-    if (NULL == (ofp = fopen(full_out_path, "w"))) {
-      int errnosave = errno;
-      if (errnosave != 0) {
-        perrf("Failed to open output header file, " BOLD("%s\n\t")
-            COLOR_BOLD(31, "Details: ") "%s\n", full_out_path, strerror(errnosave));
+    if (NULL == (ofp = job_open_output(job, full_out_path, "header"))) {
+      Huff_Tree_Destroy(tree);
+      return -1;
+    }
+    write_header_file(ofp, exename, infile_truncated, outfile, output_objname, data_size, original_data_size, complen, tree->node_ct, tablelen, huffcode_bitdepth, type != 'c', &decode_cost, 
+        job->fast_lut_bits, auto_bitdepth ? auto_byte_cts : NULL, 
+        stages, stage_ct, job->selection);
+    fclose(ofp);
+  }
+
+  if (job->fast_lut_bits && 0 > job_write_fast_decoder(ctx, job, tree, 
+        infile_truncated, complen)) {
+    Huff_Tree_Destroy(tree);
+    return -1;
+  }
+
+  if (auto_bitdepth)
+    job_report_auto_bitdepth(job, tree, auto_byte_cts);
+  job_report_tree_cost(job, tree);
+  job_report_decode_cost(job, &decode_cost, data_size);
+  Huff_Tree_Destroy(tree);
+  return 0;
+}
+
+/**
+ * @brief Describe every setting of job's that affects what its outputs hold 
+ * (or what they're named), for its output cache key. Left out are the ones 
+ * that only affect how it gets there, like -j, --stream and --no-mmap, and 
+ * the output directory, so a cache entry can be placed anywhere.
+ * @return The description's length, as snprintf would.
+ * */
+int job_cache_desc(const CliJob_t *job, char *dst, size_t size) {
+  const char *infile_base = strrchr(job->infile, '/');
+  char chain[96];
+  int chain_len = 0;
+  for (int i = 0; i < job->pre_codec_ct; ++i)
+    chain_len += snprintf(chain + chain_len, sizeof(chain) - chain_len, "%s+",
+        cli_codec_names[job->pre_codecs[i]]);
+  snprintf(chain + chain_len, sizeof(chain) - chain_len, "%s", 
+      cli_codec_names[job->codec]);
+  // a hit stored without --verify never got checked
+  return snprintf(dst, size, "huffman %s in=%s out=%s n=%s t=%c b=%d c=%s "
+      "f=%d w=%.17g l=%d s=%s r=%d include=%d vram-safe=%d incbin=%d "
+      "verify=%d", job->exename, infile_base ? infile_base+1 : job->infile, 
+      job->outfile, job->output_objname, job->type, job->huffcode_bitdepth, 
+      chain, job->diff_unit_bitlen, job->frame_weight, job->fast_lut_bits, 
+      job->fast_lut_section, job->src_region, job->generate_include, 
+      job->vram_safe, job->incbin, job->verify);
+}
+
+/**
+ * @brief job_run, looked up in and added to job's output cache (-k) if it 
+ * has one, then writing job's Make dependency file (--depfile) if it wants 
+ * one. On a hit, nothing gets compressed, so none of the usual stats are 
+ * reported. If job->outputs is set, the dependency file gets listed last.
+ * @return 0 on success, -1 on failure (already reported).
+ * */
+int job_run_cached(HuffCtx_t *ctx, CliJob_t *job) {
+  if (!job->cache_dir && !job->depfile)
+    return job_run(ctx, job);
+  AssetCacheFiles_t own_outputs = {0}, *const caller_outputs = job->outputs,
+    *const outputs = caller_outputs ? caller_outputs : &own_outputs;
+  AssetCacheKey_t key;
+  HuffInput_t input = {0};
+  char desc[job_cache_desc(job, NULL, 0)+1];
+  int hit = 0, ret = 0;
+  job_cache_desc(job, desc, sizeof(desc));
+
+  if (job->cache_dir) {
+    if (0 > job_load_input(job, &input))
+      return -1;
+    Asset_Cache_Key_Init(&key, desc);
+    Asset_Cache_Key_Add(&key, input.data, input.byte_ct);
+    if (0 > (hit = Asset_Cache_Fetch(job->cache_dir, &key, job->output_dir, 
+            outputs))) {
+      warnf("Failed to place " BOLD("%s") "'s cached outputs (%s). "
+          "Compressing it instead.\n", job->infile, strerror(errno));
+      hit = 0;
+    }
+  }
+  if (hit) {
+    Huff_Input_Release(&input);
+    fprintf(stdout, COLOR_BOLD(34, "Output Cache:") "\t\t\t" BOLD("Hit") 
+        ", %d files linked in from " BOLD("%s") "\n", outputs->ct, 
+        job->cache_dir);
+  } else {
+    // streaming reads the input back in a chunk at a time anyway
+    if (job->stream_mode)
+      Huff_Input_Release(&input);
+    else if (job->cache_dir)
+      job->input = &input;
+    job->outputs = outputs;
+    ret = job_run(ctx, job);
+    job->outputs = caller_outputs;
+    job->input = NULL;
+    Huff_Input_Release(&input);
+    if (ret < 0)
+      return -1;
+    if (job->cache_dir) {
+      if (0 > Asset_Cache_Store(job->cache_dir, &key, job->output_dir, 
+            outputs)) {
+        warnf("Failed to add " BOLD("%s") "'s outputs to the output cache, "
+            BOLD("%s") " (%s).\n", job->infile, job->cache_dir, 
+            strerror(errno));
       } else {
-        perrf("Failed to open output header file, " BOLD("%s\n\t"), full_out_path);
+        fprintf(stdout, COLOR_BOLD(34, "Output Cache:") "\t\t\t" 
+            BOLD("Miss") ", %d files added to " BOLD("%s") "\n", outputs->ct, 
+            job->cache_dir);
       }
-      Huff_Tree_Destroy(tree);
-      free(compdata);
-      free(gba_treetable);
+    }
+  }
+
+  if (job->depfile) {
+    const int base_len = strlen(job->outfile) - 2;
+    const char *prereqs[] = { job->infile };
+    char path[strlen(job->output_dir) + base_len + sizeof(".d")];
+    snprintf(path, sizeof(path), "%s%.*s.d", job->output_dir, base_len, 
+        job->outfile);
+    if (0 > Asset_Depfile_Write(path, job->output_dir, outputs, prereqs, 1)) {
+      perrf("Failed to write Make dependency file, " BOLD("%s\n\t")
+          COLOR_BOLD(31, "Details: ") "%s\n", path, strerror(errno));
       return -1;
     }
-    write_header_file(ofp, argv[0], infile_truncated, outfile, output_objname, data_size, complen, tree->node_ct, tablelen, huffcode_bitdepth, false);
+    Asset_Cache_Files_Add(outputs, path + strlen(job->output_dir));
+  }
+  return 0;
+}
+
+static int batch_job_cb(HuffCtx_t *ctx, void *job) {
+  CliJob_t *cur = job;
+  int ret = job_run_cached(ctx, cur);
+  // one fprintf per job, so lines from different workers don't interleave
+  if (ret < 0) {
+    fprintf(stderr, COLOR_BOLD(31, "[FAILED]") " %s\n", cur->infile);
   } else {
-    do {
-      write_asm_src_file(ofp, argv[0], infile_truncated, output_objname, data_size, compdata, complen, gba_hdr, tree, gba_treetable, tablelen, huffcode_bitdepth);
-      fclose(ofp);
+    fprintf(stdout, COLOR_BOLD(32, "[OK]") " %s -> %s%s\n", cur->infile, 
+        cur->output_dir, cur->outfile);
+  }
+  return ret;
+}
 
-      if (!generate_include)
-        break;
-      full_out_path[sizeof(full_out_path)-2] = 'h';
-      if (NULL == (ofp = fopen(full_out_path, "w"))) {
-        int errnosave = errno;
-        if (errnosave != 0) {
-          perrf("Failed to open output header file, " BOLD("%s\n\t")
-              COLOR_BOLD(31, "Details: ") "%s\n", full_out_path, strerror(errnosave));
-        } else {
-          perrf("Failed to open output header file, " BOLD("%s\n\t"), full_out_path);
-        }
-        Huff_Tree_Destroy(tree);
-        free(compdata);
-        free(gba_treetable);
+/**
+ * @brief Split one line of a batch response file into args, in place. Args 
+ * are separated by whitespace, and can be double-quoted to include it. 
+ * Everything from an unquoted # on is a comment.
+ * @return Arg count.
+ * */
+int split_response_line(char *line, const char **args, int max_args) {
+  int ct = 0;
+  char *rd = line, *wr;
+  while (ct < max_args) {
+    while (isspace(*rd))
+      ++rd;
+    if (!*rd || *rd == '#')
+      break;
+    args[ct++] = wr = rd;
+    _Bool quoted = false;
+    for (; *rd && (quoted || !isspace(*rd)); ++rd) {
+      if (*rd == '"') {
+        quoted = !quoted;
+        continue;
+      }
+      *wr++ = *rd;
+    }
+    if (*rd)
+      ++rd;
+    *wr = '\0';
+  }
+  return ct;
+}
+
+#define BATCH_MAX_JOB_ARGS 32
+#define BATCH_RESPONSE_LINE_MAX 4096
+
+/**
+ * @brief Parse the jobs out of a response file, one per line, each line being
+ * exactly the args a single-file run would take (input first).
+ * @param job_ct Gets bumped for every job parsed, even on failure, so those 
+ * can still be released.
+ * @return 0 on success, -1 on failure (already reported).
+ * */
+int parse_response_file(const char *exename, const char *path, 
+    CliJob_t **jobs, int *job_ct, int *job_cap) {
+  char line[BATCH_RESPONSE_LINE_MAX];
+  const char *args[BATCH_MAX_JOB_ARGS+1];
+  int argc, lineno = 0;
+  FILE *fp = fopen(path, "r");
+  if (!fp) {
+    int errno_save = errno;
+    perrf("Failed to open batch response file, " COLOR_BOLD(32, "%s") ".\n\t"
+        COLOR_BOLD(31, "[Details]: ") "%s\n", path, strerror(errno_save));
+    return -1;
+  }
+  args[0] = exename;
+  while (fgets(line, sizeof(line), fp)) {
+    ++lineno;
+    if (!(argc = split_response_line(line, args+1, BATCH_MAX_JOB_ARGS)))
+      continue;
+    if (*job_ct == *job_cap) {
+      CliJob_t *tmp = realloc(*jobs, sizeof(**jobs)*(*job_cap *= 2));
+      if (!tmp) {
+        perr("Failed to allocate batch job list.\n");
+        fclose(fp);
         return -1;
       }
-      write_header_file(ofp, argv[0], infile_truncated, outfile, output_objname, data_size, complen, tree->node_ct, tablelen, huffcode_bitdepth, true);
-    } while (0);  // "do ... while (0); is the `Poor Man's` try catch," a wise man once said!
+      *jobs = tmp;
+    }
+    if (0 > job_init(&(*jobs)[*job_ct], argc+1, args)) {
+      perrf("Failed to parse job on line " BOLD("%d") " of batch response "
+          "file, " COLOR_BOLD(32, "%s") ".\n", lineno, path);
+      fclose(fp);
+      return -1;
+    }
+    ++*job_ct;
   }
+  fclose(fp);
+  return 0;
+}
 
-  /*
-  if (!ofp) {
-    perrf("Failed to open, \x1b[1m\"%s\"\x1b[0m for outwriting.\n\t\x1b[1;34m"
-        "Details:\x1b[39m %s\x1b[0m\n", outfile, strerror(errno));
-    Huff_Tree_Destroy(tree);
-    free(compdata);
-    free(gba_treetable);
+/**
+ * @brief Batch mode. argv looks like:
+ * <exe> --batch [-j <threads>] <job> [-- <job>]...
+ * where each job is either the args a single-file run would take (input 
+ * first), or @<response file> listing more jobs, one per line.
+ * */
+int batch_main(int argc, char *argv[]) {
+  int thread_ct = 0, job_ct = 0, job_cap = 16, fail_ct, i = 2, ret = 0;
+  CliJob_t *jobs = malloc(sizeof(*jobs)*job_cap);
+  if (!jobs) {
+    perr("Failed to allocate batch job list.\n");
+    return -1;
+  }
+  if (i+1 < argc && !strcmp("-j", argv[i])) {
+    thread_ct = atoi(argv[i+1]);
+    i += 2;
+  }
+  while (i < argc) {
+    int seg_end = i;
+    while (seg_end < argc && strcmp("--", argv[seg_end]))
+      ++seg_end;
+    if (seg_end == i) {
+      ++i;
+      continue;
+    }
+    if (argv[i][0] == '@' && seg_end == i+1) {
+      if (0 > parse_response_file(*argv, argv[i]+1, &jobs, &job_ct, 
+            &job_cap)) {
+        ret = -1;
+        goto CLEANUP;
+      }
+    } else {
+      // job args get their own argv, with the exe name standing in at [0]
+      const char *args[seg_end-i+1];
+      args[0] = *argv;
+      memcpy(&args[1], &argv[i], sizeof(*args)*(seg_end-i));
+      if (job_ct == job_cap) {
+        CliJob_t *tmp = realloc(jobs, sizeof(*jobs)*(job_cap *= 2));
+        if (!tmp) {
+          perr("Failed to allocate batch job list.\n");
+          ret = -1;
+          goto CLEANUP;
+        }
+        jobs = tmp;
+      }
+      if (0 > job_init(&jobs[job_ct], seg_end-i+1, args)) {
+        perrf("Failed to parse batch job #" BOLD("%d") ", starting at " 
+            BOLD("%s") ".\n", job_ct+1, argv[i]);
+        ret = -1;
+        goto CLEANUP;
+      }
+      ++job_ct;
+    }
+    i = seg_end+1;
+  }
+  for (i = 0; i < job_ct; ++i) {
+    if (jobs[i].to_stdout || !strcmp("-", jobs[i].infile)) {
+      perrf("Batch job #" BOLD("%d") ", " BOLD("%s") ", uses stdin/stdout, "
+          "which batch jobs can't share.\n", i+1, jobs[i].infile);
+      ret = -1;
+      goto CLEANUP;
+    }
+    // jobs already run in parallel with each other
+    if (!jobs[i].encode_thread_ct)
+      jobs[i].encode_thread_ct = 1;
+  }
+  if (!job_ct) {
+    perr("Batch mode given no jobs.\n");
+    ret = -1;
+    goto CLEANUP;
   }
 
-  
-  
+  if (thread_ct <= 0)
+    thread_ct = Batch_Default_Thread_Ct();
+  printf("Compressing " BOLD("%d") " inputs on " BOLD("%d") " threads.\n", 
+      job_ct, thread_ct < job_ct ? thread_ct : job_ct);
+  fail_ct = Batch_Run(jobs, sizeof(*jobs), job_ct, thread_ct, batch_job_cb);
+  if (fail_ct) {
+    perrf(BOLD("%d") " of " BOLD("%d") " batch jobs failed.\n", fail_ct, 
+        job_ct);
+    ret = -1;
+  }
+
+CLEANUP:
+  for (i = 0; i < job_ct; ++i)
+    job_release(&jobs[i]);
+  free(jobs);
+  return ret;
+}
+
+/* Watch mode: every input that changes becomes a job of its own, parsed 
+ * from the same option args, and run on the same context, whose allocator 
+ * keeps the last jobs' buffers around for the next ones. */
+typedef struct s_watch {
+  const char *dir;
+  int argc;
+  const char **argv;  /// Job args, argv[1] being swapped for each input
+  HuffCtx_t ctx;
+  _Bool outputs_in_dir;  /// Outputs go to the watched directory itself
+  char **written;  /// Names of everything jobs wrote to the watched directory
+  int written_ct, written_cap;
+  unsigned event_ct, fail_ct;
+  int64_t total_latency_ns, max_latency_ns;
+} Watch_t;
+
+static volatile sig_atomic_t watch_stop = 0;
+
+static void watch_stop_handler(int signo) {
+  (void)signo;
+  watch_stop = 1;
+}
+
+/// @return Whether name's one of the files a job wrote to the watched directory.
+static _Bool watch_wrote(const Watch_t *watch, const char *name) {
+  for (int i = 0; i < watch->written_ct; ++i)
+    if (!strcmp(watch->written[i], name))
+      return true;
+  return false;
+}
 
-  fwrite(&gba_hdr, sizeof(gba_hdr), 1, ofp);
-  fwrite(gba_treetable, sizeof(*gba_treetable), tablelen, ofp);
-  if (ftell(ofp)&3ULL) {
-    warnf("Failed to align compressed data stream to word boundary. :(\n"
-        "Compressed data stream's offset within output file is \x1b[1;31m%ld"
-        "\x1b[0m,\nWhich \x1b[31mdoes not\x1b[0m fall on a word boundary.\n",
-        ftell(ofp));
+static void watch_note_written(Watch_t *watch, const AssetCacheFiles_t *files) {
+  for (int i = 0; i < files->ct; ++i) {
+    if (watch_wrote(watch, files->names[i]))
+      continue;
+    if (watch->written_ct == watch->written_cap) {
+      const int cap = watch->written_cap ? watch->written_cap*2 : 16;
+      char **tmp = realloc(watch->written, sizeof(*tmp)*cap);
+      if (!tmp)
+        return;
+      watch->written = tmp;
+      watch->written_cap = cap;
+    }
+    watch->written[watch->written_ct++] = strdupe(files->names[i]);
   }
-  fwrite(compdata, sizeof(*compdata), complen, ofp);
-  */
-  fclose(ofp);
-  Huff_Tree_Destroy(tree);
-  free(compdata);
-  free(gba_treetable);
+}
+
+static void watch_event_cb(const AssetWatchEvent_t *ev, void *arg) {
+  Watch_t *watch = arg;
+  AssetCacheFiles_t outputs = {0};
+  CliJob_t job;
+  const size_t dir_len = strlen(watch->dir);
+  char path[dir_len + strlen(ev->name) + 2];
+  int64_t start, done;
+  int ret;
+  // our own outputs changing isn't worth recompressing
+  if (watch->outputs_in_dir && watch_wrote(watch, ev->name))
+    return;
+  snprintf(path, sizeof(path), watch->dir[dir_len-1] == '/' ? "%s%s" : "%s/%s",
+      watch->dir, ev->name);
+  watch->argv[1] = path;
+  ++watch->event_ct;
+  if (0 > job_init(&job, watch->argc, watch->argv)) {
+    ++watch->fail_ct;
+    return;
+  }
+  job.outputs = &outputs;
+  // a mapped input that gets truncated (e.g.: re-saved) mid-job would take 
+  // the whole watcher down with SIGBUS, where a read just comes up short
+  job.use_mmap = false;
+
+  start = Asset_Watch_Now_Ns();
+  ret = job_run_cached(&watch->ctx, &job);
+  done = Asset_Watch_Now_Ns();
+  if (watch->outputs_in_dir)
+    watch_note_written(watch, &outputs);
+
+  if (ret < 0) {
+    ++watch->fail_ct;
+    fprintf(stderr, COLOR_BOLD(31, "[FAILED]") " %s, %.1f ms after its last "
+        "change\n", path, (done - ev->last_ns)/1e6);
+  } else {
+    watch->total_latency_ns += done - ev->last_ns;
+    if (watch->max_latency_ns < done - ev->last_ns)
+      watch->max_latency_ns = done - ev->last_ns;
+    fprintf(stdout, COLOR_BOLD(32, "[Watch]") " %s: " BOLD("%d") " files in "
+        BOLD("%.1f ms") ", " BOLD("%.1f ms") " after its last change (%d "
+        "change%s, first %.1f ms before that)\n", path, outputs.ct, 
+        (done - start)/1e6, (done - ev->last_ns)/1e6, ev->change_ct, 
+        ev->change_ct == 1 ? "" : "s", (ev->last_ns - ev->first_ns)/1e6);
+  }
+  fflush(stdout);
+  job_release(&job);
+}
+
+/**
+ * @brief Watch mode. argv looks like:
+ * <exe> --watch <input directory> [OPTIONS]
+ * where OPTIONS are what a single-file run would take after its input.
+ * */
+int watch_main(int argc, char *argv[]) {
+  const int job_argc = argc-1;
+  const char *job_argv[job_argc > 2 ? job_argc : 2];
+  char dir_real[PATH_MAX], out_real[PATH_MAX];
+  struct sigaction sa = { .sa_handler = watch_stop_handler };
+  unsigned reused_ct, malloced_ct;
+  Watch_t watch = { .ctx = HUFF_CTX_INITIALIZER, .argc = job_argc, 
+    .argv = job_argv };
+  HuffPool_t *pool;
+  CliJob_t tmpl;
+  int ret = 0;
+  if (argc < 3) {
+    perr("Watch mode needs a directory to watch. See below for usage:\n");
+    print_usage(*argv, stderr);
+    return -1;
+  }
+  watch.dir = argv[2];
+  for (int i = 3; i < argc; ++i) {
+    if (!strcmp("-o", argv[i]) || !strcmp("-n", argv[i])) {
+      perrf(BOLD("%s") " can't be used in watch mode, as every input would "
+          "end up with the same one.\n", argv[i]);
+      return -1;
+    }
+  }
+  // job args get their own argv, same as batch jobs, the input at [1]
+  job_argv[0] = *argv;
+  job_argv[1] = watch.dir;
+  memcpy(&job_argv[2], &argv[3], sizeof(*job_argv)*(argc-3));
+  // parse the options once up front, so bad ones get caught before waiting
+  if (0 > job_init(&tmpl, job_argc, job_argv)) {
+    perr("Failed to parse opts.\n");
+    return -1;
+  }
+  if (NULL == realpath(watch.dir, dir_real)) {
+    perrf("Can't watch " COLOR_BOLD(32, "%s") ".\n\t" 
+        COLOR_BOLD(31, "[Details]: ") "%s\n", watch.dir, strerror(errno));
+    job_release(&tmpl);
+    return -1;
+  }
+  watch.outputs_in_dir = NULL != realpath(tmpl.output_dir, out_real) 
+    && !strcmp(dir_real, out_real);
+  job_release(&tmpl);
+
+  if (NULL == (pool = Huff_Pool_Create(0))) {
+    perr("Failed to allocate watch mode buffer pool.\n");
+    return -1;
+  }
+  watch.ctx.allocator = HUFF_POOL_ALLOCATOR(pool);
+  // no SA_RESTART, so the watcher's poll gets interrupted to see watch_stop
+  sigemptyset(&sa.sa_mask);
+  sigaction(SIGINT, &sa, NULL);
+  sigaction(SIGTERM, &sa, NULL);
+
+  printf("Watching " BOLD("%s") " for changes. Press " BOLD("Ctrl+C") 
+      " to stop.\n", watch.dir);
+  fflush(stdout);
+  if (0 > Asset_Watch_Run(watch.dir, 0, watch_event_cb, &watch, &watch_stop)) {
+    perrf("Failed to watch " COLOR_BOLD(32, "%s") ".\n\t" 
+        COLOR_BOLD(31, "[Details]: ") "%s\n", watch.dir, strerror(errno));
+    ret = -1;
+  }
+
+  Huff_Pool_Counts(pool, &reused_ct, &malloced_ct);
+  printf("\nStopped watching " BOLD("%s") ". " BOLD("%u") " changes, " 
+      BOLD("%u") " failed. %.1f ms on average from a change to its outputs, "
+      "%.1f ms at most. %u of %u buffers reused.\n", watch.dir, 
+      watch.event_ct, watch.fail_ct, watch.event_ct > watch.fail_ct 
+        ? watch.total_latency_ns/1e6/(watch.event_ct - watch.fail_ct) : 0.0,
+      watch.max_latency_ns/1e6, reused_ct, reused_ct + malloced_ct);
+  for (int i = 0; i < watch.written_ct; ++i)
+    free(watch.written[i]);
+  free(watch.written);
+  Huff_Pool_Destroy(pool);
+  return ret;
+}
+
+int main(int argc, char *argv[]) {
+  if (argc < 2) {
+    perr("Invalid argument count. See below for usage:\n");
+    print_usage(*argv, stderr);
+    return 1;
+  }
+
+  if (!strcmp("--batch", argv[1])) {
+    return batch_main(argc, argv);
+  }
+  if (!strcmp("--watch", argv[1])) {
+    return watch_main(argc, argv);
+  }
+
+  CliJob_t job;
+  int ret;
+  if (0 > job_init(&job, argc, (const char**)argv)) {
+    perr("Failed to parse opts.\n");
+    return -1;
+  }
+  job_print_banner(&job);
+#ifdef _TESTING_ARG_PARSER_
+  job_release(&job);
   return 0;
+#endif
+  ret = job_run_cached(Huff_Ctx_Default(), &job);
+  job_release(&job);
+  return ret;
 }
 
 
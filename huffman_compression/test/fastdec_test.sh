@@ -0,0 +1,77 @@
+#!/bin/sh
+# Round-trip -l output on the host: build each emitted <out>_fastdec.c with
+# the -t c data it decodes and a small driver, and check it decodes back to
+# the input, zero-padded to a whole word same as the BIOS header says.
+# Usage: fastdec_test.sh <huffman.elf>
+
+EXE=${1:-./bin/huffman.elf}
+CC=${CC:-cc}
+TMP=$(mktemp -d) || exit 1
+trap 'rm -rf "$TMP"' EXIT
+FAIL=0
+TEXT_INPUT=./src/huffman.c
+BIN_INPUT=../font_parse/example/verdana.bmp
+
+fail() {
+  echo "[FAIL] $CASE: $*"
+  FAIL=1
+}
+
+# Writes the whole decompressed buffer to stdout
+cat > "$TMP/driver.c" <<'EOF'
+#include <stdio.h>
+#include <stdlib.h>
+#include HEADER
+#define CAT_(a, b) a##b
+#define CAT(a, b) CAT_(a, b)
+#define SIZE CAT(SYM, _Decompressed_Data_Size)
+
+int main(void) {
+  unsigned int *dst = calloc(SIZE/4, 4);
+  if (!dst)
+    return 1;
+  CAT(SYM, _Huffman_Fast_Decompress)(dst);
+  if (SIZE != fwrite(dst, 1, SIZE, stdout))
+    return 1;
+  free(dst);
+  return 0;
+}
+EOF
+
+# run_case <name> <input> [opts]...
+run_case() {
+  CASE=$1 INPUT=$2
+  shift 2
+  if ! "$EXE" "$INPUT" -t c -d "$TMP/" -o "$CASE" -n "$CASE" "$@" >/dev/null 2>&1; then
+    fail "compression failed"
+    return
+  fi
+  if ! $CC -std=c99 -Wall -Wextra -Werror -O2 -DHEADER="\"$TMP/$CASE.h\"" \
+      -DSYM="$CASE" -o "$TMP/$CASE.elf" "$TMP/driver.c" "$TMP/$CASE.c" \
+      "$TMP/${CASE}_fastdec.c" 2> "$TMP/cc.txt"; then
+    fail "emitted decoder didn't build"
+    cat "$TMP/cc.txt"
+    return
+  fi
+  if ! "$TMP/$CASE.elf" > "$TMP/$CASE.out"; then
+    fail "emitted decoder failed"
+    return
+  fi
+  SIZE=$(($(wc -c < "$INPUT")))
+  cp "$INPUT" "$TMP/$CASE.in"
+  truncate -s $(((SIZE + 3)/4*4)) "$TMP/$CASE.in"
+  cmp -s "$TMP/$CASE.in" "$TMP/$CASE.out" || fail "decoded output differs from the input"
+}
+
+run_case text8 "$TEXT_INPUT" -l 8
+run_case text4 "$TEXT_INPUT" -b 4 -l 10
+run_case textauto "$TEXT_INPUT" -b auto -l 6
+run_case bmp1 "$BIN_INPUT" -l 1
+run_case bmp12 "$BIN_INPUT" -l 12
+run_case bmp4 "$BIN_INPUT" -b 4 -l 4
+run_case stream "$BIN_INPUT" --stream -l 8 -s .rodata
+
+if [ $FAIL = 0 ]; then
+  echo "[OK] -l decoders round-trip"
+fi
+exit $FAIL
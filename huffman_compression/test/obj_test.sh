@@ -0,0 +1,94 @@
+#!/bin/sh
+# Check -t obj output with the host's binutils: the ELF header has to say
+# ARM EABI v5 relocatable, every symbol has to be where -t asm would put it,
+# and .rodata has to hold exactly the bytes of the -t c array.
+# Usage: obj_test.sh <huffman.elf>
+
+EXE=${1:-./bin/huffman.elf}
+# A host objcopy built for x86 alone can't read ARM objects
+if [ -z "$OBJCOPY" ]; then
+  for OBJCOPY in arm-none-eabi-objcopy llvm-objcopy objcopy; do
+    command -v $OBJCOPY >/dev/null && break
+  done
+fi
+TMP=$(mktemp -d) || exit 1
+trap 'rm -rf "$TMP"' EXIT
+FAIL=0
+TEXT_INPUT=./src/huffman.c
+BIN_INPUT=../font_parse/example/verdana.bmp
+
+fail() {
+  echo "[FAIL] $CASE: $*"
+  FAIL=1
+}
+
+# symbol <obj> <name> -> "<value> <size>", both in decimal (readelf gives
+# the value in hex, and sizes past 99999 in hex too)
+symbol() {
+  readelf -sW "$1" | awk -v name="$2" '$8 == name && $4 == "OBJECT" && $5 == "GLOBAL" {
+    print $2, $3 }' | { read -r VALUE SIZE && echo "$((0x$VALUE)) $((SIZE))"; }
+}
+
+# The first array in a -t c file (the compression data), as little-endian
+# bytes, one hex pair per line
+c_array_bytes() {
+  awk '/^const unsigned int .*_Compression_Data\[/ { on = 1; next }
+    on && /^};/ { exit }
+    on { for (i = 1; i <= NF; ++i) if ($i ~ /^0x/) { w = substr($i, 3, 8)
+      print tolower(substr(w, 7, 2)) "\n" tolower(substr(w, 5, 2)) "\n" \
+        tolower(substr(w, 3, 2)) "\n" tolower(substr(w, 1, 2)) } }' "$1"
+}
+
+# run_case <name> <input> <symbol prefix> <codec name> [opts]...
+run_case() {
+  CASE=$1 INPUT=$2 SYM=$3 CODEC=$4
+  shift 4
+  OBJ=$TMP/$CASE.o CSRC=$TMP/${CASE}_c.c
+  if ! "$EXE" "$INPUT" -t obj -d "$TMP/" -o "$CASE" -n "$SYM" "$@" >/dev/null 2>&1 \
+      || ! "$EXE" "$INPUT" -t c -d "$TMP/" -o "${CASE}_c" -n "$SYM" "$@" >/dev/null 2>&1; then
+    fail "compression failed"
+    return
+  fi
+
+  HDR=$(readelf -h "$OBJ")
+  echo "$HDR" | grep -q 'Class: *ELF32$' || fail "not ELF32"
+  echo "$HDR" | grep -q 'Data: *2.s complement, little endian$' || fail "not little-endian"
+  echo "$HDR" | grep -q 'Type: *REL ' || fail "not relocatable"
+  echo "$HDR" | grep -q 'Machine: *ARM$' || fail "not EM_ARM"
+  echo "$HDR" | grep -q 'Flags: .*Version5 EABI' || fail "not EABI v5"
+  readelf -SW "$OBJ" | grep -q ' \.rodata  *PROGBITS ' || fail "no .rodata section"
+
+  $OBJCOPY -O binary -j .rodata "$OBJ" "$TMP/rodata.bin" || fail "$OBJCOPY failed"
+  od -An -v -tx1 "$TMP/rodata.bin" | tr -s ' ' '\n' | sed '/^$/d' > "$TMP/rodata.txt"
+  c_array_bytes "$CSRC" > "$TMP/array.txt"
+  cmp -s "$TMP/rodata.txt" "$TMP/array.txt" || fail ".rodata differs from the -t c array"
+  RODATA_SIZE=$(($(wc -l < "$TMP/rodata.txt")))
+
+  set -- $(symbol "$OBJ" "${SYM}_${CODEC}_Compression_Data")
+  [ "$1" = 0 ] && [ "$2" = "$RODATA_SIZE" ] \
+    || fail "${SYM}_${CODEC}_Compression_Data is at $1, size $2, not 0, size $RODATA_SIZE"
+  [ "$CODEC" = Huffman ] || return
+
+  # header word, then the tree size byte and the table, then the bitstream
+  TREE_SIZE=$(sed -n 's/^\/\/ Huffman Tree Size:[[:space:]]*//p' "$CSRC")
+  RAW_OFS=$((4 + 1 + TREE_SIZE))
+  for expect in "Compression_Header 0 4" "Tree_Nodes_Table 5 $TREE_SIZE" \
+      "Raw_Compressed_Data $RAW_OFS $((RODATA_SIZE - RAW_OFS))"; do
+    set -- $expect
+    NAME=${SYM}_Huffman_$1
+    [ "$(symbol "$OBJ" "$NAME")" = "$2 $3" ] \
+      || fail "$NAME is at $(symbol "$OBJ" "$NAME"), not $2 $3"
+  done
+}
+
+run_case huff_text "$TEXT_INPUT" text Huffman
+run_case huff_bmp "$BIN_INPUT" bmp Huffman
+run_case huff4 "$TEXT_INPUT" text Huffman -b 4
+run_case stream "$BIN_INPUT" bmp Huffman --stream
+run_case lz77 "$TEXT_INPUT" text LZ77 -c lz77
+run_case rle "$BIN_INPUT" bmp RLE -c rle
+
+if [ $FAIL = 0 ]; then
+  echo "[OK] -t obj output checks out"
+fi
+exit $FAIL